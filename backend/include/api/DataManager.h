@@ -9,10 +9,12 @@
 
 #include "shared/Option.h"
 #include "shared/OptionBatch.h"
+#include "market/VolSurface.h"
 
 class DataManager{
     OptionBatch batch_;
     std::unordered_map<std::string, size_t> instrument_to_idx_;
+    VolSurface surface_;
     std::mutex data_mutex_;
 
 public:
@@ -24,6 +26,12 @@ public:
 
     // return copy of batch for pricing engine; or should we return reference with mutex lock?
     OptionBatch get_batch_snapshot();
+    // same, into a caller-owned batch: copy-assign reuses its arena once the capacity matches, so a steady tick
+    // doesn't allocate
+    void get_batch_snapshot(OptionBatch& out);
+
+    // same, but sigma comes from the calibrated SVI surface (refits only expiries that ticked since the last call)
+    OptionBatch get_smoothed_snapshot();
 };
 
 #endif //OPTIONS_SIMULATOR_DATA_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef OPTIONS_SIMULATOR_PRICINGCLIENT_H
+#define OPTIONS_SIMULATOR_PRICINGCLIENT_H
+
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "api/PricingProtocol.h"
+#include "shared/OptionBatch.h"
+
+namespace net = boost::asio;
+
+// blocking client for PricingServer, one connection. send/receive can be split to pipeline: send several batches,
+// then receive the responses in the same order. not thread safe; one client per thread.
+// throws boost::system::system_error on socket errors
+class PricingClient {
+public:
+    PricingClient(const std::string& host, uint16_t port);
+    explicit PricingClient(const std::string& unixPath);
+
+    // writes one request and returns its id
+    uint64_t send(const OptionBatchView& batch, bool greeks = false,
+                  PricingWire::Model model = PricingWire::Model::Default, uint32_t steps = 0);
+    // next response; out gets count x columns doubles, row-major
+    PricingWire::ResponseHeader receive(std::vector<double>& out);
+
+    // round trip: prices (columns 1) into out[0, batch.size). throws std::runtime_error on a non-Ok status
+    void price(const OptionBatchView& batch, double* out,
+               PricingWire::Model model = PricingWire::Model::Default, uint32_t steps = 0);
+
+private:
+    net::io_context ioc_;
+    net::generic::stream_protocol::socket socket_;
+    std::vector<double> body_;       // COLUMNAR request body
+    std::vector<double> scratch_;
+    uint64_t next_id_ = 1;
+};
+
+#endif //OPTIONS_SIMULATOR_PRICINGCLIENT_H
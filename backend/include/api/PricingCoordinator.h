@@ -0,0 +1,105 @@
+#ifndef OPTIONS_SIMULATOR_PRICINGCOORDINATOR_H
+#define OPTIONS_SIMULATOR_PRICINGCOORDINATOR_H
+
+#include <boost/asio/io_context.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/PricingProtocol.h"
+#include "shared/Greeks.h"
+#include "shared/OptionBatch.h"
+
+namespace net = boost::asio;
+
+// a PricingServer (options_simulator --serve) on this host or another one
+struct WorkerEndpoint {
+    std::string host;       // name or literal address, resolved on every (re)connect
+    uint16_t port = 0;
+    std::string unixPath;   // non-empty: local worker on a unix socket, host/port ignored
+
+    // "host:port" or "unix:/path/to.sock"; throws std::invalid_argument
+    static WorkerEndpoint parse(const std::string& text);
+    std::string name() const;
+};
+
+struct CoordinatorConfig {
+    size_t shardRows = 16384;        // rows per shard; several shards per worker so a lost one is cheap to redo
+    size_t pipeline = 2;             // shards outstanding per worker, hides the round trip behind pricing
+    std::chrono::milliseconds shardTimeout{5000};   // no response for this long: the worker is dropped as hung
+    std::chrono::milliseconds connectTimeout{1000};
+    PricingWire::Model model = PricingWire::Model::Default;
+    uint32_t steps = 0;              // 0 = the workers' default
+    bool localFallback = true;       // no live worker left: price the remaining shards here instead of throwing
+};
+
+struct CoordinatorStats {
+    uint64_t shards = 0;
+    uint64_t reassigned = 0;         // shards that were sent to a worker that then failed, and went to another one
+    uint64_t workerFailures = 0;     // connect errors, resets, timeouts and bad responses
+    uint64_t localRows = 0;          // rows priced by localFallback
+};
+
+// per-connection state (PricingCoordinator.cpp)
+struct CoordinatorWorker;
+
+// scatter/gather over PricingServer workers. a batch is cut into shards (row ranges, or whole groups of rows sharing
+// a key such as Portfolio::underlyingIndices(), so an underlying never straddles workers); shards go out as COLUMNAR
+// requests (column slices of the batch) and results are written straight back to the caller's rows. a worker that
+// errors or stays silent past shardTimeout is closed and its outstanding shards are queued again for the others; it
+// is reconnected on the next call. everything runs on the calling thread (one io_context), so calls must not overlap
+class PricingCoordinator {
+public:
+    explicit PricingCoordinator(std::vector<WorkerEndpoint> workers, CoordinatorConfig config = {});
+    ~PricingCoordinator();
+    PricingCoordinator(const PricingCoordinator&) = delete;
+    PricingCoordinator& operator=(const PricingCoordinator&) = delete;
+
+    // out[0, batch.size). shardKeys: optional per-row group ids >= 0; rows with the same id share a shard.
+    // throws std::runtime_error if shards are left with no live worker and localFallback is off
+    void price(const OptionBatchView& batch, double* out, const int* shardKeys = nullptr);
+    // every column of out must be set
+    void priceAndGreeks(const OptionBatchView& batch, const GreekColumns& out, const int* shardKeys = nullptr);
+
+    const CoordinatorStats& stats() const { return stats_; } // cumulative over calls
+    size_t liveWorkers() const;
+
+private:
+    struct Shard {
+        size_t begin, end;           // into order_ when keyed, else rows
+    };
+
+    void run(const OptionBatchView& batch, const GreekColumns& out, bool greeks, const int* shardKeys);
+    void makeShards(size_t n, const int* shardKeys);
+    size_t row(size_t i) const { return order_.empty() ? i : order_[i]; }
+
+    void connect(CoordinatorWorker& worker);
+    void connect_address(CoordinatorWorker& worker, size_t index);
+    void on_connect(CoordinatorWorker& worker);
+    void pump(CoordinatorWorker& worker);
+    void do_read(CoordinatorWorker& worker);
+    void on_response(CoordinatorWorker& worker);
+    void arm_timer(CoordinatorWorker& worker, std::chrono::milliseconds timeout);
+    void fail(CoordinatorWorker& worker);
+    void priceLocally();
+
+    CoordinatorConfig config_;
+    net::io_context ioc_;
+    std::vector<std::unique_ptr<CoordinatorWorker>> workers_;
+    CoordinatorStats stats_;
+
+    // state of the call in progress
+    OptionBatchView batch_{};
+    GreekColumns out_;
+    bool greeks_ = false;
+    std::vector<Shard> shards_;
+    std::vector<size_t> order_;      // rows grouped by key; empty for plain row ranges
+    std::deque<size_t> pending_;     // shard ids not yet answered by anyone
+    size_t completed_ = 0;
+};
+
+#endif //OPTIONS_SIMULATOR_PRICINGCOORDINATOR_H
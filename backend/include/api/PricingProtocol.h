@@ -0,0 +1,68 @@
+#ifndef OPTIONS_SIMULATOR_PRICINGPROTOCOL_H
+#define OPTIONS_SIMULATOR_PRICINGPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Binary framing between PricingServer and PricingClient (same host, so native byte order, no versioned encoding
+ * beyond the header's version field):
+ *   request:  [RequestHeader][count x Row], or with COLUMNAR [S][K][r][sigma][T][q][type bytes][style bytes]
+ *   response: [ResponseHeader][count x columns doubles, row-major: price, then delta gamma theta vega rho if asked]
+ * a connection may pipeline any number of requests; responses come back in request order. id is echoed untouched */
+namespace PricingWire {
+    constexpr uint32_t REQUEST_MAGIC = 0x5152504f;  // "OPRQ"
+    constexpr uint32_t RESPONSE_MAGIC = 0x5352504f; // "OPRS"
+    constexpr uint16_t VERSION = 1;
+    constexpr uint32_t MAX_STEPS = 10000; // larger steps are a BadRequest
+
+    // Default: black-scholes for european rows, BAW for american (PricingDispatcher::priceBatch).
+    // Binomial: CRR lattice for american rows (priceBatchBinomial). the price column follows the model with or without
+    // WANT_GREEKS; greeks come from priceAndGreeksBatch (vega and rho per point, theta per calendar day)
+    enum class Model : uint8_t { Default = 0, Binomial = 1 };
+    enum Flags : uint8_t { WANT_GREEKS = 1, COLUMNAR = 2 }; // COLUMNAR: body is column slices, not Rows
+
+    enum class Status : uint16_t {
+        Ok = 0,
+        BadRequest = 1, // unknown model/flags, steps above MAX_STEPS or a row with type/style outside 0/1; connection stays usable
+        TooLarge = 2,   // count above the server's maxRequestRows; the server closes the connection after replying
+        BadFrame = 3,   // wrong magic/version; closed after replying
+        Failed = 4,     // pricing threw; the connection stays usable
+    };
+
+    struct RequestHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t model;   // Model
+        uint8_t flags;   // Flags
+        uint64_t id;
+        uint32_t count;  // rows that follow
+        uint32_t steps;  // BAW iterations / lattice steps; 0 = the dispatcher's default (1000)
+    };
+
+    struct Row {
+        double S, K, r, sigma, T, q;
+        uint8_t type;    // OptionType: 0 call, 1 put
+        uint8_t style;   // OptionStyle: 0 european, 1 american
+        uint8_t pad[6];
+    };
+
+    struct ResponseHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t status; // Status
+        uint64_t id;
+        uint32_t count;
+        uint32_t columns; // 1, or 6 with WANT_GREEKS; 0 on error
+    };
+
+    static_assert(sizeof(RequestHeader) == 24 && sizeof(Row) == 56 && sizeof(ResponseHeader) == 24,
+                  "wire structs must have no hidden padding");
+
+    // COLUMNAR body: S, K, r, sigma, T, q as count doubles each, then count type bytes and count style bytes,
+    // zero padded to a multiple of 8. 50 bytes a row instead of Row's 56, and both ends copy whole columns
+    inline size_t columnarBytes(uint32_t count) {
+        return 6 * sizeof(double) * static_cast<size_t>(count) + ((2 * static_cast<size_t>(count) + 7) & ~size_t(7));
+    }
+}
+
+#endif //OPTIONS_SIMULATOR_PRICINGPROTOCOL_H
@@ -0,0 +1,116 @@
+#ifndef OPTIONS_SIMULATOR_PRICINGSERVER_H
+#define OPTIONS_SIMULATOR_PRICINGSERVER_H
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "api/PricingProtocol.h"
+#include "shared/OptionBatch.h"
+
+namespace net = boost::asio;
+
+struct PricingServerConfig {
+    std::string unixPath;              // non-empty: listen on this unix socket instead of tcp
+    std::string host = "127.0.0.1";
+    uint16_t port = 7878;              // 0 picks a free port (see PricingServer::port)
+    size_t maxRequestRows = 1 << 20;   // larger requests are refused (TooLarge)
+    size_t maxBatchRows = 1 << 16;     // rows coalesced into one pricing call
+    size_t maxQueuedRows = 1 << 20;    // above this, connections stop reading until the queue drains
+    size_t maxInFlight = 64;           // pipelined requests per connection before it stops reading
+};
+
+struct PricingServerStats {
+    uint64_t connections = 0;
+    uint64_t requests = 0;
+    uint64_t rows = 0;
+    uint64_t batches = 0;              // pricing calls; rows / batches is the coalescing achieved
+    uint64_t pauses = 0;               // times a connection stopped reading because the queue was full
+};
+
+// one decoded request and, once priced, its response body (PricingServer.cpp)
+struct PricingRequest;
+
+// tcp and unix sessions share this face towards the server; everything on it runs on the io thread
+class PricingConnection : public std::enable_shared_from_this<PricingConnection> {
+public:
+    virtual ~PricingConnection() = default;
+    virtual void on_priced(const std::shared_ptr<PricingRequest>& request) = 0;
+    virtual void resume() = 0;
+    virtual void close() = 0;
+};
+
+// shares one warm engine (omp pool, per-thread lattices, Kernels isa pick) between local strategy processes.
+// one io thread accepts and runs every connection; one pricing thread takes whatever requests are queued (up to
+// maxBatchRows), groups them by (model, greeks, steps), copies each group into a single SoA batch and prices it with
+// one PricingDispatcher call, so many small concurrent requests cost one parallel pass.
+// backpressure: a connection stops reading its socket while it has maxInFlight requests outstanding or the shared
+// queue holds more than maxQueuedRows, so a fast client is throttled by tcp/unix flow control, not buffered
+class PricingServer {
+public:
+    explicit PricingServer(PricingServerConfig config = {});
+    ~PricingServer();
+    PricingServer(const PricingServer&) = delete;
+    PricingServer& operator=(const PricingServer&) = delete;
+
+    // binds and starts the io + pricing threads; returns once listening. throws boost::system::system_error
+    void start();
+    // not from inside a connection handler (it joins the io thread)
+    void stop();
+    // blocks until stop() (e.g. from a signal handler thread)
+    void wait();
+
+    uint16_t port() const;             // bound tcp port; 0 for a unix socket
+    PricingServerStats stats() const;
+    const PricingServerConfig& config() const { return config_; }
+
+    // from connections, io thread only. submit returns false when the queue is over maxQueuedRows: the caller then
+    // pauses and is resumed once the pricing thread has drained it
+    bool submit(std::shared_ptr<PricingRequest> request);
+    void pause(const std::shared_ptr<PricingConnection>& connection);
+
+private:
+    void do_accept_tcp();
+    void do_accept_unix();
+    void pricing_loop();
+    void price_group(std::vector<std::shared_ptr<PricingRequest>>& group);
+    void resume_paused();
+
+    PricingServerConfig config_;
+    net::io_context ioc_;
+    std::optional<net::ip::tcp::acceptor> tcp_acceptor_;
+    std::optional<net::local::stream_protocol::acceptor> unix_acceptor_;
+    std::thread io_thread_, pricing_thread_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<std::shared_ptr<PricingRequest>> queue_;
+    size_t queued_rows_ = 0;
+    bool stopping_ = false;
+
+    std::vector<std::weak_ptr<PricingConnection>> sessions_; // io thread only
+    std::vector<std::weak_ptr<PricingConnection>> paused_;   // io thread only
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopped_ = true;
+
+    std::atomic<uint64_t> connections_{0}, requests_{0}, rows_{0}, batches_{0}, pauses_{0};
+
+    // pricing thread scratch, reused so a warm server doesn't allocate per batch
+    OptionBatch batch_;
+    std::vector<double> columns_[6];
+};
+
+#endif //OPTIONS_SIMULATOR_PRICINGSERVER_H
@@ -0,0 +1,53 @@
+#ifndef OPTIONS_SIMULATOR_CURVES_H
+#define OPTIONS_SIMULATOR_CURVES_H
+
+#include <vector>
+#include "shared/Dividends.h"
+#include "shared/ExpiryBuckets.h"
+#include "shared/OptionBatch.h"
+
+// continuously compounded zero curve. r * T is interpolated linearly between pillars (piecewise flat forwards);
+// the zero rate is held flat before the first and after the last pillar. an empty curve is 0 everywhere
+class RateCurve {
+public:
+    RateCurve() = default;
+    explicit RateCurve(double flatRate);
+    RateCurve(std::vector<double> times, std::vector<double> zeroRates);
+
+    double zeroRate(double T) const;
+    double discount(double T) const;
+
+private:
+    std::vector<double> times_, logDiscount_; // -ln DF at each pillar, times_ ascending
+};
+
+// curves for one underlying: discount, carry (borrow cost + dividend yield) and discrete cash dividends.
+// terms are cached per expiry, so a book with thousands of rows on a dozen expiries does a dozen exps.
+// discrete dividends follow the escrowed model: the prepaid forward is S e^{-qT} - PV(dividends before T)
+class MarketCurves {
+public:
+    static constexpr size_t MAX_CACHED_EXPIRIES = 1024;
+
+    explicit MarketCurves(RateCurve discount = {}, RateCurve carry = {}, std::vector<CashDividend> dividends = {});
+
+    void setDiscount(RateCurve curve);
+    void setCarry(RateCurve curve);
+    void setDividends(std::vector<CashDividend> dividends);
+
+    // cached; the cache is dropped whenever a curve changes or it reaches MAX_CACHED_EXPIRIES entries
+    ExpiryTerms terms(double T);
+    // one ExpiryTerms per distinct T in the batch plus a row -> bucket index
+    ExpiryBuckets buckets(const OptionBatchView& batch);
+    // writes r and an effective q per row, folding discrete dividends into q at the row's spot
+    // (S e^{-q T} = prepaid forward), so every scalar pricer sees the curves
+    void apply(OptionBatch& batch);
+
+private:
+    RateCurve discount_, carry_;
+    std::vector<CashDividend> dividends_; // sorted by time
+    std::vector<ExpiryTerms> cache_;      // sorted by T
+
+    ExpiryTerms compute(double T) const;
+};
+
+#endif //OPTIONS_SIMULATOR_CURVES_H
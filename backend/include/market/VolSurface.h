@@ -0,0 +1,74 @@
+#ifndef OPTIONS_SIMULATOR_VOLSURFACE_H
+#define OPTIONS_SIMULATOR_VOLSURFACE_H
+
+#include <vector>
+#include "shared/OptionBatch.h"
+
+// raw SVI total variance at log-moneyness k = ln(K / F):
+//   w(k) = a + b * (rho * (k - m) + sqrt((k - m)^2 + sigma^2))
+struct SVIParams {
+    double a = 0.0, b = 0.0, rho = 0.0, m = 0.0, sigma = 0.1;
+
+    double totalVariance(double k) const;
+};
+
+struct VolQuote {
+    double K;
+    double iv;          // annualized, e.g. 0.3886 (not percent)
+    double weight = 1.0;
+};
+
+// one SVI smile per expiry, fit to chain IVs with the quasi-explicit method (Zeliade 2009): for fixed (m, sigma)
+// the smile is linear in (a, b*rho*sigma, b*sigma), so a vectorized 3x3 least squares solves it exactly
+// (projected onto the no-arbitrage box: wing slopes b(1 +- rho) <= 4, a >= 0); Nelder-Mead searches (m, sigma).
+// refits are warm-started from the slice's last parameters and only dirty slices are refit.
+// between expiries total variance is interpolated linearly in T at fixed k; before the first / after the last
+// expiry implied vol is held flat
+class VolSurface {
+public:
+    static constexpr double MIN_VOL = 1e-4;
+
+    // replaces the quote at strike K (or adds it) and marks the expiry dirty; a new T creates a new expiry.
+    // iv <= 0 pulls the quote, and an expiry with no quotes left is removed
+    void setQuote(double T, double forward, double K, double iv, double weight = 1.0);
+    // replaces every quote of an expiry (removes it if none has iv > 0)
+    void setSlice(double T, double forward, const std::vector<VolQuote>& quotes);
+
+    // refits dirty expiries; returns how many were refit
+    size_t calibrate();
+
+    size_t expiries() const { return slices_.size(); }
+    double expiry(size_t i) const { return slices_[i].T; }
+    const SVIParams& params(size_t i) const { return slices_[i].params; }
+    double rmse(size_t i) const { return slices_[i].rmse; } // fit error in vol points (annualized)
+    size_t quotes(size_t i) const { return slices_[i].K.size(); }
+    bool calibrated() const;
+
+    double forward(double T) const;
+    double totalVariance(double k, double T) const;
+    // implied vol for any (K, T); at least one calibrated expiry is required. T <= 0 gets the first expiry's smile
+    double vol(double K, double T) const;
+    // writes sigma for every row from its (K, T), including strikes nobody quotes
+    void fillSigma(OptionBatch& batch) const;
+
+private:
+    struct Slice {
+        double T = 0.0, forward = 0.0, logForward = 0.0;
+        std::vector<double> K, iv, weight;    // quotes, SoA
+        SVIParams params;
+        double rmse = 0.0;
+        bool fitted = false, dirty = true;
+    };
+    std::vector<Slice> slices_; // sorted by T
+
+    Slice& sliceFor(double T, double forward);
+    void removeQuote(double T, double K);
+    static void fit(Slice& slice);
+    // index of the last expiry with T_i <= T, or -1; hint is a previous answer to try first
+    long bracket(double T, long hint = -1) const;
+    double interpolate(double k, double T, long lo) const;
+    double logForward(double T, long lo) const; // linear in T between expiries, flat outside
+    double impliedVol(double k, double T, long lo) const;
+};
+
+#endif //OPTIONS_SIMULATOR_VOLSURFACE_H
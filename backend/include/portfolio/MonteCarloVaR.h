@@ -0,0 +1,38 @@
+#ifndef OPTIONS_SIMULATOR_MONTECARLOVAR_H
+#define OPTIONS_SIMULATOR_MONTECARLOVAR_H
+
+#include <cstdint>
+#include <vector>
+#include "portfolio/Portfolio.h"
+#include "pricing/ChebyshevSurrogate.h"
+
+// factors are [spot_0 .. spot_U-1, vol_0 .. vol_U-1] over portfolio.underlyings();
+// spot moves are lognormal, vol moves scale every implied vol of that underlying (parallel shift in log space)
+struct VaRConfig {
+    size_t scenarios = 10000;
+    double horizon = 1.0 / 252.0;   // years; options are aged by this much
+    double confidence = 0.99;
+    uint64_t seed = 20250601;
+    std::vector<double> spotVol;     // per underlying, annualized; empty = mean implied vol of its rows
+    std::vector<double> volOfVol;    // per underlying, annualized relative; empty = 1.0
+    std::vector<double> correlation; // 2U x 2U row-major; empty = independent factors
+    const ChebyshevSurrogate* surrogate = nullptr; // american rows: surrogate if set, BAW otherwise
+    int bawIterations = 100;
+};
+
+struct VaRResult {
+    double var = 0.0;                // loss at the confidence level (positive = loss)
+    double expectedShortfall = 0.0;  // mean loss beyond var
+    double mean = 0.0, stdev = 0.0;
+    std::vector<double> pnl;         // by scenario index; scenario k is identical for any thread count
+};
+
+// full revaluation VaR: every scenario reprices every row (Black-Scholes / BAW / surrogate).
+// scenario k draws its normals from Philox stream k, so threads can take scenarios in any order
+namespace MonteCarloVaR {
+    VaRResult run(const Portfolio& portfolio, const VaRConfig& config = {});
+    // lower triangular L (row-major) with L * L^T = C; throws std::invalid_argument if C isn't positive definite
+    std::vector<double> cholesky(const std::vector<double>& C, size_t n);
+}
+
+#endif //OPTIONS_SIMULATOR_MONTECARLOVAR_H
@@ -0,0 +1,89 @@
+#ifndef OPTIONS_SIMULATOR_PORTFOLIO_H
+#define OPTIONS_SIMULATOR_PORTFOLIO_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "shared/Option.h"
+#include "shared/OptionBatch.h"
+
+// net risk of a set of positions; already scaled by quantity * multiplier.
+// units follow BlackScholes::computeGreeks: vega per vol point, theta per calendar day
+struct PortfolioRisk {
+    double value = 0.0;
+    double delta = 0.0;
+    double gamma = 0.0;
+    double vega  = 0.0;
+    double theta = 0.0;
+
+    PortfolioRisk& operator+=(const PortfolioRisk& other) {
+        value += other.value; delta += other.delta; gamma += other.gamma; vega += other.vega; theta += other.theta;
+        return *this;
+    }
+    PortfolioRisk& operator-=(const PortfolioRisk& other) {
+        value -= other.value; delta -= other.delta; gamma -= other.gamma; vega -= other.vega; theta -= other.theta;
+        return *this;
+    }
+};
+
+// positions live as rows of one OptionBatch; quantity/multiplier/underlying/expiry are parallel columns.
+// reprice() prices every row and reduces greeks into book, per-underlying and per-expiry totals in the same
+// pass (thread-local partials, merged once). per-row unit greeks are kept so a single row can be repriced
+// or resized later by subtracting its old contribution and adding the new one.
+class Portfolio {
+public:
+    explicit Portfolio(int steps = 1000) : steps_(steps) {}
+
+    // expiryDays < 0 derives the bucket from opt.T (calendar days, rounded); counted from the next reprice()
+    size_t addPosition(const Option& opt, double quantity, const std::string& underlying,
+                       double multiplier = 100.0, int expiryDays = -1);
+
+    // full fused price + greeks + aggregation pass
+    void reprice();
+    // incremental: only the touched row(s) are repriced, totals are adjusted in place.
+    // updatePosition moves the row between buckets when its key changes: a non-empty underlying replaces the
+    // row's one, expiryDays >= 0 sets the expiry bucket and expiryDays < 0 re-derives it from opt.T if T moved
+    void updatePosition(size_t row, const Option& opt, const std::string& underlying = {}, int expiryDays = -1);
+    void setQuantity(size_t row, double quantity);
+    void updateSpot(const std::string& underlying, double S);
+
+    const PortfolioRisk& book() const { return book_; }
+    const PortfolioRisk& underlyingRisk(const std::string& underlying) const;
+    const PortfolioRisk& expiryRisk(int expiryDays) const;
+    // position's own contribution (quantity * multiplier * unit greeks)
+    PortfolioRisk positionRisk(size_t row) const;
+
+    const std::vector<std::string>& underlyings() const { return underlyingNames_; }
+    const std::vector<int>& expiries() const { return expiryDays_; }
+    const OptionBatch& batch() const { return batch_; }
+    size_t size() const { return batch_.size(); }
+    double quantity(size_t row) const { return quantity_[row]; }
+    double multiplier(size_t row) const { return multiplier_[row]; }
+    int underlyingIndex(size_t row) const { return underlyingOf_[row]; } // index into underlyings()
+    const std::vector<int>& underlyingIndices() const { return underlyingOf_; } // per row, e.g. PricingCoordinator shard keys
+
+private:
+    int steps_;
+    OptionBatch batch_;
+    std::vector<double> quantity_, multiplier_;
+    std::vector<int> underlyingOf_, expiryOf_;          // dense bucket ids per row
+    std::vector<PortfolioRisk> unit_;                   // per-row price + greeks for one contract
+
+    std::vector<std::string> underlyingNames_;
+    std::unordered_map<std::string, int> underlyingIds_;
+    std::vector<int> expiryDays_;
+    std::unordered_map<int, int> expiryIds_;
+    std::vector<std::vector<size_t>> rowsByUnderlying_;
+
+    PortfolioRisk book_;
+    std::vector<PortfolioRisk> byUnderlying_, byExpiry_;
+
+    int bucketUnderlying(const std::string& underlying);
+    int bucketExpiry(int expiryDays);
+    PortfolioRisk scaled(size_t row) const;
+    void applyRow(size_t row, double sign);
+    void priceRow(size_t row);      // unit_ only, totals untouched
+    void repriceRow(size_t row);
+};
+
+#endif //OPTIONS_SIMULATOR_PORTFOLIO_H
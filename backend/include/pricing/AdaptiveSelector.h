@@ -0,0 +1,60 @@
+#ifndef OPTIONS_SIMULATOR_ADAPTIVESELECTOR_H
+#define OPTIONS_SIMULATOR_ADAPTIVESELECTOR_H
+
+#include <string>
+#include <vector>
+#include "shared/Option.h"
+#include "shared/BinomialWorkspace.h"
+
+// ordered cheapest -> most expensive; routing picks the first one that meets tolerance
+enum class AmericanModel : unsigned char { BAW, Binomial100, Binomial250, Binomial500, Binomial1000 };
+
+// region classifier over (moneyness, T, sigma, r-q, type) with a per-region error table
+// calibrated offline against a high-step reference tree
+class AdaptiveModelSelector {
+public:
+    static constexpr int MONEYNESS_BINS = 6;
+    static constexpr int EXPIRY_BINS = 5;
+    static constexpr int VOL_BINS = 5;
+    static constexpr int CARRY_BINS = 3;
+    static constexpr int NUM_REGIONS = MONEYNESS_BINS * EXPIRY_BINS * VOL_BINS * CARRY_BINS * 2;
+    static constexpr int NUM_MODELS = 5;
+    static constexpr int MAX_STEPS = 1000; // workspace size needed by the most expensive model
+
+    // tolerance is max abs error per unit strike (1e-4 = 1 cent on a 100 strike)
+    explicit AdaptiveModelSelector(double tolerance = 1e-4);
+
+    // price sample w/ every model and a smoothed (N, N+1) reference tree; record worst error per region
+    void calibrate(const std::vector<Option>& sample, int referenceSteps = 2000);
+    void setTolerance(double tolerance);
+    double tolerance() const { return tolerance_; }
+
+    bool save(const std::string& path) const;
+    // replaces the calibrated table and re-routes it at this selector's tolerance (the saved one is ignored);
+    // false and unchanged on a missing, mismatched or short file
+    bool load(const std::string& path);
+
+    static int regionOf(double S, double K, double r, double sigma, double T, double q, OptionType type);
+    AmericanModel select(double S, double K, double r, double sigma, double T, double q, OptionType type) const;
+    AmericanModel regionModel(int region) const { return choice_[region]; }
+    // worst calibrated error per unit strike, negative if region was never sampled
+    double regionError(int region, AmericanModel model) const;
+
+    double price(double S, double K, double r, double sigma, double T, double q, OptionType type,
+                 BinomialWorkspace& workspace) const;
+    static double priceWith(AmericanModel model, double S, double K, double r, double sigma, double T, double q,
+                            OptionType type, BinomialWorkspace& workspace);
+
+private:
+    static constexpr int MIN_SAMPLES = 16;    // regions seen less often than this are not trusted
+    static constexpr double SAFETY = 1.25;     // headroom over the worst observed error
+
+    double tolerance_;
+    std::vector<double> maxError_;            // [region][model]
+    std::vector<int> samples_;                // per region
+    std::vector<AmericanModel> choice_;       // per region
+
+    void route();
+};
+
+#endif //OPTIONS_SIMULATOR_ADAPTIVESELECTOR_H
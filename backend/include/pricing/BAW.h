@@ -6,10 +6,51 @@
 #define OPTIONS_SIMULATOR_BAW_H
 
 #include "shared/Option.h"
+#include "shared/MathUtils.h"
+#include "pricing/BlackScholes.h"
+#include "pricing/BinomialTree.h"
+#include <algorithm>
 
 namespace BAW{
+    //lattice size priceParameters falls back to when the critical price search doesn't converge
+    constexpr int FALLBACK_STEPS = 1000;
+
     double price(const Option& opt, int steps = 100);
-    double priceParameters(double S, double K, double r, double sigma, double T, double q, OptionType type, int steps = 100);
+
+    //Newton search for the early exercise boundary; doesn't depend on S. -1 if it didn't converge
+    //always double: the squared objective + finite differences fall apart in single precision
+    double criticalPrice(double K, double r, double sigma, double T, double q, OptionType type, int maxIterations = 100);
+
+    //quadratic approximation around a known critical price
+    template<typename Real>
+    Real priceWithCritical(Real S, Real K, Real r, Real sigma, Real T, Real q, OptionType type, Real Sx) {
+        Real sigma2 = sigma*sigma;
+        Real n = 2 * (r - q) / sigma2;
+        Real k = 2 * r / (sigma2 * (1 - VecMath::exp(-r * T)));
+        Real d1 = (VecMath::log(Sx / K) + (r - q + Real(0.5) * sigma * sigma) * T) / (sigma * VecMath::sqrt(T));
+
+        Real euro = BlackScholes::priceParameter(S, K, r, sigma, T, q, type);
+        Real amer = euro;
+
+        if (type == OptionType::Call) {
+            Real q2 = Real(0.5) * (-n + VecMath::sqrt((n - 1) * (n - 1) + 4 * k));
+            Real A2 = Sx * (1 - VecMath::exp(-q * T) * normCDF(d1)) / q2;
+            amer = (S < Sx) ? euro + A2 * VecMath::pow(S / Sx, q2) : std::max(Real(0), S - K);
+        } else {
+            Real q1 = Real(0.5) * (-n - VecMath::sqrt((n - 1) * (n - 1) + 4 * k));
+            Real A1 = -Sx * (1 - VecMath::exp(-q * T) * normCDF(-d1)) / q1;
+            amer = (S > Sx) ? euro + A1 * VecMath::pow(S / Sx, q1) : std::max(Real(0), K - S);
+        }
+        return amer;
+    }
+
+    template<typename Real>
+    Real priceParameters(Real S, Real K, Real r, Real sigma, Real T, Real q, OptionType type, int steps = 100) {
+        double Sx = criticalPrice(K, r, sigma, T, q, type, steps);
+        if (Sx == -1)
+            return static_cast<Real>(BinomialTree::priceParameters(S, K, r, sigma, T, q, type, FALLBACK_STEPS));
+        return priceWithCritical(S, K, r, sigma, T, q, type, static_cast<Real>(Sx));
+    }
 }
 
 #endif //OPTIONS_SIMULATOR_BAW_H
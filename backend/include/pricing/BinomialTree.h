@@ -7,17 +7,124 @@
 
 #include "shared/OptionEnums.h"
 #include "shared/BinomialWorkspace.h"
+#include "shared/Dividends.h"
 #include "shared/Greeks.h"
 #include "shared/Option.h"
+#include "shared/MathUtils.h"
+#include <algorithm>
+#include <vector>
+
+//stock prices of one CRR tree, shared by every strike on the same (S, T, r, q, sigma, steps).
+//node (n, i) (step n, i down moves) is S u^(n - 2i); the 2 * steps + 1 distinct prices are stored split by parity
+//and descending, so every step's nodes are one contiguous run: level(n)[i]. no pow or division per node
+struct BinomialLattice {
+    int steps = 0;
+    double S = 0.0, T = 0.0, r = 0.0, q = 0.0, sigma = 0.0;
+    double u = 1.0, p = 0.5, discount = 1.0;
+    std::vector<double> spot; // 2 * (steps + 1)
+
+    const double* level(int n) const {
+        return spot.data() + ((steps + n) & 1) * (steps + 1) + ((steps - n) >> 1);
+    }
+    void build(double S, double r, double sigma, double T, double q, int steps);
+    bool matches(double S_, double r_, double sigma_, double T_, double q_, int steps_) const {
+        return steps == steps_ && S == S_ && r == r_ && sigma == sigma_ && T == T_ && q == q_;
+    }
+};
 
 namespace BinomialTree {
+    //the calling thread's lattice behind price() and priceParameters(), grown to at least steps and kept for the
+    //thread's lifetime. batch loops size it up front so a rare fallback row doesn't allocate mid-tick
+    BinomialWorkspace& threadWorkspace(int steps);
     double price(const Option& opt, int steps = 1000);
     //with additional workspace
     double priceWorkspace(const Option& opt, int steps, BinomialWorkspace& workspace);
-    //overload for soa
-    double priceParametersWorkspace(double S, double K, double r, double sigma, double T, double q, OptionType type, int steps, BinomialWorkspace& workspace);
+    //overload for soa; Real = float runs the whole lattice in single precision
+    template<typename Real>
+    Real priceParametersWorkspace(Real S, Real K, Real r, Real sigma, Real T, Real q, OptionType type, int steps, BasicBinomialWorkspace<Real>& workspace) {
+        auto& prices = workspace.prices;
+        auto& option_values = workspace.optionValues;
+        const Real zero = 0;
+
+        Real dt = T / steps;
+        Real u = VecMath::exp(sigma * VecMath::sqrt(dt));
+        Real d = 1 / u;
+        Real p = (VecMath::exp((r-q) * dt) - d) / (u - d);
+        Real discount = VecMath::exp(-r * dt);
+        for (int i = 0; i <= steps; i++) {
+            prices[i] = S * static_cast<Real>(std::pow(u, steps - i) * std::pow(d, i));
+            if (type == OptionType::Call)
+                option_values[i] = std::max(prices[i] - K, zero);
+            else
+                option_values[i] = std::max(K - prices[i], zero);
+        }
+        for (int step = steps - 1; step >= 0; step--) {
+            for (int i = 0; i <= step; i++) {
+                prices[i] /= u;
+                Real continuation = discount * (p * option_values[i] + (1 - p) * option_values[i + 1]);
+                Real exercise;
+                if (type == OptionType::Call)
+                    exercise = std::max(prices[i] - K, zero);
+                else
+                    exercise = std::max(K - prices[i], zero);
+                option_values[i] = std::max(continuation, exercise);
+            }
+        }
+        return option_values[0];
+    }
+    //step count and type fixed at compile time (the if constexpr idea of legacy BinomialTreeSeparated): the lattice
+    //is two arrays on the stack (16 KB at 1000 steps, L1 sized), the exercise test has no branch and the node price
+    //steps down by a multiply by d instead of a divide by u, so the backward sweep vectorizes without a divider
+    //stall. no workspace; matches priceParametersWorkspace to ~1e-12 (that rounding), always american.
+    //the batch kernels pick an instantiation per chunk when steps is one of FIXED_STEPS
+    constexpr int FIXED_STEPS[] = {64, 128, 256, 512, 1000};
+    template<int STEPS, OptionType TYPE, typename Real>
+    Real priceFixed(Real S, Real K, Real r, Real sigma, Real T, Real q) {
+        static_assert(STEPS > 0, "at least one step");
+        constexpr Real sign = TYPE == OptionType::Call ? Real(1) : Real(-1);
+        const Real zero = 0;
+        alignas(64) Real prices[STEPS + 1];
+        alignas(64) Real values[STEPS + 1];
+
+        Real dt = T / STEPS;
+        Real u = VecMath::exp(sigma * VecMath::sqrt(dt));
+        Real d = 1 / u;
+        Real p = (VecMath::exp((r - q) * dt) - d) / (u - d);
+        Real discount = VecMath::exp(-r * dt);
+        for (int i = 0; i <= STEPS; i++) {
+            prices[i] = S * static_cast<Real>(std::pow(u, STEPS - i) * std::pow(d, i));
+            values[i] = std::max(sign * (prices[i] - K), zero);
+        }
+        for (int step = STEPS - 1; step >= 0; step--) {
+            for (int i = 0; i <= step; i++) {
+                prices[i] *= d;
+                Real continuation = discount * (p * values[i] + (1 - p) * values[i + 1]);
+                values[i] = std::max(continuation, std::max(sign * (prices[i] - K), zero));
+            }
+        }
+        return values[0];
+    }
     double priceParameters(double S, double K, double r, double sigma, double T, double q,
                     OptionType type, int steps);
+    //Leisen-Reimer (1996): p and the up move come from the Peizer-Pratt inversion of d2/d1, which centres the tree
+    //on the strike. no odd/even oscillation and roughly second order convergence, so a few thousand steps
+    //stand in for a far larger CRR tree as a reference. steps rounded up to odd; always american
+    double priceLeisenReimer(const Option& opt, int steps, BinomialWorkspace& workspace);
+    double priceLeisenReimer(const Option& opt, int steps = 1001);
+    //discrete cash dividends, escrowed model: the lattice recombines on S* = S - PV(dividends up to T) and a node's
+    //spot is S* plus the escrow still to be paid, so early exercise is checked against the real cum-dividend spot
+    //(e.g. calls just before an ex-date). same O(steps^2) sweep as priceWorkspace; the escrow is one scalar per step.
+    //dividends sorted by time; those outside (0, T] are ignored. honours style (european rows never exercise)
+    double priceDividends(const Option& opt, const std::vector<CashDividend>& dividends, int steps,
+                          BinomialWorkspace& workspace);
+    double priceDividends(const Option& opt, const std::vector<CashDividend>& dividends, int steps = 1000);
+    //backward induction for one strike on a prebuilt lattice; same values as priceWorkspace (always american)
+    double priceOnLattice(const BinomialLattice& lattice, double K, OptionType type, BinomialWorkspace& workspace);
+    //many strikes on one lattice: every step updates all strikes of a node together (STRIKE_LANES per vector),
+    //so a smile costs about count / STRIKE_LANES trees. type[j] per strike; out[j] gets strike j's price
+    constexpr size_t STRIKE_LANES = 8;
+    void priceStrikes(const BinomialLattice& lattice, const double* K, const OptionType* type, size_t count,
+                      double* out, BinomialWorkspace& workspace);
     Greeks computeGreeks(const Option& opt, BinomialWorkspace& workspace, int steps = 1000,
                                 double dS = 0.01, double dT = 1.0 / 365.0,
                                 double dSigma = 0.01, double dR = 0.001);
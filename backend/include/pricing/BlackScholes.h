@@ -13,8 +13,17 @@
 
 namespace BlackScholes{
     double price(const Option& opt);
-    //overloaded to accept SoA
-    double priceParameter(double S, double K, double r, double sigma, double T, double q, OptionType type);
+    //overloaded to accept SoA; templated so float batches stay in single precision
+    template<typename Real>
+    Real priceParameter(Real S, Real K, Real r, Real sigma, Real T, Real q, OptionType type){
+        Real d1 = (VecMath::log(S/K)+(r+sigma*sigma/2)*T)/(sigma*VecMath::sqrt(T));
+        Real d2 = d1-sigma*VecMath::sqrt(T);
+
+        if(type == OptionType::Call)
+            return VecMath::exp(-q * T)* normCDF(d1)*S-normCDF(d2)*K*VecMath::exp(-r*T);
+        else
+            return normCDF(-d2)*K*VecMath::exp(-r*T)-VecMath::exp(-q * T)*normCDF(-d1)*S;
+    }
     double delta(const Option& opt);
     double gamma(const Option& opt);
     double vega(const Option& opt);
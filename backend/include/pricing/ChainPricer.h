@@ -0,0 +1,21 @@
+#ifndef OPTIONS_SIMULATOR_CHAINPRICER_H
+#define OPTIONS_SIMULATOR_CHAINPRICER_H
+
+#include <vector>
+#include "shared/OptionChain.h"
+
+// kernels over an OptionChain; out is in chain order (OptionChain::scatter maps it back).
+// per group, sqrt(T), the discount factors and the log forward are computed once and the european loop runs
+// across strikes with only log(K) and the vol per row. d1 uses the forward (r - q), like the bucketed
+// PricingDispatcher::priceBatch; BlackScholes::priceParameter leaves q out of d1, so the two agree only at q = 0
+namespace ChainPricer {
+    // american rows through BAW
+    void priceBatch(const OptionChain& chain, double* out, int steps = 1000);
+    // american rows through CRR: one stock price lattice per (group, sigma), with all of its strikes stepped
+    // together by BinomialTree::priceStrikes
+    void priceBatchBinomial(const OptionChain& chain, double* out, int steps = 1000);
+    // original row order
+    std::vector<double> priceBatch(const OptionBatch& batch, int steps = 1000);
+}
+
+#endif //OPTIONS_SIMULATOR_CHAINPRICER_H
@@ -0,0 +1,82 @@
+#ifndef OPTIONS_SIMULATOR_CHEBYSHEVSURROGATE_H
+#define OPTIONS_SIMULATOR_CHEBYSHEVSURROGATE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "shared/Option.h"
+#include "shared/OptionBatch.h"
+
+// box over the normalized inputs (x, v, a, b) below
+struct ChebyshevDomain {
+    double lo[4] = {-0.5, 0.02, 0.0, 0.0};
+    double hi[4] = { 0.5, 0.60, 0.15, 0.10};
+};
+
+// precomputed American price surrogate: a Chebyshev tensor over normalized inputs
+//   x = ln(S/K), v = sigma*sqrt(T), a = r*T, b = q*T
+// an american option w/ (S, K, r, sigma, T, q) is K times the one w/ (S/K, 1, a, v, 1, b), so 4 dims suffice.
+// the table stores the early exercise premium over Black-Scholes; european part is added back analytically.
+// the premium has a kink at the exercise boundary, which a tensor this size can't resolve everywhere (deep in the money
+// puts w/ low vol and high carry are the worst). so the domain is also cut into TRUST_CELLS, each checked against the
+// build tree at build time; cells that can't meet MAX_ERROR price on the tree instead of the table
+class ChebyshevSurrogate {
+public:
+    static constexpr int DIMS = 4;
+    static constexpr int LANES = 8; // options evaluated together in the batch kernel
+    // error budget per unit strike: 1e-4 = 1 cent on a 100 strike, a fraction of a 5 cent tick (the
+    // AdaptiveModelSelector default). the build tree's own error (~4e-5 at 500 steps) counts against it
+    static constexpr double MAX_ERROR = 1e-4;
+    static constexpr int TRUST_CELLS[DIMS] = {10, 6, 3, 3};
+    static constexpr int TREE_STEPS = 500; // untrusted cells price on a smoothed (TREE_STEPS, TREE_STEPS+1) tree
+    static constexpr int NUM_CELLS = TRUST_CELLS[0] * TRUST_CELLS[1] * TRUST_CELLS[2] * TRUST_CELLS[3];
+
+    using Domain = ChebyshevDomain;
+
+    struct ErrorReport {
+        size_t count = 0, outOfDomain = 0, onTree = 0; // onTree: in domain, but in a cell over budget
+        double maxAbsPerStrike = 0.0, rmsPerStrike = 0.0; // in-domain rows only; out-of-domain ones are BAW's error
+        double budget = MAX_ERROR;
+        bool withinBudget() const { return maxAbsPerStrike <= budget; }
+    };
+
+    ChebyshevSurrogate() = default;
+
+    // samples the premium at Chebyshev nodes with a smoothed (steps, steps+1) binomial tree, then checks every trust
+    // cell against that tree off the nodes. the carry dims get 10 nodes: at 6 they were what failed most cells
+    void build(const int (&degrees)[DIMS] = {24, 12, 10, 10}, const Domain& domain = Domain{}, int steps = 500);
+    bool empty() const { return coefs_[0].empty(); }
+
+    bool inDomain(double S, double K, double r, double sigma, double T, double q) const;
+    // false: the table misses MAX_ERROR there and the option prices on the tree
+    bool trusted(double S, double K, double r, double sigma, double T, double q, OptionType type) const;
+    // share of trust cells (both types) the table covers
+    double trustedFraction() const;
+    // out-of-domain options fall back to BAW, untrusted cells to the TREE_STEPS tree
+    double price(double S, double K, double r, double sigma, double T, double q, OptionType type) const;
+    // american rows only; european rows of out are left untouched
+    void priceBatch(const OptionBatch& batch, double* out) const;
+    void priceBatch(const OptionBatchView& batch, double* out) const;
+
+    // the gate: max/rms error per unit strike against a smoothed (steps, steps+1) BinomialTree, and whether the max is
+    // within budget
+    ErrorReport checkAgainstBinomial(const std::vector<Option>& options, int steps = 1000,
+                                     double budget = MAX_ERROR) const;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    int degrees_[DIMS] = {0, 0, 0, 0};
+    Domain domain_;
+    std::vector<double> coefs_[2]; // per OptionType, x fastest
+    std::vector<uint8_t> trust_[2];  // per OptionType, NUM_CELLS flags, x fastest
+
+    int cellOf(double x, double v, double a, double b) const;
+    double unitPrice(double x, double v, double a, double b, OptionType type) const; // table price, K = T = 1
+    void validate(int steps);
+    void evaluateLanes(const double* x, const double* v, const double* a, const double* b, OptionType type,
+                       int lanes, double* premium) const;
+};
+
+#endif //OPTIONS_SIMULATOR_CHEBYSHEVSURROGATE_H
@@ -0,0 +1,39 @@
+#ifndef OPTIONS_SIMULATOR_CRANKNICOLSON_H
+#define OPTIONS_SIMULATOR_CRANKNICOLSON_H
+
+#include <vector>
+#include "shared/Greeks.h"
+#include "shared/Option.h"
+#include "shared/OptionBatch.h"
+#include "shared/PDEWorkspace.h"
+
+// spaceSteps is rounded up to even so spot sits on the middle node; the grid spans spot +- width * sigma sqrt(T)
+// (widened to keep the strike well inside). the first two time steps are replaced by four implicit euler
+// half steps (Rannacher) so the payoff kink doesn't ring through crank-nicolson.
+// spaceSteps < 4, timeSteps < 1 or width <= 0 throw std::invalid_argument
+struct PDEGrid {
+    int spaceSteps = 200;
+    int timeSteps = 100;
+    double width = 5.0;
+};
+
+// finite differences in log spot, theta scheme. american exercise via the Brennan-Schwartz projection: the
+// tridiagonal system is eliminated from the far out of the money end and back substituted from the exercise end,
+// clamping to intrinsic on the way, which is exact for a single exercise boundary (vanilla puts and calls).
+// calls are solved on a reflected grid so every lane has its exercise region at node 0 and PDEWorkspace::LANES
+// options (any type/style mix) share one vectorized sweep.
+// delta/gamma come from the middle nodes and theta from the last time step, so greeks cost nothing extra;
+// vega/rho need a reprice and are left at 0. units follow BinomialTree::computeGreeks (theta per year)
+namespace CrankNicolson {
+    double price(const Option& opt, const PDEGrid& grid = {});
+    GreekResult priceAndGreeks(const Option& opt, const PDEGrid& grid, PDEWorkspace& workspace);
+    // rows [first, first + count), count <= LANES; any column of out may be null
+    void priceLanes(const OptionBatchView& batch, size_t first, size_t count, const PDEGrid& grid,
+                    PDEWorkspace& workspace, const GreekColumns& out);
+    // parallel over lane groups, one workspace per thread
+    void priceBatch(const OptionBatchView& batch, double* out, const PDEGrid& grid = {});
+    void priceBatch(const OptionBatchView& batch, const GreekColumns& out, const PDEGrid& grid = {});
+    std::vector<double> priceBatch(const OptionBatch& batch, const PDEGrid& grid = {});
+}
+
+#endif //OPTIONS_SIMULATOR_CRANKNICOLSON_H
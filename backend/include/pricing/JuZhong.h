@@ -8,6 +8,10 @@
 #include "shared/OptionEnums.h"
 #include "shared/Option.h"
 
+//Ju & Zhong (1999): BAW's quadratic approximation with the early exercise premium corrected for how it changes
+//over time (a second order term in ln(S/S*)), same critical price as BAW but found with the closed-form fixed point
+//iteration rather than BAW::price's finite-difference Newton. analytic; more accurate than BAW for long maturities.
+//steps is only used for the binomial fallback when the critical price search doesn't converge, as in BAW::price
 namespace JuZhong {
     double price(const Option& opt, int steps = 1000);
 };
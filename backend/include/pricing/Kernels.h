@@ -0,0 +1,27 @@
+#ifndef OPTIONS_SIMULATOR_KERNELS_H
+#define OPTIONS_SIMULATOR_KERNELS_H
+
+#include <cstddef>
+#include "shared/BinomialWorkspace.h"
+#include "shared/CpuDispatch.h"
+#include "shared/OptionBatch.h"
+
+// the hot batch loops, compiled once per IsaLevel into the same binary (target attributes + flatten, so VecMath,
+// normCDF and the lattice inline into each copy) and picked per call from CpuDispatch::active().
+// every call covers rows [first, first + count) on the calling thread; PricingDispatcher splits the batch across
+// omp threads, since a parallel region inside an isa-specific function would be outlined at the baseline isa
+namespace Kernels {
+    // black-scholes for every row regardless of style, q ignored (priceBatchBlackScholesSIMD)
+    template<typename Real>
+    void blackScholes(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out);
+    // european rows through black-scholes, american rows through BAW (the critical price search itself is
+    // BAW::criticalPrice, which stays baseline)
+    template<typename Real>
+    void priceRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out, int steps);
+    // american rows through the CRR lattice; steps in BinomialTree::FIXED_STEPS run the compile-time instantiations
+    template<typename Real>
+    void binomialRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out, int steps,
+                      BasicBinomialWorkspace<Real>& workspace);
+}
+
+#endif //OPTIONS_SIMULATOR_KERNELS_H
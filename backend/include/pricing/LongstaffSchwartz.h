@@ -0,0 +1,49 @@
+#ifndef OPTIONS_SIMULATOR_LONGSTAFFSCHWARTZ_H
+#define OPTIONS_SIMULATOR_LONGSTAFFSCHWARTZ_H
+
+#include <cstdint>
+#include <vector>
+#include "shared/Option.h"
+#include "shared/OptionBatch.h"
+
+struct LSMConfig {
+    size_t paths = 1 << 14;     // rounded up to a whole number of BLOCK-path blocks
+    int exerciseDates = 50;     // equally spaced, the last one is expiry
+    uint64_t seed = 20250601;
+};
+
+struct LSMResult {
+    double price = 0.0;
+    double stdError = 0.0; // sample std error of the discounted cashflows (conservative under QMC)
+};
+
+// standard brownian motion on [0, 1] at t_i = (i + 1) / dates, stored [date][path] so every exercise date is one
+// contiguous column. it doesn't depend on the option, so one set serves a whole batch: option paths are
+// log S_i = log S + (r - q - sigma^2/2) T t_i + sigma sqrt(T) W_i.
+// built with a brownian bridge: the first Sobol dimensions go to terminal value, midpoint, quarter points...
+// which carry most of the variance; bridge points past Sobol::MAX_DIMS use Philox normals.
+struct LSMPaths {
+    static constexpr size_t BLOCK = 1024; // paths per generation / regression block
+
+    int dates = 0;
+    size_t paths = 0;
+    std::vector<double> W;
+
+    static LSMPaths generate(int dates, size_t paths, uint64_t seed);
+    const double* date(int i) const { return W.data() + static_cast<size_t>(i) * paths; }
+};
+
+// least-squares monte carlo (Longstaff & Schwartz 2001): backward induction over the exercise dates,
+// regressing discounted cashflows of in the money paths on {1, m, m^2}, m = S/K - 1.
+// regression sums are accumulated per BLOCK and added in block order, so results don't depend on thread count.
+// european rows skip the regression (plain monte carlo), which makes Black-Scholes a built in control.
+namespace LongstaffSchwartz {
+    // parallel across path blocks
+    LSMResult price(const Option& opt, const LSMConfig& config = {});
+    LSMResult price(const Option& opt, const LSMPaths& paths);
+    // one path set for the whole batch (common random numbers), parallel across options; stdError may be null
+    void priceBatch(const OptionBatchView& batch, double* out, const LSMConfig& config = {}, double* stdError = nullptr);
+    std::vector<double> priceBatch(const OptionBatch& batch, const LSMConfig& config = {});
+}
+
+#endif //OPTIONS_SIMULATOR_LONGSTAFFSCHWARTZ_H
@@ -11,21 +11,54 @@
 #include "shared/Option.h"
 #include "shared/BinomialWorkspace.h"
 #include "shared/OptionBatch.h"
+#include "shared/ExpiryBuckets.h"
+#include "AdaptiveSelector.h"
+#include "ChebyshevSurrogate.h"
 using AmericanPricerFn = double(*)(const Option&, int);
 
+//every batch call has an overload writing into a caller-provided buffer (out[i] for row i, sized by the caller);
+//the vector-returning forms are wrappers that allocate the result. lattice scratch is per omp thread and reused
+//across calls, so a warm tick through the buffer forms does no heap allocation (AllocationCounter in debug builds)
 class PricingDispatcher {
 public:
     //General
     static double price(const Option& opt);
     static std::vector<double> priceParallelized(const std::vector<Option>& opts, AmericanPricerFn americanPricer, int steps=1000);
-    static std::vector<double> priceBatch(const OptionBatch& batch, int steps = 1000);
+    static void priceParallelized(const std::vector<Option>& opts, AmericanPricerFn americanPricer, double* out, int steps = 1000);
+    //templated on precision; float/double are instantiated in PricingDispatcher.cpp
+    template<typename Real>
+    static std::vector<Real> priceBatch(const BasicOptionBatch<Real>& batch, int steps = 1000);
+    //zero-copy: reads any column storage (e.g. a mapped file), writes into caller's buffer
+    template<typename Real>
+    static void priceBatch(const BasicOptionBatchView<Real>& batch, Real* out, int steps = 1000);
+    //american rows through the lattice instead of BAW
+    template<typename Real>
+    static void priceBatchBinomial(const BasicOptionBatchView<Real>& batch, Real* out, int steps = 1000);
+    //r, q, discount factors and dividends come from per-expiry terms (MarketCurves::buckets) instead of the
+    //row's r/q; european rows price off the prepaid forward, american rows through BAW at the effective q
+    static void priceBatch(const OptionBatchView& batch, const ExpiryBuckets& buckets, double* out, int steps = 1000);
+    //european rows black-scholes, american rows the CRR tree; greeks in BlackScholes::computeGreeks units for both
+    //(vega and rho per point, theta per calendar day). null columns are skipped
+    static void priceAndGreeksBatch(const OptionBatchView& batch, const GreekColumns& out, int steps = 1000);
+    //american rows routed per region to the cheapest model meeting selector's tolerance
+    static std::vector<double> priceBatchAdaptive(const OptionBatch& batch, const AdaptiveModelSelector& selector);
+    static void priceBatchAdaptive(const OptionBatchView& batch, const AdaptiveModelSelector& selector, double* out);
+    //american rows from the precomputed chebyshev table
+    static std::vector<double> priceBatchSurrogate(const OptionBatch& batch, const ChebyshevSurrogate& surrogate);
+    static void priceBatchSurrogate(const OptionBatchView& batch, const ChebyshevSurrogate& surrogate, double* out);
 
     //test specific methods
-    static std::vector<double> priceBatchBlackScholesSIMD(const OptionBatch& batch);
+    template<typename Real>
+    static std::vector<Real> priceBatchBlackScholesSIMD(const BasicOptionBatch<Real>& batch);
+    template<typename Real>
+    static void priceBatchBlackScholesSIMD(const BasicOptionBatchView<Real>& batch, Real* out);
     static std::vector<double> priceBatchBinomialWorkspace(const std::vector<Option>& opts, int steps = 1000);
+    static void priceBatchBinomialWorkspace(const std::vector<Option>& opts, double* out, int steps = 1000);
 
     static std::vector<GreekResult> priceAndGreeks(const std::vector<Option>& opts, int steps = 1000);
+    static void priceAndGreeks(const std::vector<Option>& opts, GreekResult* out, int steps = 1000);
     std::vector<Greeks> greeks(const std::vector<Option>& opts, int steps = 1000);
+    void greeks(const std::vector<Option>& opts, Greeks* out, int steps = 1000);
 
 };
 
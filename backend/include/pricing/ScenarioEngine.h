@@ -0,0 +1,57 @@
+#ifndef OPTIONS_SIMULATOR_SCENARIOENGINE_H
+#define OPTIONS_SIMULATOR_SCENARIOENGINE_H
+
+#include <vector>
+#include "shared/OptionBatch.h"
+
+// spot shocks are relative (S * (1 + shock)), vol shocks absolute (sigma + shock, floored at MIN_SIGMA)
+struct ScenarioGrid {
+    static constexpr double MIN_SIGMA = 1e-4;
+
+    std::vector<double> spotShocks;
+    std::vector<double> volShocks;
+
+    // e.g. uniform(0.10, 21, 0.05, 11): spot -10%..+10%, vol -5..+5 points
+    static ScenarioGrid uniform(double spotRange, int spotSteps, double volRange, int volSteps);
+
+    size_t cells() const { return spotShocks.size() * volShocks.size(); }
+    double shockedSpot(double S, size_t spot) const { return S * (1.0 + spotShocks[spot]); }
+    double shockedVol(double sigma, size_t vol) const {
+        double shocked = sigma + volShocks[vol];
+        return shocked < MIN_SIGMA ? MIN_SIGMA : shocked;
+    }
+};
+
+// reprices a whole batch under every (spot, vol) cell in one pass.
+// per option + vol shock, everything that doesn't depend on spot is hoisted out (discount factors, sqrt(T),
+// log K, and for american rows the BAW critical price + premium coefficients); the inner loop runs across
+// spot shocks so it is branch free and vectorizes.
+// cube layout: [option][vol shock][spot shock], spot fastest
+class ScenarioEngine {
+public:
+    explicit ScenarioEngine(ScenarioGrid grid, int steps = 1000);
+
+    const ScenarioGrid& grid() const { return grid_; }
+    size_t cells() const { return grid_.cells(); }
+    size_t index(size_t option, size_t vol, size_t spot) const {
+        return (option * grid_.volShocks.size() + vol) * grid_.spotShocks.size() + spot;
+    }
+
+    // cube needs batch.size() * cells() entries; base (optional) gets the unshocked price per row
+    void price(const OptionBatchView& batch, double* cube, double* base = nullptr) const;
+    std::vector<double> price(const OptionBatch& batch) const;
+
+    // per-underlying sum of quantity * (cell - base), laid out [underlying][vol][spot].
+    // underlying[i] in [0, numUnderlyings); empty quantity means 1 per row; null base aggregates raw values
+    std::vector<double> aggregate(const double* cube, const double* base, const std::vector<int>& underlying,
+                                  int numUnderlyings, const std::vector<double>& quantity = {}) const;
+
+private:
+    ScenarioGrid grid_;
+    int steps_; // BAW newton iterations, same meaning as PricingDispatcher::priceBatch
+    std::vector<double> spotFactor_, logSpotFactor_;
+
+    void priceRow(const OptionBatchView& batch, size_t i, double* row) const;
+};
+
+#endif //OPTIONS_SIMULATOR_SCENARIOENGINE_H
@@ -0,0 +1,25 @@
+#ifndef OPTIONS_SIMULATOR_ALLOCATIONCOUNTER_H
+#define OPTIONS_SIMULATOR_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+// heap allocations made by the process, for checking that a pricing tick allocates nothing once warm.
+// counting is compiled in with OPTIONS_COUNT_ALLOCATIONS (debug builds, or -DOPTIONS_COUNT_ALLOCATIONS=ON): global
+// operator new is replaced in AllocationCounter.cpp and OptionBatch's aligned_alloc arena reports itself through
+// record(). release builds keep the library's own operator new; enabled() is false and count() stays 0.
+// one relaxed atomic per allocation, shared by all threads: fine for a debug build, not for timing runs
+namespace AllocationCounter {
+    bool enabled();
+    uint64_t count();
+    void record();
+
+    // allocations made while fn runs (by any thread)
+    template<typename Fn>
+    uint64_t during(Fn&& fn) {
+        uint64_t before = count();
+        fn();
+        return count() - before;
+    }
+}
+
+#endif //OPTIONS_SIMULATOR_ALLOCATIONCOUNTER_H
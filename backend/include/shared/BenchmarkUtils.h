@@ -29,6 +29,7 @@ inline double applyAndSum(const Container& container, Func func) {
 
 #include <vector>
 #include <random>
+#include <cstdint>
 #include <tuple>
 #include <algorithm>
 #include "Option.h"
@@ -44,7 +45,9 @@ public:
     std::uniform_real_distribution<double> div_yield{0.0, 0.04};
     std::bernoulli_distribution callPut{0.5};
 
-    RandomGenerator() : gen(std::random_device{}()) {}
+    //fixed default seed so every benchmark and accuracy comparison sees the same book run to run
+    static constexpr uint64_t DEFAULT_SEED = 42;
+    explicit RandomGenerator(uint64_t seed = DEFAULT_SEED) : gen(static_cast<std::mt19937::result_type>(seed)) {}
 
     auto generateOptionParams() {
         return std::make_tuple(
@@ -59,8 +62,9 @@ public:
     }
 };
 
-inline std::vector<Option> generateOptions(int count, OptionStyle style) {
-    RandomGenerator rng;
+//AoS, single threaded; large books should use OptionGenerator (shared/OptionGenerator.h), which writes SoA in parallel
+inline std::vector<Option> generateOptions(int count, OptionStyle style, uint64_t seed = RandomGenerator::DEFAULT_SEED) {
+    RandomGenerator rng(seed);
     std::vector<Option> options;
     options.reserve(count);
     for (int i = 0; i < count; i++) {
@@ -70,8 +74,8 @@ inline std::vector<Option> generateOptions(int count, OptionStyle style) {
     return options;
 }
 
-inline std::vector<Option> generateMixedOptions(int european, int american) {
-    RandomGenerator rng;
+inline std::vector<Option> generateMixedOptions(int european, int american, uint64_t seed = RandomGenerator::DEFAULT_SEED) {
+    RandomGenerator rng(seed);
     std::vector<Option> options;
     options.reserve(european + american);
 
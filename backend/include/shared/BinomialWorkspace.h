@@ -8,16 +8,24 @@
 #include <vector>
 #include <cstddef>
 //create once so don't have to reallocate space for every option
-struct BinomialWorkspace {
-    std::vector<double> prices;
-    std::vector<double> optionValues;
-    explicit BinomialWorkspace(size_t steps) {
+template<typename Real>
+struct BasicBinomialWorkspace {
+    std::vector<Real> prices;
+    std::vector<Real> optionValues;
+    std::vector<Real> strikeValues; // node-major, one lane per strike; sized on first multi-strike use
+    explicit BasicBinomialWorkspace(size_t steps) {
         resize(steps);
     }
     void resize(size_t steps) {
         prices.resize(steps + 1);
         optionValues.resize(steps + 1);
     }
+    //grow only: a smaller step count reuses the buffers as they are
+    void reserveSteps(size_t steps) {
+        if (prices.size() < steps + 1) resize(steps);
+    }
 };
+using BinomialWorkspace = BasicBinomialWorkspace<double>;
+using BinomialWorkspaceF = BasicBinomialWorkspace<float>;
 
 #endif //OPTIONS_SIMULATOR_BINOMIALWORKSPACE_H
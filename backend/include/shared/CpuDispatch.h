@@ -0,0 +1,23 @@
+#ifndef OPTIONS_SIMULATOR_CPUDISPATCH_H
+#define OPTIONS_SIMULATOR_CPUDISPATCH_H
+
+#include <string>
+
+// instruction set levels the multi-versioned kernels (pricing/Kernels.h) are compiled for.
+// avx2 means avx2 + fma + bmi2; avx512 means the skylake-server set (f, dq, vl, bw)
+enum class IsaLevel { Baseline = 0, SSE42, AVX2, AVX512, COUNT };
+
+// the level is chosen once per process: the best one cpuid (and the OS's saved register state) supports, lowered by
+// OPTIONS_ISA=baseline|sse4.2|avx2|avx512 if set. a request above what the cpu has is clamped, so the override can
+// make a host slower but never crash it
+namespace CpuDispatch {
+    IsaLevel detected();
+    IsaLevel active();
+    // for benchmarks comparing levels in one process; clamped to detected(). not meant to race with pricing calls
+    void setActive(IsaLevel level);
+
+    const char* name(IsaLevel level);
+    IsaLevel fromName(const std::string& name); // throws std::invalid_argument
+}
+
+#endif //OPTIONS_SIMULATOR_CPUDISPATCH_H
@@ -0,0 +1,10 @@
+#ifndef OPTIONS_SIMULATOR_DIVIDENDS_H
+#define OPTIONS_SIMULATOR_DIVIDENDS_H
+
+// cash amount paid at time (years from today); the spot drops by amount on the ex-date
+struct CashDividend {
+    double time;
+    double amount;
+};
+
+#endif //OPTIONS_SIMULATOR_DIVIDENDS_H
@@ -0,0 +1,24 @@
+#ifndef OPTIONS_SIMULATOR_EXPIRYBUCKETS_H
+#define OPTIONS_SIMULATOR_EXPIRYBUCKETS_H
+
+#include <cstdint>
+#include <vector>
+
+// everything a pricer needs from the curves at one expiry; computed once per expiry, not per row
+struct ExpiryTerms {
+    double T = 0.0;
+    double r = 0.0;             // zero rate to T
+    double q = 0.0;             // continuous carry (borrow + dividend yield) to T, discrete dividends excluded
+    double discount = 1.0;      // exp(-r T)
+    double carryDiscount = 1.0; // exp(-q T)
+    double pvDividends = 0.0;   // cash dividends paid in (0, T], discounted to today
+    double sqrtT = 0.0;
+};
+
+// bucket[i] indexes terms for row i of the batch it was built from
+struct ExpiryBuckets {
+    std::vector<ExpiryTerms> terms;
+    std::vector<uint32_t> bucket;
+};
+
+#endif //OPTIONS_SIMULATOR_EXPIRYBUCKETS_H
@@ -18,5 +18,15 @@ struct GreekResult {
     Greeks greeks;
 };
 
+//SoA destination for batch price + greeks (e.g. columns of a mapped result file)
+struct GreekColumns {
+    double* price = nullptr;
+    double* delta = nullptr;
+    double* gamma = nullptr;
+    double* theta = nullptr;
+    double* vega  = nullptr;
+    double* rho   = nullptr;
+};
+
 
 #endif //OPTIONS_SIMULATOR_OPTIOINRESULT_H
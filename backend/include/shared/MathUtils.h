@@ -6,6 +6,7 @@
 #define OPTIONS_SIMULATOR_MATHUTILS_H
 
 #include <cmath>
+#include "VecMath.h"
 
 inline double normCDF(double x) noexcept {
     //probability that random var following a normal distribution, <= given x
@@ -16,4 +17,39 @@ inline double normPDF(double x) noexcept{
     return (1/sqrt(2*M_PI))*exp(-x*x/2);
 }
 
+//inverse of normCDF for p in (0, 1): Acklam's rational approximation (~1e-9) + one Halley step to full precision
+inline double invNormCDF(double p) noexcept {
+    static constexpr double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                   1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static constexpr double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                   6.680131188771972e+01, -1.328068155288572e+01};
+    static constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                   -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static constexpr double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                   3.754408661907416e+00};
+    double x;
+    if (p < 0.02425 || p > 1 - 0.02425) {
+        double t = std::sqrt(-2 * std::log(p < 0.5 ? p : 1 - p));
+        x = (((((c[0] * t + c[1]) * t + c[2]) * t + c[3]) * t + c[4]) * t + c[5]) /
+            ((((d[0] * t + d[1]) * t + d[2]) * t + d[3]) * t + 1);
+        if (p > 0.5) x = -x;
+    } else {
+        double t = p - 0.5, t2 = t * t;
+        x = (((((a[0] * t2 + a[1]) * t2 + a[2]) * t2 + a[3]) * t2 + a[4]) * t2 + a[5]) * t /
+            (((((b[0] * t2 + b[1]) * t2 + b[2]) * t2 + b[3]) * t2 + b[4]) * t2 + 1);
+    }
+    double e = normCDF(x) - p;
+    double u = e * std::sqrt(2 * M_PI) * std::exp(x * x / 2);
+    return x - u / (1 + x * u / 2);
+}
+
+//single precision overloads picked up by the templated kernels
+inline float normCDF(float x) noexcept {
+    return VecMath::erfc(-x * 0.70710678118654752f) * 0.5f;
+}
+
+inline float normPDF(float x) noexcept {
+    return 0.39894228040143268f * VecMath::exp(-x * x * 0.5f);
+}
+
 #endif //OPTIONS_SIMULATOR_MATHUTILS_H
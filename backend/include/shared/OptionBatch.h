@@ -5,42 +5,243 @@
 #ifndef OPTIONS_SIMULATOR_OPTIONBATCH_H
 #define OPTIONS_SIMULATOR_OPTIONBATCH_H
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
 #include <vector>
+#include "AllocationCounter.h"
 #include "Option.h"
 
+constexpr size_t BATCH_ALIGNMENT = 64; // one cache line / one AVX-512 register
+constexpr size_t BATCH_LANES = 8;      // doubles per AVX-512 register; capacity is padded to a multiple
+
+inline size_t padToLanes(size_t n, size_t lanes = BATCH_LANES) {
+    return (n + lanes - 1) / lanes * lanes;
+}
+
+//mask lanes match the value width: 64-bit for double batches, 32-bit for float
+template<typename Real>
+using LaneMask = std::conditional_t<sizeof(Real) == 8, uint64_t, uint32_t>;
+
+//type/style stored as lane-width masks (0 or ~0) so SIMD kernels can blend on them directly
+template<typename Enum, typename Mask = uint64_t>
+struct MaskSpan{
+    const Mask* mask;
+    Enum operator[](size_t i) const {
+        return static_cast<Enum>(mask[i] & 1);
+    }
+    const Mask* data() const {
+        return mask;
+    }
+};
+
+//non-owning column pointers; lets kernels price a mapped file or any other SoA storage w/o copying
+template<typename Real>
+struct BasicOptionBatchView{
+    const Real *S, *K, *r, *sigma, *T, *q;
+    MaskSpan<OptionType, LaneMask<Real>> type;      // ~0 for Put
+    MaskSpan<OptionStyle, LaneMask<Real>> style;    // ~0 for American
+    size_t n;
+    size_t padded;                  // rows readable in every column (n rounded up to the lane count)
+    size_t size() const {
+        return n;
+    }
+};
+using OptionBatchView = BasicOptionBatchView<double>;
+using OptionBatchViewF = BasicOptionBatchView<float>;
+
+template<typename T>
+struct BatchColumn{
+    T* ptr = nullptr;
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+};
+
+template<typename Enum, typename Mask = uint64_t>
+struct MaskColumn{
+    Mask* ptr = nullptr;
+    Enum operator[](size_t i) const { return static_cast<Enum>(ptr[i] & 1); }
+    void set(size_t i, Enum value) { ptr[i] = value ? ~Mask{0} : 0; }
+    Mask* data() { return ptr; }
+    const Mask* data() const { return ptr; }
+};
+
+//structure of arrays SoA; easier manipulation w/ SIMD
+//all columns are carved from one 64-byte aligned arena; capacity is a multiple of BATCH_LANES and the
+//padded tail is zeroed, so vector loops can run unmasked to padded() and copying is a single memcpy
+//Real = float halves memory traffic and doubles lanes for screening/scenario work
+template<typename Real>
+struct BasicOptionBatch{
+    using Mask = LaneMask<Real>;
+    BatchColumn<Real> S, K, r, sigma, T, q;
+    MaskColumn<OptionType, Mask> type;
+    MaskColumn<OptionStyle, Mask> style;
+
+    static constexpr size_t COLUMNS = 8;
+    static constexpr size_t LANES = BATCH_ALIGNMENT / sizeof(Real);
+
+    BasicOptionBatch() = default;
+    explicit BasicOptionBatch(size_t n) { resize(n); }
+    ~BasicOptionBatch() { std::free(arena_); }
+
+    BasicOptionBatch(const BasicOptionBatch& other) {
+        allocate(other.capacity_, false);
+        copyArena(other);
+    }
+    BasicOptionBatch& operator=(const BasicOptionBatch& other) {
+        if (this == &other) return *this;
+        if (capacity_ != other.capacity_) { // copy-and-swap: a failed allocation leaves *this untouched
+            BasicOptionBatch copy(other);
+            return *this = std::move(copy);
+        }
+        copyArena(other); // same capacity: reuse arena, no allocation
+        return *this;
+    }
+    BasicOptionBatch(BasicOptionBatch&& other) noexcept { steal(other); }
+    BasicOptionBatch& operator=(BasicOptionBatch&& other) noexcept {
+        if (this != &other) {
+            std::free(arena_);
+            steal(other);
+        }
+        return *this;
+    }
 
-struct OptionBatch{
-    std::vector<double> S, K, r, sigma, T, q;
-    std::vector<OptionType> type;
-    std::vector<OptionStyle> style;
-    //structure of arrays SoA; easier manipulation w/ SIMD
     void reserve(const size_t N){
-        S.reserve(N); K.reserve(N); r.reserve(N);
-        sigma.reserve(N); T.reserve(N); q.reserve(N); type.reserve(N);
-        style.reserve(N);
+        if (N > capacity_) grow(padToLanes(N, LANES));
+    }
+    //rows past size() are always zero, so growing exposes zeroed rows
+    void resize(const size_t N){
+        reserve(N);
+        for (size_t col = 0; col < COLUMNS && N < size_; ++col)
+            std::memset(static_cast<Real*>(arena_) + col * capacity_ + N, 0, (size_ - N) * sizeof(Real));
+        size_ = N;
+    }
+    void clear(){
+        if (arena_) std::memset(arena_, 0, arenaBytes(capacity_));
+        size_ = 0;
     }
     void push_back(const Option& opt){
-        S.push_back(opt.S);
-        K.push_back(opt.K);
-        r.push_back(opt.r);
-        sigma.push_back(opt.sigma);
-        T.push_back(opt.T);
-        q.push_back(opt.q);
-        type.push_back(opt.type);
-        style.push_back(opt.style);
+        if (size_ == capacity_) grow(capacity_ == 0 ? LANES : capacity_ * 2);
+        set(size_++, opt);
+    }
+    void set(size_t i, const Option& opt){
+        S[i] = static_cast<Real>(opt.S);
+        K[i] = static_cast<Real>(opt.K);
+        r[i] = static_cast<Real>(opt.r);
+        sigma[i] = static_cast<Real>(opt.sigma);
+        T[i] = static_cast<Real>(opt.T);
+        q[i] = static_cast<Real>(opt.q);
+        type.set(i, opt.type);
+        style.set(i, opt.style);
+    }
+    Option get(size_t i) const {
+        return {S[i], K[i], r[i], sigma[i], T[i], q[i], type[i], style[i]};
     }
     size_t size() const {
-        return S.size();
+        return size_;
+    }
+    size_t capacity() const {
+        return capacity_;
+    }
+    size_t padded() const {
+        return padToLanes(size_, LANES);
+    }
+    BasicOptionBatchView<Real> view() const {
+        return {S.data(), K.data(), r.data(), sigma.data(), T.data(), q.data(),
+                {type.data()}, {style.data()}, size_, padded()};
+    }
+
+private:
+    void* arena_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+
+    static size_t arenaBytes(size_t capacity) {
+        return COLUMNS * capacity * sizeof(Real);
+    }
+    //capacity_ and the columns only change once the arena exists
+    void allocate(size_t capacity, bool zero = true) {
+        void* arena = nullptr;
+        if (capacity != 0) {
+            arena = std::aligned_alloc(BATCH_ALIGNMENT, arenaBytes(capacity));
+            if (!arena) throw std::bad_alloc();
+            AllocationCounter::record(); // malloc family, so operator new doesn't see it
+            if (zero) std::memset(arena, 0, arenaBytes(capacity));
+        }
+        arena_ = arena;
+        capacity_ = capacity;
+        bindColumns();
+    }
+    //capacity is a multiple of LANES, so every column offset stays 64-byte aligned
+    void bindColumns() {
+        if (!arena_) {
+            S.ptr = K.ptr = r.ptr = sigma.ptr = T.ptr = q.ptr = nullptr;
+            type.ptr = style.ptr = nullptr;
+            return;
+        }
+        auto* base = static_cast<Real*>(arena_);
+        size_t c = capacity_;
+        S.ptr = base; K.ptr = base + c; r.ptr = base + 2 * c;
+        sigma.ptr = base + 3 * c; T.ptr = base + 4 * c; q.ptr = base + 5 * c;
+        type.ptr = reinterpret_cast<Mask*>(base + 6 * c);
+        style.ptr = reinterpret_cast<Mask*>(base + 7 * c);
+    }
+    void copyArena(const BasicOptionBatch& other) {
+        if (arena_) std::memcpy(arena_, other.arena_, arenaBytes(capacity_));
+        size_ = other.size_;
+    }
+    void grow(size_t capacity) {
+        BasicOptionBatch bigger;
+        bigger.allocate(capacity);
+        auto* dst = static_cast<Real*>(bigger.arena_);
+        auto* src = static_cast<const Real*>(arena_);
+        for (size_t col = 0; col < COLUMNS && src; ++col)
+            std::memcpy(dst + col * capacity, src + col * capacity_, size_ * sizeof(Real));
+        bigger.size_ = size_;
+        *this = std::move(bigger);
+    }
+    void steal(BasicOptionBatch& other) {
+        arena_ = other.arena_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        bindColumns();
+        other.arena_ = nullptr;
+        other.size_ = other.capacity_ = 0;
+        other.bindColumns();
     }
 };
 
+using OptionBatch = BasicOptionBatch<double>;
+using OptionBatchF = BasicOptionBatch<float>;
+
+//precision conversion, e.g. double book -> float screening copy
+template<typename To, typename From>
+BasicOptionBatch<To> convertBatch(const BasicOptionBatch<From>& batch) {
+    BasicOptionBatch<To> out(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        out.S[i] = static_cast<To>(batch.S[i]);
+        out.K[i] = static_cast<To>(batch.K[i]);
+        out.r[i] = static_cast<To>(batch.r[i]);
+        out.sigma[i] = static_cast<To>(batch.sigma[i]);
+        out.T[i] = static_cast<To>(batch.T[i]);
+        out.q[i] = static_cast<To>(batch.q[i]);
+        out.type.set(i, batch.type[i]);
+        out.style.set(i, batch.style[i]);
+    }
+    return out;
+}
+
 // Convert AoS -> SoA
 inline OptionBatch toBatch(const std::vector<Option>& options) {
     OptionBatch batch;
-    batch.reserve(options.size());
+    batch.resize(options.size());
 
-    for (const auto& opt : options) {
-        batch.push_back(opt);
+    for (size_t i = 0; i < options.size(); ++i) {
+        batch.set(i, options[i]);
     }
     return batch;
 }
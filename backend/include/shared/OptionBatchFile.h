@@ -0,0 +1,110 @@
+#ifndef OPTIONS_SIMULATOR_OPTIONBATCHFILE_H
+#define OPTIONS_SIMULATOR_OPTIONBATCHFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "OptionBatch.h"
+#include "Greeks.h"
+
+/* Versioned columnar file mirroring OptionBatch:
+ *   [header][S][K][r][sigma][T][q][type][style][id offsets][id chars]   (book)
+ *   [header][price][delta][gamma][theta][vega][rho]                      (results)
+ * every column starts on a 64 byte boundary and per-row columns hold padToLanes(rows) zero-padded entries,
+ * so a mapped file can be priced in place with the same unmasked loops as OptionBatch.
+ * v2: type/style are 8 byte lane masks (v1 stored 1 byte enums) */
+namespace BatchFile {
+    constexpr uint32_t VERSION = 2;
+    constexpr size_t ALIGNMENT = 64;
+    constexpr int MAX_COLUMNS = 16;
+
+    enum class Column : uint32_t {
+        S, K, r, sigma, T, q, type, style, idOffsets, idChars,
+        price, delta, gamma, theta, vega, rho
+    };
+
+    struct ColumnEntry {
+        uint32_t id;
+        uint32_t elementSize;
+        uint64_t offset;
+        uint64_t bytes;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t columnCount;
+        uint64_t rows;
+        uint32_t endianTag;     // 0x01020304 as written by the producer
+        uint32_t reserved;
+        ColumnEntry columns[MAX_COLUMNS];
+    };
+
+    // throws std::runtime_error on I/O failure; ids may be empty, otherwise one per row
+    void writeBook(const std::string& path, const OptionBatchView& batch, const std::vector<std::string>& ids = {});
+}
+
+// RAII mmap of a whole file
+class MappedRegion {
+public:
+    MappedRegion() = default;
+    MappedRegion(const std::string& path, bool writable);
+    ~MappedRegion();
+    MappedRegion(MappedRegion&& other) noexcept;
+    MappedRegion& operator=(MappedRegion&& other) noexcept;
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    void sync() const;
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    void release();
+};
+
+// read-only, zero-copy book; view() points straight into the mapping
+class MappedOptionBatch {
+public:
+    explicit MappedOptionBatch(const std::string& path);
+
+    const OptionBatchView& view() const { return view_; }
+    size_t size() const { return view_.n; }
+    bool hasIds() const { return idOffsets_ != nullptr; }
+    std::string_view instrumentId(size_t i) const;
+
+private:
+    MappedRegion region_;
+    OptionBatchView view_{};
+    const uint64_t* idOffsets_ = nullptr;
+    const char* idChars_ = nullptr;
+};
+
+// price + greeks columns; create() sizes a new file, open() maps an existing one
+class MappedResultFile {
+public:
+    static MappedResultFile create(const std::string& path, size_t rows);
+    static MappedResultFile open(const std::string& path, bool writable = false);
+
+    // output columns to price into; throws std::logic_error when the file was opened read-only, since writes
+    // through a PROT_READ mapping fault
+    const GreekColumns& columns() const;
+    // read access in either mode; id is one of price..rho
+    const double* column(BatchFile::Column id) const;
+    bool writable() const { return writable_; }
+    size_t size() const { return rows_; }
+    void sync() const { region_.sync(); }
+
+private:
+    MappedResultFile(MappedRegion region, bool writable);
+    MappedRegion region_;
+    GreekColumns columns_{};
+    size_t rows_ = 0;
+    bool writable_ = false;
+};
+
+#endif //OPTIONS_SIMULATOR_OPTIONBATCHFILE_H
@@ -0,0 +1,37 @@
+#ifndef OPTIONS_SIMULATOR_OPTIONCHAIN_H
+#define OPTIONS_SIMULATOR_OPTIONCHAIN_H
+
+#include <vector>
+#include "OptionBatch.h"
+
+//rows [first, first + count) of the chain batch share spot, expiry, rate and yield
+struct ChainGroup {
+    double S, T, r, q;
+    size_t first, count;
+};
+
+//a batch regrouped underlying -> expiry -> strikes so kernels can hoist everything per (S, T, r, q) out of the
+//row loop. within a group rows are ordered by (style, sigma, type, K): american rows on one vol are adjacent, which
+//is what a shared binomial lattice needs, and calls/puts are apart so strike lanes share one payoff shape.
+//order()[k] is the original row of chain row k
+class OptionChain {
+public:
+    OptionChain() = default;
+    explicit OptionChain(const OptionBatchView& batch);
+
+    const OptionBatch& batch() const { return batch_; }
+    OptionBatchView view() const { return batch_.view(); }
+    const std::vector<ChainGroup>& groups() const { return groups_; }
+    const std::vector<size_t>& order() const { return order_; }
+    size_t size() const { return batch_.size(); }
+
+    //chain-ordered results back into the original row order
+    void scatter(const double* chainOrdered, double* original) const;
+
+private:
+    OptionBatch batch_;
+    std::vector<ChainGroup> groups_;
+    std::vector<size_t> order_;
+};
+
+#endif //OPTIONS_SIMULATOR_OPTIONCHAIN_H
@@ -0,0 +1,33 @@
+#ifndef OPTIONS_SIMULATOR_OPTIONGENERATOR_H
+#define OPTIONS_SIMULATOR_OPTIONGENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include "OptionBatch.h"
+
+// uniform: the RandomGenerator ranges (S, K in 90..110, T 0.2..2, sigma 0.05..0.3)
+// chain:   listed chains. per underlying: spot, rate, yield, atm vol and style; fixed expiries from 1 week to 5
+//          years; strikes on a tick grid around the forward; a skewed smile; calls and puts. rows run
+//          underlying -> expiry -> strike -> call/put
+// stress:  log(K/S) in +-2.5, T from one hour to 10 years, sigma 1%..250%, r -1%..15%, q 0..12%
+enum class OptionProfile { Uniform, Chain, Stress };
+
+struct GeneratorConfig {
+    OptionProfile profile = OptionProfile::Uniform;
+    uint64_t seed = 42;
+    double europeanFraction = 0.5; // per row; per underlying for chains
+    int expiries = 12;             // chain: first n of the listed expiries (max 12)
+    int strikesPerExpiry = 40;     // chain
+};
+
+// row i is a pure function of (seed, profile, i) through Philox, so generation runs in parallel straight into the
+// batch columns and the same config gives the same book for any thread count or batch size prefix
+namespace OptionGenerator {
+    void generate(OptionBatch& batch, size_t n, const GeneratorConfig& config);
+    OptionBatch generate(size_t n, const GeneratorConfig& config);
+
+    OptionProfile profileFromName(const std::string& name); // "uniform", "chain", "stress"; throws otherwise
+    const char* profileName(OptionProfile profile);
+}
+
+#endif //OPTIONS_SIMULATOR_OPTIONGENERATOR_H
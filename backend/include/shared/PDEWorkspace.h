@@ -0,0 +1,33 @@
+#ifndef OPTIONS_SIMULATOR_PDEWORKSPACE_H
+#define OPTIONS_SIMULATOR_PDEWORKSPACE_H
+
+#include <vector>
+#include <cstddef>
+
+//grid storage for CrankNicolson, created once per thread and reused like BinomialWorkspace.
+//every array is [node][lane]: LANES options are stepped together and the inner loops run across lanes
+struct PDEWorkspace {
+    static constexpr size_t LANES = 8;
+    static constexpr int PHASES = 2; // rannacher implicit half steps, then crank-nicolson
+
+    size_t nodes = 0;
+    std::vector<double> value, rhs, intrinsic, floor;
+    std::vector<double> invPivot[PHASES], multiplier[PHASES]; // brennan-schwartz elimination, fixed per phase
+
+    explicit PDEWorkspace(size_t nodes) {
+        resize(nodes);
+    }
+    void resize(size_t n) {
+        nodes = n;
+        value.resize(n * LANES);
+        rhs.resize(n * LANES);
+        intrinsic.resize(n * LANES);
+        floor.resize(n * LANES);
+        for (int p = 0; p < PHASES; ++p) {
+            invPivot[p].resize(n * LANES);
+            multiplier[p].resize(n * LANES);
+        }
+    }
+};
+
+#endif //OPTIONS_SIMULATOR_PDEWORKSPACE_H
@@ -0,0 +1,74 @@
+#ifndef OPTIONS_SIMULATOR_PERFCOUNTERS_H
+#define OPTIONS_SIMULATOR_PERFCOUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class PerfEvent {
+    Cycles, Instructions, CacheReferences, CacheMisses, Branches, BranchMisses,
+    FpScalar,  // retired scalar double/single FP arithmetic (intel FP_ARITH_INST_RETIRED)
+    FpPacked,  // retired 128/256/512-bit packed FP arithmetic instructions
+    PageFaults,
+    COUNT
+};
+
+// counts summed over every thread a region ran on; -1 where the event couldn't be opened (no PMU in a VM,
+// perf_event_paranoid, non-intel FP events, not linux). multiplexed events are scaled by enabled/running time
+struct PerfSample {
+    static constexpr int EVENTS = static_cast<int>(PerfEvent::COUNT);
+    int64_t count[EVENTS];
+    double seconds = 0.0;
+
+    PerfSample() { for (int64_t& c : count) c = -1; }
+    bool has(PerfEvent e) const { return count[static_cast<int>(e)] >= 0; }
+    double operator[](PerfEvent e) const { return static_cast<double>(count[static_cast<int>(e)]); }
+
+    double ipc() const;
+    double cacheMissesPerKiloInstruction() const;
+    double branchMissRate() const;
+    // share of FP instructions that were packed: ~0 means the "simd" loop ran scalar
+    double vectorShare() const;
+
+    // one line: cycles/instr/misses per option, IPC, MPKI, packed share; n/a for missing events
+    std::string summary(size_t options) const;
+    // "name": value pairs per option, for the benchmark json
+    std::string json(size_t options) const;
+};
+
+// perf_event_open counters for the calling thread and every OpenMP worker. omp threads are pooled and outlive
+// the region, so inherit doesn't reach them: the constructor opens one set of counters from inside each of
+// omp_get_max_threads() threads and start/stop toggle all of them from the caller. construct after choosing the
+// thread count. copying is disabled (owns file descriptors)
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const; // at least one event opened
+    // why counters are missing, e.g. "cycles: Permission denied"; empty when everything opened
+    const std::string& error() const { return error_; }
+
+    void start(); // resets and enables
+    PerfSample stop();
+
+    template<typename Fn>
+    PerfSample measure(Fn&& fn) {
+        start();
+        fn();
+        return stop();
+    }
+
+    // PERF_COUNTERS=1 in the environment turns on the per-tick counters in the pricing loops
+    static bool enabledFromEnv();
+
+private:
+    struct Counter { int fd; PerfEvent event; };
+    std::vector<Counter> counters_;
+    std::string error_;
+    double startSeconds_ = 0.0;
+};
+
+#endif //OPTIONS_SIMULATOR_PERFCOUNTERS_H
@@ -0,0 +1,105 @@
+#ifndef OPTIONS_SIMULATOR_PHILOX_H
+#define OPTIONS_SIMULATOR_PHILOX_H
+
+#include <cstddef>
+#include <cstdint>
+#include "VecMath.h"
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// counter based: block b of stream s is a pure function of (seed, s, b), so any thread can generate any
+// scenario's draws and results don't depend on thread count or scheduling
+namespace Philox {
+    constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+    inline void round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) noexcept {
+        uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+        uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+        uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+    }
+
+    // in place: c = counter in, random words out. rounds spelled out so the caller's loop stays a single
+    // straight-line body the vectorizer can take
+    inline void block(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint64_t seed) noexcept {
+        uint32_t k0 = static_cast<uint32_t>(seed), k1 = static_cast<uint32_t>(seed >> 32);
+        round(c0, c1, c2, c3, k0, k1);
+        round(c0, c1, c2, c3, k0 + 1 * W0, k1 + 1 * W1);
+        round(c0, c1, c2, c3, k0 + 2 * W0, k1 + 2 * W1);
+        round(c0, c1, c2, c3, k0 + 3 * W0, k1 + 3 * W1);
+        round(c0, c1, c2, c3, k0 + 4 * W0, k1 + 4 * W1);
+        round(c0, c1, c2, c3, k0 + 5 * W0, k1 + 5 * W1);
+        round(c0, c1, c2, c3, k0 + 6 * W0, k1 + 6 * W1);
+        round(c0, c1, c2, c3, k0 + 7 * W0, k1 + 7 * W1);
+        round(c0, c1, c2, c3, k0 + 8 * W0, k1 + 8 * W1);
+        round(c0, c1, c2, c3, k0 + 9 * W0, k1 + 9 * W1);
+    }
+
+    inline void block(uint32_t (&c)[4], uint64_t seed) noexcept {
+        block(c[0], c[1], c[2], c[3], seed);
+    }
+
+    // 24 bit uniform in the open interval (0, 1); never 0 so log() is safe
+    inline float toUniform(uint32_t x) noexcept {
+        return (static_cast<float>(x >> 8) + 0.5f) * (1.0f / 16777216.0f);
+    }
+
+    // sin/cos of 2*pi*u for u in (0, 1); odd polynomial on a quarter period, |err| < 1e-7
+    inline void sinCos2Pi(float u, float& s, float& c) noexcept {
+        auto sinTurn = [](float x) { // x in [-0.5, 0.5] turns
+            x = x > 0.25f ? 0.5f - x : x;
+            x = x < -0.25f ? -0.5f - x : x;
+            float t = x * 6.28318530717958648f;
+            float t2 = t * t;
+            float p = -2.5052108385e-8f;
+            p = p * t2 + 2.7557319224e-6f;
+            p = p * t2 - 1.9841269841e-4f;
+            p = p * t2 + 8.3333333333e-3f;
+            p = p * t2 - 1.6666666667e-1f;
+            return t + t * t2 * p;
+        };
+        float x = u > 0.5f ? u - 1.0f : u;
+        float y = x + 0.25f; // cos(2 pi x) = sin(2 pi (x + 1/4))
+        y = y > 0.5f ? y - 1.0f : y;
+        s = sinTurn(x);
+        c = sinTurn(y);
+    }
+
+    // n standard normals for one stream (e.g. one scenario); block b -> counter (b, 0, stream lo, stream hi),
+    // each block's four words feed two Box-Muller pairs. the block loop has no branches and vectorizes
+    inline void normals(uint64_t seed, uint64_t stream, float* out, size_t n) noexcept {
+        const uint32_t s0 = static_cast<uint32_t>(stream), s1 = static_cast<uint32_t>(stream >> 32);
+        const size_t blocks = n / 4;
+        #pragma omp simd
+        for (size_t b = 0; b < blocks; ++b) {
+            uint32_t c0 = static_cast<uint32_t>(b), c1 = 0u, c2 = s0, c3 = s1;
+            block(c0, c1, c2, c3, seed);
+            float r0 = VecMath::sqrt(-2.0f * VecMath::log(toUniform(c0)));
+            float r1 = VecMath::sqrt(-2.0f * VecMath::log(toUniform(c2)));
+            float sin0, cos0, sin1, cos1;
+            sinCos2Pi(toUniform(c1), sin0, cos0);
+            sinCos2Pi(toUniform(c3), sin1, cos1);
+            out[4 * b] = r0 * cos0;
+            out[4 * b + 1] = r0 * sin0;
+            out[4 * b + 2] = r1 * cos1;
+            out[4 * b + 3] = r1 * sin1;
+        }
+        if (n % 4) {
+            float tail[4];
+            uint32_t c[4] = {static_cast<uint32_t>(blocks), 0u, s0, s1};
+            block(c, seed);
+            float r0 = VecMath::sqrt(-2.0f * VecMath::log(toUniform(c[0])));
+            float r1 = VecMath::sqrt(-2.0f * VecMath::log(toUniform(c[2])));
+            sinCos2Pi(toUniform(c[1]), tail[1], tail[0]);
+            sinCos2Pi(toUniform(c[3]), tail[3], tail[2]);
+            tail[0] *= r0; tail[1] *= r0; tail[2] *= r1; tail[3] *= r1;
+            for (size_t k = 0; k < n % 4; ++k) out[4 * blocks + k] = tail[k];
+        }
+    }
+}
+
+#endif //OPTIONS_SIMULATOR_PHILOX_H
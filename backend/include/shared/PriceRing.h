@@ -0,0 +1,116 @@
+#ifndef OPTIONS_SIMULATOR_PRICERING_H
+#define OPTIONS_SIMULATOR_PRICERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Greeks.h"
+
+/* Priced results streamed through POSIX shared memory (shm_open, /dev/shm on linux):
+ *   [header: magic, layout version, capacity | head on its own line][slot 0]...[slot capacity - 1]
+ * one writer, any number of readers in any process on the host; no locks, no syscalls per record.
+ * record seq lives in slot seq % capacity, guarded by a per-slot seqlock: the slot's version is 2 seq + 1 while
+ * the writer fills it and 2 seq + 2 once complete, so a reader knows both that the copy was clean and that it
+ * is the record it asked for. the writer never waits: a reader more than capacity records behind loses the oldest
+ * ones and sees them counted in lost(). timestamps are steady_clock (CLOCK_MONOTONIC), comparable across processes */
+namespace PriceRing {
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t ALIGNMENT = 64;
+
+    struct Record {
+        uint64_t instrument;  // the publisher's id for the row (main.cpp: index in the batch snapshot)
+        uint64_t seq;         // position in the stream; gapless from 0
+        int64_t timestampNs;  // steady_clock at publish
+        double price;
+        // NaN when the publisher didn't compute greeks. PricingDispatcher::priceAndGreeksBatch units for every row:
+        // vega and rho per point (0.01), theta per calendar day
+        double delta, gamma, theta, vega, rho;
+    };
+    constexpr size_t RECORD_WORDS = sizeof(Record) / sizeof(uint64_t);
+    static_assert(sizeof(Record) % sizeof(uint64_t) == 0, "record is copied as 64 bit words");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "readers map the ring read-only");
+
+    // record payload is held as relaxed atomic words so the racy copy under the seqlock is well defined;
+    // on x86/arm64 these are plain loads and stores
+    struct alignas(ALIGNMENT) Slot {
+        std::atomic<uint64_t> version;
+        std::atomic<uint64_t> words[RECORD_WORDS];
+    };
+
+    struct alignas(ALIGNMENT) Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordBytes;
+        uint64_t capacity;  // power of two
+        alignas(ALIGNMENT) std::atomic<uint64_t> head; // next seq to be written; everything below is complete
+    };
+
+    size_t bytesFor(size_t capacity);
+    int64_t now(); // steady_clock nanoseconds, the clock Record::timestampNs uses
+}
+
+// single writer. creates (replacing any stale segment of the same name) and owns the segment; readers attached to
+// a replaced segment keep their old mapping and must reopen. throws std::runtime_error on shm/mmap failure
+class PricePublisher {
+public:
+    // name: "/options_prices" style (a leading '/' is added if missing); capacity rounded up to a power of two
+    explicit PricePublisher(const std::string& name, size_t capacity = 1 << 16, bool unlinkOnClose = true);
+    ~PricePublisher();
+    PricePublisher(const PricePublisher&) = delete;
+    PricePublisher& operator=(const PricePublisher&) = delete;
+
+    // returns the record's seq
+    uint64_t publish(uint64_t instrument, double price, const Greeks* greeks = nullptr, int64_t timestampNs = PriceRing::now());
+    // rows [0, count) of the columns as instruments firstInstrument + i, one timestamp for the whole batch;
+    // null greek columns publish NaN. returns the first row's seq
+    uint64_t publishBatch(const GreekColumns& columns, size_t count, uint64_t firstInstrument = 0);
+
+    const std::string& name() const { return name_; }
+    size_t capacity() const { return mask_ + 1; }
+    uint64_t published() const { return next_; }
+
+private:
+    void write(const PriceRing::Record& record);
+
+    std::string name_;
+    bool unlink_;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    PriceRing::Header* header_ = nullptr;
+    PriceRing::Slot* slots_ = nullptr;
+    size_t mask_ = 0;
+    uint64_t next_ = 0;
+};
+
+// one consumer's cursor over a publisher's segment, mapped read-only. not thread safe; one reader per thread.
+// throws std::runtime_error if the segment is missing or was written by an incompatible layout
+class PriceReader {
+public:
+    // fromOldest: start at the oldest record still in the ring instead of only what is published from now on
+    explicit PriceReader(const std::string& name, bool fromOldest = false);
+    ~PriceReader();
+    PriceReader(const PriceReader&) = delete;
+    PriceReader& operator=(const PriceReader&) = delete;
+
+    // next record in seq order; false once caught up with the writer. skips (and counts) overwritten records
+    bool next(PriceRing::Record& out);
+    // up to max records into out, returns how many
+    size_t poll(PriceRing::Record* out, size_t max);
+
+    uint64_t position() const { return next_; }   // seq the next call will try to read
+    uint64_t available() const;                   // published but not yet read (may exceed capacity)
+    uint64_t lost() const { return lost_; }       // records overwritten before this reader got to them
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    const PriceRing::Header* header_ = nullptr;
+    const PriceRing::Slot* slots_ = nullptr;
+    size_t mask_ = 0;
+    uint64_t next_ = 0;
+    uint64_t lost_ = 0;
+};
+
+#endif //OPTIONS_SIMULATOR_PRICERING_H
@@ -0,0 +1,98 @@
+#ifndef OPTIONS_SIMULATOR_SOBOL_H
+#define OPTIONS_SIMULATOR_SOBOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "Philox.h"
+
+// Sobol low discrepancy sequence, 32 bit, up to MAX_DIMS dimensions.
+// dimension 0 is van der Corput; the rest use primitive polynomials + initial direction numbers from
+// Joe & Kuo ("Constructing Sobol sequences with better two-dimensional projections", 2008).
+// a random digital shift (xor per dimension, from Philox) keeps point 0 off the origin and lets different seeds
+// give independent randomized replications.
+class Sobol {
+public:
+    static constexpr int MAX_DIMS = 21;
+    static constexpr int BITS = 32;
+
+    explicit Sobol(int dims, uint64_t seed = 0) : dims_(dims), v_(static_cast<size_t>(dims) * BITS), shift_(dims, 0u) {
+        if (dims < 1 || dims > MAX_DIMS) throw std::invalid_argument("Sobol dimension out of range");
+        // {degree s, polynomial coefficients a (without leading/trailing 1), m_1..m_s}
+        struct Entry { int s; uint32_t a; uint32_t m[7]; };
+        static constexpr Entry TABLE[MAX_DIMS - 1] = {
+            {1, 0,  {1}},
+            {2, 1,  {1, 3}},
+            {3, 1,  {1, 3, 1}},
+            {3, 2,  {1, 1, 1}},
+            {4, 1,  {1, 1, 3, 3}},
+            {4, 4,  {1, 3, 5, 13}},
+            {5, 2,  {1, 1, 5, 5, 17}},
+            {5, 4,  {1, 1, 5, 5, 5}},
+            {5, 7,  {1, 1, 7, 11, 19}},
+            {5, 11, {1, 1, 5, 1, 1}},
+            {5, 13, {1, 1, 1, 3, 11}},
+            {5, 14, {1, 3, 5, 5, 31}},
+            {6, 1,  {1, 3, 3, 9, 7, 49}},
+            {6, 13, {1, 1, 1, 15, 21, 21}},
+            {6, 16, {1, 3, 1, 13, 27, 49}},
+            {6, 19, {1, 1, 1, 15, 7, 5}},
+            {6, 22, {1, 3, 1, 15, 13, 25}},
+            {6, 25, {1, 1, 5, 5, 19, 61}},
+            {7, 1,  {1, 3, 7, 11, 23, 15, 103}},
+            {7, 4,  {1, 3, 7, 13, 13, 15, 69}},
+        };
+        for (int k = 0; k < BITS; ++k) v_[k] = 1u << (BITS - 1 - k);
+        for (int d = 1; d < dims; ++d) {
+            const Entry& e = TABLE[d - 1];
+            uint32_t* v = &v_[static_cast<size_t>(d) * BITS];
+            for (int k = 0; k < e.s; ++k) v[k] = e.m[k] << (BITS - 1 - k);
+            for (int k = e.s; k < BITS; ++k) {
+                v[k] = v[k - e.s] ^ (v[k - e.s] >> e.s);
+                for (int j = 1; j < e.s; ++j)
+                    if ((e.a >> (e.s - 1 - j)) & 1u) v[k] ^= v[k - j];
+            }
+        }
+        if (seed != 0) {
+            for (int d = 0; d < dims; ++d) {
+                uint32_t c[4] = {static_cast<uint32_t>(d), 0x50B01u, 0u, 0u};
+                Philox::block(c, seed);
+                shift_[d] = c[0];
+            }
+        }
+    }
+
+    int dims() const { return dims_; }
+
+    // raw 32 bit point `index` (gray code order) written to out[0..dims)
+    void point(uint32_t index, uint32_t* out) const {
+        uint32_t gray = index ^ (index >> 1);
+        for (int d = 0; d < dims_; ++d) {
+            const uint32_t* v = &v_[static_cast<size_t>(d) * BITS];
+            uint32_t x = shift_[d];
+            for (int k = 0; k < BITS && (gray >> k); ++k) // bound first: a 32 bit shift of gray is UB
+                if ((gray >> k) & 1u) x ^= v[k];
+            out[d] = x;
+        }
+    }
+
+    // moves a point from `index` to `index + 1` (one xor per dimension)
+    void next(uint32_t index, uint32_t* x) const {
+        int k = 0;
+        while (k < BITS - 1 && ((index >> k) & 1u)) ++k; // lowest zero bit of index = bit that flips in the gray code
+        for (int d = 0; d < dims_; ++d) x[d] ^= v_[static_cast<size_t>(d) * BITS + k];
+    }
+
+    // midpoint of the 2^-32 cell, so never exactly 0 or 1
+    static double toUniform(uint32_t x) {
+        return (static_cast<double>(x) + 0.5) * (1.0 / 4294967296.0);
+    }
+
+private:
+    int dims_;
+    std::vector<uint32_t> v_;     // [dim][bit] direction numbers
+    std::vector<uint32_t> shift_; // digital shift per dim
+};
+
+#endif //OPTIONS_SIMULATOR_SOBOL_H
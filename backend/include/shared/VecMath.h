@@ -0,0 +1,128 @@
+#ifndef OPTIONS_SIMULATOR_VECMATH_H
+#define OPTIONS_SIMULATOR_VECMATH_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// precision-overloaded math for the templated kernels.
+// double forwards to <cmath>; float uses branch-free Cephes-style polynomials that vectorize under
+// `#pragma omp simd` (libm's expf/logf/erfcf are opaque calls and keep float loops scalar)
+namespace VecMath {
+
+    inline double exp(double x) noexcept { return std::exp(x); }
+    inline double log(double x) noexcept { return std::log(x); }
+    inline double sqrt(double x) noexcept { return std::sqrt(x); }
+    inline double erfc(double x) noexcept { return std::erfc(x); }
+    inline double pow(double x, double y) noexcept { return std::pow(x, y); }
+
+    // memcpy through a stack slot defeats the vectorizer; the builtin lowers to a register move
+    inline float bitsToFloat(int32_t bits) noexcept {
+#if defined(__GNUC__)
+        return __builtin_bit_cast(float, bits);
+#else
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+#endif
+    }
+
+    inline int32_t floatToBits(float f) noexcept {
+#if defined(__GNUC__)
+        return __builtin_bit_cast(int32_t, f);
+#else
+        int32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        return bits;
+#endif
+    }
+
+    inline double bitsToDouble(int64_t bits) noexcept {
+#if defined(__GNUC__)
+        return __builtin_bit_cast(double, bits);
+#else
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+#endif
+    }
+
+    // double exp that vectorizes: std::exp stays an opaque libm call w/o -ffast-math, which keeps monte carlo
+    // loops scalar. Cephes Pade form, ~1 ulp on [-708, 709]. exp(double) above is left as is so existing
+    // double results don't move
+    inline double expSimd(double x) noexcept {
+        x = x < -708.0 ? -708.0 : (x > 709.0 ? 709.0 : x);
+        double n = static_cast<double>(static_cast<int32_t>(x * 1.4426950408889634 + 1024.5)) - 1024.0;
+        double r = x - n * 6.93145751953125e-1 - n * 1.42860682030941723212e-6;
+        double z = r * r;
+        double p = ((1.26177193074810590878e-4 * z + 3.02994407707441961300e-2) * z + 9.99999999999999999910e-1) * r;
+        double q = ((3.00198505138664455042e-6 * z + 2.52448340349684104192e-3) * z + 2.27265548208155028766e-1) * z
+                   + 2.00000000000000000009e0;
+        double e = 1.0 + 2.0 * p / (q - p);
+        return e * bitsToDouble((static_cast<int64_t>(n) + 1023) << 52);
+    }
+
+    // ~1 ulp on [-87, 88]; range reduction x = n*ln2 + r, then 2^n through the exponent bits
+    inline float exp(float x) noexcept {
+        x = x < -87.3f ? -87.3f : (x > 88.3f ? 88.3f : x);
+        // floor via truncation of a value shifted positive; floorf itself won't vectorize w/o -ffast-math
+        float n = static_cast<float>(static_cast<int32_t>(x * 1.44269504088896341f + 128.5f)) - 128.0f;
+        float r = x - n * 0.693359375f + n * 2.12194440e-4f;
+        float z = r * r;
+        float p = 1.9875691500e-4f;
+        p = p * r + 1.3981999507e-3f;
+        p = p * r + 8.3334519073e-3f;
+        p = p * r + 4.1665795894e-2f;
+        p = p * r + 1.6666665459e-1f;
+        p = p * r + 5.0000001201e-1f;
+        p = p * z + r + 1.0f;
+        return p * bitsToFloat((static_cast<int32_t>(n) + 127) << 23);
+    }
+
+    // positive normal inputs only; mantissa/exponent split through the bits instead of frexpf
+    inline float log(float x) noexcept {
+        int32_t bits = floatToBits(x);
+        float e = static_cast<float>(((bits >> 23) & 0xff) - 126);
+        float m = bitsToFloat((bits & 0x007fffff) | 0x3f000000); // [0.5, 1)
+        bool small = m < 0.707106781186547524f;
+        e = small ? e - 1.0f : e;
+        m = small ? m + m - 1.0f : m - 1.0f;
+        float z = m * m;
+        float y = 7.0376836292e-2f;
+        y = y * m - 1.1514610310e-1f;
+        y = y * m + 1.1676998740e-1f;
+        y = y * m - 1.2420140846e-1f;
+        y = y * m + 1.4249322787e-1f;
+        y = y * m - 1.6668057665e-1f;
+        y = y * m + 2.0000714765e-1f;
+        y = y * m - 2.4999993993e-1f;
+        y = y * m + 3.3333331174e-1f;
+        y = y * m * z;
+        y += -2.12194440e-4f * e;
+        y += -0.5f * z;
+        return m + y + 0.693359375f * e;
+    }
+
+    inline float sqrt(float x) noexcept { return std::sqrt(x); } // maps to sqrtps already
+
+    inline float pow(float x, float y) noexcept { return VecMath::exp(y * VecMath::log(x)); } // x > 0
+
+    // Numerical Recipes erfcc: fractional error < 1.2e-7 everywhere
+    inline float erfc(float x) noexcept {
+        float z = std::fabs(x);
+        float t = 1.0f / (1.0f + 0.5f * z);
+        float p = 0.17087277f;
+        p = p * t - 0.82215223f;
+        p = p * t + 1.48851587f;
+        p = p * t - 1.13520398f;
+        p = p * t + 0.27886807f;
+        p = p * t - 0.18628806f;
+        p = p * t + 0.09678418f;
+        p = p * t + 0.37409196f;
+        p = p * t + 1.00002368f;
+        float ans = t * VecMath::exp(-z * z - 1.26551223f + t * p);
+        return x >= 0.0f ? ans : 2.0f - ans;
+    }
+}
+
+#endif //OPTIONS_SIMULATOR_VECMATH_H
@@ -1,10 +1,12 @@
 #include <boost/asio.hpp>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include "legacy/MarketDataFeed.h"
 #include "shared/OptionBatch.h"
 #include "pricing/PricingDispatcher.h"
 #include "shared/BenchmarkUtils.h"
+#include "shared/PerfCounters.h"
 
 int main() {
     constexpr size_t NUM_EUROPEAN = 500000;
@@ -29,6 +31,16 @@ int main() {
     std::mt19937 gen(rd());
     std::normal_distribution<> noise(0.0, 0.01);
 
+    // PERF_COUNTERS=1: hardware counters around each tick's pricing call
+    std::unique_ptr<PerfCounters> counters;
+    if (PerfCounters::enabledFromEnv()) {
+        counters = std::make_unique<PerfCounters>();
+        if (!counters->available()) std::cerr << "perf counters unavailable: " << counters->error() << std::endl;
+    }
+
+    // result buffer reused every tick; the pricing call itself allocates nothing once warm
+    std::vector<double> prices(batch.size());
+
     // define call back per tick
     auto onTick = [&]() {
         for (size_t i = 0; i < batch.size(); ++i) {
@@ -36,8 +48,10 @@ int main() {
             batch.sigma[i] = std::max(0.01, batch.sigma[i] + 0.01 * noise(gen));
             batch.T[i] = std::max(1e-6, batch.T[i] - dt);
         }
-        auto prices = PricingDispatcher::priceBatch(batch, 1000);
+        if (counters) counters->start();
+        PricingDispatcher::priceBatch(batch.view(), prices.data(), 1000);
         std::cout << "Tick: " << prices[0] << " ... " << prices[prices.size() - 1] << std::endl;
+        if (counters) std::cout << "  " << counters->stop().summary(batch.size()) << std::endl;
     };
 
     // start market feed
@@ -136,6 +136,8 @@ void DataManager::update_from_json(const std::string& raw_json) {
                 // update live strick price
                 batch_.S[idx] = spot; 
                 batch_.sigma[idx] = iv / 100.0;
+                // underlying_price is the future for this expiry, so it doubles as the smile's forward
+                surface_.setQuote(batch_.T[idx], spot, batch_.K[idx], iv / 100.0);
                 std::cout<< "Updated Option [" << instrument << "] at index " << idx << "\n";
             }
         }
@@ -148,4 +150,16 @@ void DataManager::update_from_json(const std::string& raw_json) {
 OptionBatch DataManager::get_batch_snapshot() {
     std::lock_guard<std::mutex> lock(data_mutex_);
     return batch_; // for atomic copy
-}
\ No newline at end of file
+}
+void DataManager::get_batch_snapshot(OptionBatch& out) {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    out = batch_;
+}
+OptionBatch DataManager::get_smoothed_snapshot() {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    OptionBatch snapshot = batch_;
+    if (surface_.expiries() == 0) return snapshot; // nothing quoted yet
+    surface_.calibrate();
+    surface_.fillSigma(snapshot);
+    return snapshot;
+}
@@ -0,0 +1,54 @@
+#include "api/PricingClient.h"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+PricingClient::PricingClient(const std::string& host, uint16_t port) : socket_(ioc_) {
+    net::ip::tcp::endpoint endpoint(net::ip::make_address(host), port);
+    socket_.connect(endpoint);
+    socket_.set_option(net::ip::tcp::no_delay(true));
+}
+
+PricingClient::PricingClient(const std::string& unixPath) : socket_(ioc_) {
+    socket_.connect(net::local::stream_protocol::endpoint(unixPath));
+}
+
+uint64_t PricingClient::send(const OptionBatchView& batch, bool greeks, PricingWire::Model model, uint32_t steps) {
+    const uint32_t count = static_cast<uint32_t>(batch.size());
+    const uint8_t flags = PricingWire::COLUMNAR | (greeks ? PricingWire::WANT_GREEKS : 0);
+    PricingWire::RequestHeader header{PricingWire::REQUEST_MAGIC, PricingWire::VERSION, static_cast<uint8_t>(model),
+                                      flags, next_id_++, count, steps};
+    //the view's columns go out as they are; type/style lane masks shrink to one byte each
+    body_.assign(PricingWire::columnarBytes(count) / sizeof(double), 0.0);
+    const double* columns[6] = {batch.S, batch.K, batch.r, batch.sigma, batch.T, batch.q};
+    for (size_t c = 0; c < 6; ++c) std::copy(columns[c], columns[c] + count, body_.data() + c * count);
+    auto* types = reinterpret_cast<uint8_t*>(body_.data() + 6 * static_cast<size_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        types[i] = static_cast<uint8_t>(batch.type[i]);
+        types[count + i] = static_cast<uint8_t>(batch.style[i]);
+    }
+    std::array<net::const_buffer, 2> buffers{net::buffer(&header, sizeof(header)), net::buffer(body_)};
+    net::write(socket_, buffers);
+    return header.id;
+}
+
+PricingWire::ResponseHeader PricingClient::receive(std::vector<double>& out) {
+    PricingWire::ResponseHeader header{};
+    net::read(socket_, net::buffer(&header, sizeof(header)));
+    if (header.magic != PricingWire::RESPONSE_MAGIC) throw std::runtime_error("Pricing server sent a bad frame");
+    out.resize(static_cast<size_t>(header.count) * header.columns);
+    net::read(socket_, net::buffer(out));
+    return header;
+}
+
+void PricingClient::price(const OptionBatchView& batch, double* out, PricingWire::Model model, uint32_t steps) {
+    send(batch, false, model, steps);
+    PricingWire::ResponseHeader header = receive(scratch_);
+    if (header.status != static_cast<uint16_t>(PricingWire::Status::Ok))
+        throw std::runtime_error("Pricing server refused the request (status " + std::to_string(header.status) + ")");
+    std::copy(scratch_.begin(), scratch_.end(), out);
+}
@@ -0,0 +1,339 @@
+#include "api/PricingCoordinator.h"
+#include "pricing/PricingDispatcher.h"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+using generic_socket = net::generic::stream_protocol::socket;
+
+struct CoordinatorWorker {
+    WorkerEndpoint endpoint;
+    generic_socket socket;
+    net::steady_timer timer;
+    net::ip::tcp::resolver resolver;
+    std::vector<net::ip::tcp::endpoint> addresses; // resolved, tried in order
+    bool connected = false, connecting = false, writing = false, reading = false;
+    unsigned generation = 0;            // bumped on failure; handlers from an older connection are ignored
+    std::deque<size_t> outstanding;     // shard ids sent, answered in this order
+
+    PricingWire::RequestHeader request{};
+    std::vector<double> body;           // COLUMNAR request body
+    PricingWire::ResponseHeader response{};
+    std::vector<double> result;
+
+    CoordinatorWorker(net::io_context& ioc, WorkerEndpoint endpoint_)
+        : endpoint(std::move(endpoint_)), socket(ioc), timer(ioc), resolver(ioc) {}
+};
+
+WorkerEndpoint WorkerEndpoint::parse(const std::string& text) {
+    WorkerEndpoint endpoint;
+    if (text.rfind("unix:", 0) == 0) {
+        endpoint.unixPath = text.substr(5);
+        if (endpoint.unixPath.empty()) throw std::invalid_argument("Empty unix socket path in " + text);
+        return endpoint;
+    }
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == text.size())
+        throw std::invalid_argument("Worker must be host:port or unix:/path, got " + text);
+    endpoint.host = text.substr(0, colon);
+    int port = std::stoi(text.substr(colon + 1));
+    if (port <= 0 || port > 65535) throw std::invalid_argument("Bad worker port in " + text);
+    endpoint.port = static_cast<uint16_t>(port);
+    return endpoint;
+}
+
+std::string WorkerEndpoint::name() const {
+    return unixPath.empty() ? host + ":" + std::to_string(port) : "unix:" + unixPath;
+}
+
+PricingCoordinator::PricingCoordinator(std::vector<WorkerEndpoint> workers, CoordinatorConfig config)
+    : config_(config) {
+    if (config_.shardRows == 0 || config_.pipeline == 0) throw std::invalid_argument("shardRows and pipeline must be > 0");
+    for (WorkerEndpoint& endpoint : workers) workers_.push_back(std::make_unique<CoordinatorWorker>(ioc_, std::move(endpoint)));
+}
+
+PricingCoordinator::~PricingCoordinator() = default;
+
+size_t PricingCoordinator::liveWorkers() const {
+    return static_cast<size_t>(std::count_if(workers_.begin(), workers_.end(), [](const auto& w) { return w->connected; }));
+}
+
+void PricingCoordinator::price(const OptionBatchView& batch, double* out, const int* shardKeys) {
+    run(batch, GreekColumns{out}, false, shardKeys);
+}
+
+void PricingCoordinator::priceAndGreeks(const OptionBatchView& batch, const GreekColumns& out, const int* shardKeys) {
+    run(batch, out, true, shardKeys);
+}
+
+//row ranges, or keyed rows grouped (counting sort, stable) and packed whole into shards of about shardRows;
+//a group bigger than shardRows becomes one shard on its own
+void PricingCoordinator::makeShards(size_t n, const int* shardKeys) {
+    shards_.clear();
+    order_.clear();
+    if (!shardKeys) {
+        for (size_t begin = 0; begin < n; begin += config_.shardRows)
+            shards_.push_back({begin, std::min(n, begin + config_.shardRows)});
+        return;
+    }
+    int groups = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (shardKeys[i] < 0) throw std::invalid_argument("Shard keys must be >= 0");
+        groups = std::max(groups, shardKeys[i] + 1);
+    }
+    std::vector<size_t> start(static_cast<size_t>(groups) + 1, 0);
+    for (size_t i = 0; i < n; ++i) ++start[shardKeys[i] + 1];
+    for (int g = 0; g < groups; ++g) start[g + 1] += start[g];
+    order_.resize(n);
+    std::vector<size_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < n; ++i) order_[fill[shardKeys[i]]++] = i;
+
+    size_t begin = 0;
+    for (int g = 0; g < groups; ++g) {
+        if (start[g] > begin && start[g + 1] - begin > config_.shardRows) {
+            shards_.push_back({begin, start[g]});
+            begin = start[g];
+        }
+    }
+    if (begin < n) shards_.push_back({begin, n});
+}
+
+void PricingCoordinator::run(const OptionBatchView& batch, const GreekColumns& out, bool greeks, const int* shardKeys) {
+    if (greeks && !(out.price && out.delta && out.gamma && out.theta && out.vega && out.rho))
+        throw std::invalid_argument("priceAndGreeks needs every output column");
+    batch_ = batch;
+    out_ = out;
+    greeks_ = greeks;
+    makeShards(batch.size(), shardKeys);
+    pending_.assign(shards_.size(), 0);
+    for (size_t s = 0; s < shards_.size(); ++s) pending_[s] = s;
+    completed_ = 0;
+    stats_.shards += shards_.size();
+    if (shards_.empty()) return;
+
+    //workers dropped last call get another chance; live connections are reused
+    ioc_.restart();
+    for (auto& worker : workers_) {
+        if (worker->connected) pump(*worker);
+        else if (!worker->connecting) connect(*worker);
+    }
+    ioc_.run();
+
+    if (completed_ < shards_.size()) {
+        if (!config_.localFallback) throw std::runtime_error("No live pricing worker left for " +
+                                                             std::to_string(shards_.size() - completed_) + " shards");
+        priceLocally();
+    }
+}
+
+void PricingCoordinator::connect(CoordinatorWorker& worker) {
+    worker.connecting = true;
+    arm_timer(worker, config_.connectTimeout); // covers the lookup and every address tried
+    if (!worker.endpoint.unixPath.empty()) {
+        unsigned generation = worker.generation;
+        worker.socket.async_connect(net::local::stream_protocol::endpoint(worker.endpoint.unixPath),
+                                    [this, &worker, generation](boost::system::error_code ec) {
+            if (generation != worker.generation) return;
+            if (ec) return fail(worker);
+            on_connect(worker);
+        });
+        return;
+    }
+    //names go through the resolver on the io thread, so "risk-node-3:7878" works as well as a literal address
+    unsigned generation = worker.generation;
+    worker.resolver.async_resolve(worker.endpoint.host, std::to_string(worker.endpoint.port),
+                                  [this, &worker, generation](boost::system::error_code ec,
+                                                              net::ip::tcp::resolver::results_type results) {
+        if (generation != worker.generation) return;
+        if (ec || results.empty()) return fail(worker);
+        worker.addresses.clear();
+        for (const auto& entry : results) worker.addresses.push_back(entry.endpoint());
+        connect_address(worker, 0);
+    });
+}
+
+void PricingCoordinator::connect_address(CoordinatorWorker& worker, size_t index) {
+    if (index >= worker.addresses.size()) return fail(worker);
+    unsigned generation = worker.generation;
+    worker.socket.async_connect(worker.addresses[index], [this, &worker, generation, index](boost::system::error_code ec) {
+        if (generation != worker.generation) return;
+        if (ec) {
+            boost::system::error_code ignored;
+            worker.socket.close(ignored); // a failed connect leaves the socket open for the next address
+            return connect_address(worker, index + 1);
+        }
+        boost::system::error_code ignored;
+        worker.socket.set_option(net::ip::tcp::no_delay(true), ignored);
+        on_connect(worker);
+    });
+}
+
+void PricingCoordinator::on_connect(CoordinatorWorker& worker) {
+    worker.connecting = false;
+    worker.timer.cancel();
+    worker.connected = true;
+    pump(worker);
+}
+
+//keeps up to pipeline shards outstanding on the connection; writes go one at a time
+void PricingCoordinator::pump(CoordinatorWorker& worker) {
+    if (!worker.connected || worker.writing || pending_.empty() || worker.outstanding.size() >= config_.pipeline) return;
+    size_t id = pending_.front();
+    pending_.pop_front();
+    worker.outstanding.push_back(id);
+
+    const Shard& shard = shards_[id];
+    const size_t count = shard.end - shard.begin;
+    const uint8_t flags = PricingWire::COLUMNAR | (greeks_ ? PricingWire::WANT_GREEKS : 0);
+    worker.request = {PricingWire::REQUEST_MAGIC, PricingWire::VERSION, static_cast<uint8_t>(config_.model), flags, id,
+                      static_cast<uint32_t>(count), config_.steps};
+    //the shard's rows gathered into column slices (contiguous copies for plain row ranges)
+    worker.body.assign(PricingWire::columnarBytes(static_cast<uint32_t>(count)) / sizeof(double), 0.0);
+    double* body = worker.body.data();
+    const double* columns[6] = {batch_.S, batch_.K, batch_.r, batch_.sigma, batch_.T, batch_.q};
+    auto* flagBytes = reinterpret_cast<uint8_t*>(body + 6 * count);
+    if (order_.empty()) {
+        for (size_t c = 0; c < 6; ++c)
+            std::copy(columns[c] + shard.begin, columns[c] + shard.end, body + c * count);
+    } else {
+        for (size_t c = 0; c < 6; ++c)
+            for (size_t i = 0; i < count; ++i) body[c * count + i] = columns[c][order_[shard.begin + i]];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        size_t r = row(shard.begin + i);
+        flagBytes[i] = static_cast<uint8_t>(batch_.type[r]);
+        flagBytes[count + i] = static_cast<uint8_t>(batch_.style[r]);
+    }
+
+    //the clock starts with the write: a stalled worker stops draining its socket, so the write itself can hang
+    if (!worker.reading) arm_timer(worker, config_.shardTimeout);
+    worker.writing = true;
+    unsigned generation = worker.generation;
+    std::array<net::const_buffer, 2> buffers{net::buffer(&worker.request, sizeof(worker.request)), net::buffer(worker.body)};
+    net::async_write(worker.socket, buffers, [this, &worker, generation](boost::system::error_code ec, size_t) {
+        if (generation != worker.generation) return;
+        worker.writing = false;
+        if (ec) return fail(worker);
+        if (!worker.reading) do_read(worker);
+        pump(worker);
+    });
+}
+
+void PricingCoordinator::do_read(CoordinatorWorker& worker) {
+    worker.reading = true;
+    unsigned generation = worker.generation;
+    net::async_read(worker.socket, net::buffer(&worker.response, sizeof(worker.response)),
+                    [this, &worker, generation](boost::system::error_code ec, size_t) {
+        if (generation != worker.generation) return;
+        const PricingWire::ResponseHeader& h = worker.response;
+        const Shard& shard = shards_[worker.outstanding.front()];
+        //anything but the expected answer to the oldest outstanding shard means the worker can't be trusted
+        if (ec || h.magic != PricingWire::RESPONSE_MAGIC || h.status != static_cast<uint16_t>(PricingWire::Status::Ok) ||
+            h.id != worker.outstanding.front() || h.count != shard.end - shard.begin || h.columns != (greeks_ ? 6u : 1u))
+            return fail(worker);
+        worker.result.resize(static_cast<size_t>(h.count) * h.columns);
+        net::async_read(worker.socket, net::buffer(worker.result), [this, &worker, generation](boost::system::error_code ec, size_t) {
+            if (generation != worker.generation) return;
+            if (ec) return fail(worker);
+            on_response(worker);
+        });
+    });
+}
+
+void PricingCoordinator::on_response(CoordinatorWorker& worker) {
+    const Shard& shard = shards_[worker.outstanding.front()];
+    const size_t count = shard.end - shard.begin;
+    const double* result = worker.result.data();
+    if (greeks_) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t r = row(shard.begin + i);
+            const double* cell = result + 6 * i;
+            out_.price[r] = cell[0];
+            out_.delta[r] = cell[1];
+            out_.gamma[r] = cell[2];
+            out_.theta[r] = cell[3];
+            out_.vega[r] = cell[4];
+            out_.rho[r] = cell[5];
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) out_.price[row(shard.begin + i)] = result[i];
+    }
+    worker.outstanding.pop_front();
+    //done: don't wait on connects still in flight, their handlers run on the next call
+    if (++completed_ == shards_.size()) ioc_.stop();
+
+    if (worker.outstanding.empty()) {
+        worker.reading = false;
+        worker.timer.cancel();
+    } else {
+        arm_timer(worker, config_.shardTimeout); // the next shard gets its own full timeout
+        do_read(worker);
+    }
+    pump(worker);
+}
+
+void PricingCoordinator::arm_timer(CoordinatorWorker& worker, std::chrono::milliseconds timeout) {
+    unsigned generation = worker.generation;
+    worker.timer.expires_after(timeout);
+    worker.timer.async_wait([this, &worker, generation](boost::system::error_code ec) {
+        if (ec == net::error::operation_aborted || generation != worker.generation) return;
+        fail(worker); // hung or too slow: what it holds goes to someone else
+    });
+}
+
+//drops the connection and puts its unanswered shards back at the front of the queue for the live workers
+void PricingCoordinator::fail(CoordinatorWorker& worker) {
+    ++worker.generation;
+    ++stats_.workerFailures;
+    boost::system::error_code ignored;
+    worker.socket.close(ignored);
+    worker.timer.cancel();
+    worker.resolver.cancel();
+    worker.connected = worker.connecting = worker.writing = worker.reading = false;
+    stats_.reassigned += worker.outstanding.size();
+    for (auto it = worker.outstanding.rbegin(); it != worker.outstanding.rend(); ++it) pending_.push_front(*it);
+    worker.outstanding.clear();
+    for (auto& other : workers_) pump(*other);
+}
+
+//whatever is still pending once every worker is gone, through the same dispatcher calls a worker would make
+void PricingCoordinator::priceLocally() {
+    size_t n = 0;
+    for (size_t id : pending_) n += shards_[id].end - shards_[id].begin;
+    OptionBatch local(n);
+    size_t at = 0;
+    for (size_t id : pending_)
+        for (size_t i = shards_[id].begin; i < shards_[id].end; ++i, ++at) {
+            size_t r = row(i);
+            local.set(at, Option(batch_.S[r], batch_.K[r], batch_.r[r], batch_.sigma[r], batch_.T[r], batch_.q[r],
+                                 batch_.type[r], batch_.style[r]));
+        }
+    const int steps = config_.steps ? static_cast<int>(config_.steps) : 1000;
+    const size_t columns = greeks_ ? 6 : 1;
+    std::vector<double> results[6];
+    for (size_t c = 0; c < columns; ++c) results[c].resize(n);
+    if (config_.model == PricingWire::Model::Binomial)
+        PricingDispatcher::priceBatchBinomial(local.view(), results[0].data(), steps);
+    else
+        PricingDispatcher::priceBatch(local.view(), results[0].data(), steps);
+    if (greeks_)
+        PricingDispatcher::priceAndGreeksBatch(local.view(), GreekColumns{nullptr, results[1].data(), results[2].data(),
+                                                                          results[3].data(), results[4].data(), results[5].data()},
+                                               steps);
+
+    double* targets[6] = {out_.price, out_.delta, out_.gamma, out_.theta, out_.vega, out_.rho};
+    at = 0;
+    for (size_t id : pending_)
+        for (size_t i = shards_[id].begin; i < shards_[id].end; ++i, ++at)
+            for (size_t c = 0; c < columns; ++c) targets[c][row(i)] = results[c][at];
+    completed_ += pending_.size();
+    stats_.localRows += n;
+    pending_.clear();
+}
@@ -0,0 +1,409 @@
+#include "api/PricingServer.h"
+#include "pricing/PricingDispatcher.h"
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <array>
+#include <unistd.h>
+
+using tcp = net::ip::tcp;
+using unix_socket = net::local::stream_protocol;
+
+struct PricingRequest {
+    PricingWire::RequestHeader header{};
+    std::vector<PricingWire::Row> rows;       // row body
+    std::vector<double> columns;              // COLUMNAR body (columnarBytes, as doubles for alignment)
+    PricingWire::ResponseHeader response{};
+    std::vector<double> out;                  // count x columns, row-major
+    std::shared_ptr<PricingConnection> owner; // keeps the session alive while the request is being priced
+    bool done = false;
+    bool closeAfter = false;
+};
+
+namespace {
+    bool columnar(const PricingWire::RequestHeader& h) {
+        return h.flags & PricingWire::COLUMNAR;
+    }
+
+    // type and style bytes of a COLUMNAR body
+    const uint8_t* columnarFlags(const PricingRequest& request) {
+        return reinterpret_cast<const uint8_t*>(request.columns.data() + 6 * static_cast<size_t>(request.header.count));
+    }
+
+    bool validRows(const PricingRequest& request) {
+        const PricingWire::RequestHeader& h = request.header;
+        if (h.model > static_cast<uint8_t>(PricingWire::Model::Binomial)) return false;
+        if (h.flags & ~(PricingWire::WANT_GREEKS | PricingWire::COLUMNAR)) return false;
+        if (h.steps > PricingWire::MAX_STEPS) return false;
+        for (const PricingWire::Row& row : request.rows)
+            if (row.type > 1 || row.style > 1) return false;
+        if (columnar(h)) {
+            const uint8_t* flags = columnarFlags(request);
+            for (size_t i = 0; i < 2 * static_cast<size_t>(h.count); ++i)
+                if (flags[i] > 1) return false;
+        }
+        return true;
+    }
+
+    //requests priced by the same call: same model, greeks or not, same steps
+    bool sameGroup(const PricingWire::RequestHeader& a, const PricingWire::RequestHeader& b) {
+        return a.model == b.model && (a.flags & PricingWire::WANT_GREEKS) == (b.flags & PricingWire::WANT_GREEKS) &&
+               a.steps == b.steps;
+    }
+
+    //one client connection. reads are header then body; every request joins in_flight_ in arrival order and the
+    //front is written back as soon as it is priced, so pipelined responses keep request order
+    template<typename Protocol>
+    class PricingSession : public PricingConnection {
+        typename Protocol::socket socket_;
+        PricingServer& server_;
+        PricingWire::RequestHeader header_{};
+        std::deque<std::shared_ptr<PricingRequest>> in_flight_;
+        bool reading_ = false, writing_ = false, blocked_ = false, closed_ = false;
+
+    public:
+        PricingSession(typename Protocol::socket socket, PricingServer& server)
+            : socket_(std::move(socket)), server_(server) {}
+
+        void start() { maybe_read(); }
+
+        void on_priced(const std::shared_ptr<PricingRequest>& request) override {
+            request->done = true;
+            do_write();
+        }
+
+        //the shared queue drained below maxQueuedRows
+        void resume() override {
+            blocked_ = false;
+            maybe_read();
+        }
+
+        void close() override {
+            if (closed_) return;
+            closed_ = true;
+            boost::system::error_code ignored;
+            socket_.close(ignored);
+            in_flight_.clear(); // drops the request -> session references
+        }
+
+    private:
+        std::shared_ptr<PricingSession> self() { return std::static_pointer_cast<PricingSession>(shared_from_this()); }
+
+        void maybe_read() {
+            if (reading_ || blocked_ || closed_ || in_flight_.size() >= server_.config().maxInFlight) return;
+            reading_ = true;
+            net::async_read(socket_, net::buffer(&header_, sizeof(header_)),
+                            [self = self()](boost::system::error_code ec, size_t) { self->on_header(ec); });
+        }
+
+        void on_header(boost::system::error_code ec) {
+            if (ec) return close();
+            auto request = std::make_shared<PricingRequest>();
+            request->header = header_;
+            request->owner = shared_from_this();
+            request->response = {PricingWire::RESPONSE_MAGIC, PricingWire::VERSION,
+                                 static_cast<uint16_t>(PricingWire::Status::Ok), header_.id, 0, 0};
+            //after a bad frame or an oversized count the stream can't be resynchronised: reply, then close
+            if (header_.magic != PricingWire::REQUEST_MAGIC || header_.version != PricingWire::VERSION)
+                return reject(request, PricingWire::Status::BadFrame, true);
+            if (header_.count > server_.config().maxRequestRows)
+                return reject(request, PricingWire::Status::TooLarge, true);
+
+            net::mutable_buffer body;
+            if (columnar(header_)) {
+                request->columns.resize(PricingWire::columnarBytes(header_.count) / sizeof(double));
+                body = net::buffer(request->columns);
+            } else {
+                request->rows.resize(header_.count);
+                body = net::buffer(request->rows);
+            }
+            net::async_read(socket_, body,
+                            [self = self(), request](boost::system::error_code ec, size_t) { self->on_body(ec, request); });
+        }
+
+        void on_body(boost::system::error_code ec, const std::shared_ptr<PricingRequest>& request) {
+            reading_ = false;
+            if (ec) return close();
+            if (!validRows(*request)) return reject(request, PricingWire::Status::BadRequest, false);
+
+            in_flight_.push_back(request);
+            if (!server_.submit(request)) {
+                blocked_ = true;
+                server_.pause(shared_from_this());
+            }
+            maybe_read();
+        }
+
+        void reject(const std::shared_ptr<PricingRequest>& request, PricingWire::Status status, bool closeAfter) {
+            reading_ = false;
+            request->response.status = static_cast<uint16_t>(status);
+            request->closeAfter = closeAfter;
+            request->done = true;
+            in_flight_.push_back(request);
+            do_write();
+            if (!closeAfter) maybe_read();
+        }
+
+        void do_write() {
+            if (writing_ || closed_ || in_flight_.empty() || !in_flight_.front()->done) return;
+            writing_ = true;
+            std::shared_ptr<PricingRequest> request = in_flight_.front();
+            std::array<net::const_buffer, 2> buffers{net::buffer(&request->response, sizeof(request->response)),
+                                                     net::buffer(request->out)};
+            net::async_write(socket_, buffers, [self = self(), request](boost::system::error_code ec, size_t) {
+                self->on_write(ec, request);
+            });
+        }
+
+        void on_write(boost::system::error_code ec, const std::shared_ptr<PricingRequest>& request) {
+            writing_ = false;
+            if (ec || closed_) return close();
+            in_flight_.pop_front();
+            if (request->closeAfter) return close();
+            maybe_read();
+            do_write();
+        }
+    };
+}
+
+PricingServer::PricingServer(PricingServerConfig config) : config_(std::move(config)) {}
+
+PricingServer::~PricingServer() {
+    stop();
+}
+
+void PricingServer::start() {
+    ioc_.restart();
+    if (!config_.unixPath.empty()) {
+        ::unlink(config_.unixPath.c_str()); // stale socket from an earlier run
+        unix_acceptor_.emplace(ioc_, unix_socket::endpoint(config_.unixPath));
+        do_accept_unix();
+    } else {
+        tcp_acceptor_.emplace(ioc_, tcp::endpoint(net::ip::make_address(config_.host), config_.port));
+        do_accept_tcp();
+    }
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopped_ = false;
+    }
+    stopping_ = false;
+    pricing_thread_ = std::thread(&PricingServer::pricing_loop, this);
+    io_thread_ = std::thread([this]() { ioc_.run(); });
+}
+
+void PricingServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        if (stopped_) return;
+    }
+    //connections and acceptors are io thread state, so they are torn down there
+    net::post(ioc_, [this]() {
+        boost::system::error_code ignored;
+        if (tcp_acceptor_) tcp_acceptor_->close(ignored);
+        if (unix_acceptor_) unix_acceptor_->close(ignored);
+        for (auto& weak : sessions_)
+            if (auto session = weak.lock()) session->close();
+        sessions_.clear();
+        paused_.clear();
+        ioc_.stop();
+    });
+    if (io_thread_.joinable()) io_thread_.join();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    if (pricing_thread_.joinable()) pricing_thread_.join();
+    queue_.clear();
+    queued_rows_ = 0;
+    if (!config_.unixPath.empty()) ::unlink(config_.unixPath.c_str());
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopped_ = true;
+    }
+    stop_cv_.notify_all();
+}
+
+void PricingServer::wait() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    stop_cv_.wait(lock, [this]() { return stopped_; });
+}
+
+uint16_t PricingServer::port() const {
+    return tcp_acceptor_ ? tcp_acceptor_->local_endpoint().port() : 0;
+}
+
+PricingServerStats PricingServer::stats() const {
+    PricingServerStats s;
+    s.connections = connections_.load(std::memory_order_relaxed);
+    s.requests = requests_.load(std::memory_order_relaxed);
+    s.rows = rows_.load(std::memory_order_relaxed);
+    s.batches = batches_.load(std::memory_order_relaxed);
+    s.pauses = pauses_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void PricingServer::do_accept_tcp() {
+    tcp_acceptor_->async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+        if (ec == net::error::operation_aborted) return;
+        if (!ec) {
+            socket.set_option(tcp::no_delay(true), ec);
+            auto session = std::make_shared<PricingSession<tcp>>(std::move(socket), *this);
+            sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(), [](auto& w) { return w.expired(); }),
+                            sessions_.end());
+            sessions_.push_back(session);
+            connections_.fetch_add(1, std::memory_order_relaxed);
+            session->start();
+        }
+        do_accept_tcp();
+    });
+}
+
+void PricingServer::do_accept_unix() {
+    unix_acceptor_->async_accept([this](boost::system::error_code ec, unix_socket::socket socket) {
+        if (ec == net::error::operation_aborted) return;
+        if (!ec) {
+            auto session = std::make_shared<PricingSession<unix_socket>>(std::move(socket), *this);
+            sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(), [](auto& w) { return w.expired(); }),
+                            sessions_.end());
+            sessions_.push_back(session);
+            connections_.fetch_add(1, std::memory_order_relaxed);
+            session->start();
+        }
+        do_accept_unix();
+    });
+}
+
+bool PricingServer::submit(std::shared_ptr<PricingRequest> request) {
+    bool room;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queued_rows_ += request->header.count;
+        queue_.push_back(std::move(request));
+        room = queued_rows_ <= config_.maxQueuedRows;
+    }
+    queue_cv_.notify_one();
+    return room;
+}
+
+void PricingServer::pause(const std::shared_ptr<PricingConnection>& connection) {
+    pauses_.fetch_add(1, std::memory_order_relaxed);
+    paused_.push_back(connection);
+}
+
+void PricingServer::resume_paused() {
+    if (paused_.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (queued_rows_ > config_.maxQueuedRows) return;
+    }
+    std::vector<std::weak_ptr<PricingConnection>> waiting;
+    waiting.swap(paused_);
+    for (auto& weak : waiting)
+        if (auto connection = weak.lock()) connection->resume();
+}
+
+void PricingServer::pricing_loop() {
+    std::vector<std::shared_ptr<PricingRequest>> taken, group;
+    std::vector<bool> grouped;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+            //everything that queued up while the last batch was priced, up to maxBatchRows (at least one request)
+            size_t rows = 0;
+            while (!queue_.empty() && (taken.empty() || rows + queue_.front()->header.count <= config_.maxBatchRows)) {
+                rows += queue_.front()->header.count;
+                taken.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+            queued_rows_ -= rows;
+        }
+
+        //one pricing call per (model, greeks, steps) present; arrival order kept inside a group
+        grouped.assign(taken.size(), false);
+        for (size_t first = 0; first < taken.size(); ++first) {
+            if (grouped[first]) continue;
+            group.clear();
+            for (size_t i = first; i < taken.size(); ++i) {
+                if (grouped[i] || !sameGroup(taken[first]->header, taken[i]->header)) continue;
+                grouped[i] = true;
+                group.push_back(taken[i]);
+            }
+            //a throw here (bad_alloc, a lattice that can't be sized) fails this group's requests, not the server
+            try {
+                price_group(group);
+            } catch (const std::exception&) {
+                for (const auto& request : group) {
+                    request->response.status = static_cast<uint16_t>(PricingWire::Status::Failed);
+                    request->response.count = request->response.columns = 0;
+                    request->out.clear();
+                }
+            }
+        }
+        group.clear();
+
+        net::post(ioc_, [this, done = std::move(taken)]() {
+            for (const auto& request : done) request->owner->on_priced(request);
+            resume_paused();
+        });
+        taken.clear();
+    }
+}
+
+void PricingServer::price_group(std::vector<std::shared_ptr<PricingRequest>>& group) {
+    const PricingWire::RequestHeader& key = group.front()->header;
+    const bool greeks = key.flags & PricingWire::WANT_GREEKS;
+    const int steps = key.steps ? static_cast<int>(key.steps) : 1000;
+    const size_t columns = greeks ? 6 : 1;
+
+    size_t n = 0;
+    for (const auto& request : group) n += request->header.count;
+    batch_.resize(n);
+    size_t row = 0;
+    for (const auto& request : group) {
+        if (!columnar(request->header)) {
+            for (const PricingWire::Row& w : request->rows)
+                batch_.set(row++, Option(w.S, w.K, w.r, w.sigma, w.T, w.q, static_cast<OptionType>(w.type),
+                                         static_cast<OptionStyle>(w.style)));
+            continue;
+        }
+        const size_t count = request->header.count;
+        const double* c = request->columns.data();
+        const uint8_t* flags = columnarFlags(*request);
+        for (size_t i = 0; i < count; ++i, ++row)
+            batch_.set(row, Option(c[i], c[count + i], c[2 * count + i], c[3 * count + i], c[4 * count + i],
+                                   c[5 * count + i], static_cast<OptionType>(flags[i]),
+                                   static_cast<OptionStyle>(flags[count + i])));
+    }
+    for (size_t c = 0; c < columns; ++c)
+        if (columns_[c].size() < n) columns_[c].resize(n);
+
+    const OptionBatchView view = batch_.view();
+    //price on the requested model either way, so asking for greeks doesn't move the price
+    if (key.model == static_cast<uint8_t>(PricingWire::Model::Binomial))
+        PricingDispatcher::priceBatchBinomial(view, columns_[0].data(), steps);
+    else
+        PricingDispatcher::priceBatch(view, columns_[0].data(), steps);
+    if (greeks)
+        PricingDispatcher::priceAndGreeksBatch(view, GreekColumns{nullptr, columns_[1].data(), columns_[2].data(),
+                                                                  columns_[3].data(), columns_[4].data(), columns_[5].data()},
+                                               steps);
+
+    //back into each request's response, row-major
+    row = 0;
+    for (const auto& request : group) {
+        const size_t count = request->header.count;
+        request->out.resize(count * columns);
+        for (size_t i = 0; i < count; ++i)
+            for (size_t c = 0; c < columns; ++c) request->out[i * columns + c] = columns_[c][row + i];
+        row += count;
+        request->response.count = static_cast<uint32_t>(count);
+        request->response.columns = static_cast<uint32_t>(columns);
+    }
+    requests_.fetch_add(group.size(), std::memory_order_relaxed);
+    rows_.fetch_add(n, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -7,13 +7,57 @@
 #include "api/Client.h"
 
 #include "api/DataManager.h"
+#include "api/PricingServer.h"
 #include "pricing/PricingDispatcher.h"
+#include "shared/PerfCounters.h"
+#include "shared/PriceRing.h"
+#include <cstdlib>
 #include <thread>
 #include <vector>
 #include <iostream>
+#include <memory>
 #include <chrono>
+#include <boost/asio/signal_set.hpp>
+
+// --serve [--port N | --unix PATH]: no market feed, just the pricing engine behind a socket for local clients
+// (PricingClient / api/PricingProtocol.h). stops on SIGINT/SIGTERM
+static int serve(int argc, char** argv){
+    PricingServerConfig config;
+    if (argc % 2 != 0) throw std::invalid_argument(std::string("Missing value for ") + argv[argc - 1]);
+    for (int i = 2; i + 1 < argc; i += 2){
+        std::string arg = argv[i];
+        if (arg == "--port"){
+            int port = std::stoi(argv[i + 1]);
+            if (port < 0 || port > 65535) throw std::invalid_argument("Port out of range: " + std::string(argv[i + 1]));
+            config.port = static_cast<uint16_t>(port);
+        }
+        else if (arg == "--unix") config.unixPath = argv[i + 1];
+        else throw std::invalid_argument("Unknown option " + arg);
+    }
+    PricingServer server(config);
+    server.start();
+    std::cout << "Pricing server on " << (config.unixPath.empty() ? config.host + ":" + std::to_string(server.port()) : config.unixPath) << std::endl;
+
+    net::io_context signals_ioc;
+    net::signal_set signals(signals_ioc, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int){ server.stop(); });
+    signals_ioc.run();
+
+    PricingServerStats stats = server.stats();
+    std::cout << "Served " << stats.requests << " requests (" << stats.rows << " rows) in " << stats.batches << " batches" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv){
+    if (argc > 1 && std::string(argv[1]) == "--serve"){
+        try{
+            return serve(argc, argv);
+        } catch (const std::exception& e){
+            std::cerr << "Exception: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-int main(){
     // constexpr const char* host = "api.polygon.io";
     // constexpr const char* port = "80";
     // const std::string api_key = load_api_key();
@@ -48,13 +92,38 @@ int main(){
 
         client->run("test.deribit.com", "443", "BTC-2JAN26-90000-C");
 
+        // PRICE_RING=/options_prices: every pass's prices and greeks also go to that shared-memory ring for other
+        // processes on the host (PriceReader); instrument id is the row in the snapshot. opened here rather than on
+        // the pricing thread so a bad ring name is reported below instead of terminating the process
+        std::unique_ptr<PricePublisher> publisher;
+        if (const char* ring = std::getenv("PRICE_RING")) publisher = std::make_unique<PricePublisher>(ring);
+
         std::thread pricing_thread([&](){
+            // PERF_COUNTERS=1: hardware counters around each pricing pass; opened on this thread
+            std::unique_ptr<PerfCounters> counters;
+            if (PerfCounters::enabledFromEnv()) counters = std::make_unique<PerfCounters>();
+            std::vector<double> results; // reused; only grows when the chain does
+            std::vector<double> greeks;  // delta, gamma, theta, vega, rho columns back to back; only with a ring
+            OptionBatch curr_batch;      // likewise: the snapshot is copied into the same arena every tick
             while (true){
                 // std::cout<< "Calculating Prices...\n";
-                OptionBatch curr_batch = data_manager->get_batch_snapshot();
-                if(curr_batch.size() > 0){
-                    std::vector<double> results = engine.priceBatch(curr_batch);
+                data_manager->get_batch_snapshot(curr_batch);
+                const size_t n = curr_batch.size();
+                if(n > 0){
+                    if (counters) counters->start();
+                    results.resize(n);
+                    engine.priceBatch(curr_batch.view(), results.data());
+                    if (publisher){
+                        // prices stay on priceBatch's model; the greeks alone come from the tree
+                        greeks.resize(5 * n);
+                        GreekColumns columns{nullptr, greeks.data(), greeks.data() + n, greeks.data() + 2 * n,
+                                             greeks.data() + 3 * n, greeks.data() + 4 * n};
+                        engine.priceAndGreeksBatch(curr_batch.view(), columns);
+                        columns.price = results.data();
+                        publisher->publishBatch(columns, n);
+                    }
                     std::cout<< "Latest Price for [0]: " << results[0] << std::endl;
+                    if (counters) std::cout << "  " << counters->stop().summary(n) << std::endl;
                 }
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
             }
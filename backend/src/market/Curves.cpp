@@ -0,0 +1,120 @@
+#include "market/Curves.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+RateCurve::RateCurve(double flatRate) : times_{1.0}, logDiscount_{flatRate} {}
+
+RateCurve::RateCurve(std::vector<double> times, std::vector<double> zeroRates) {
+    if (times.size() != zeroRates.size()) throw std::invalid_argument("RateCurve needs one rate per pillar");
+    std::vector<size_t> order(times.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return times[a] < times[b]; });
+    for (size_t i : order) {
+        if (!(times[i] > 0.0)) throw std::invalid_argument("RateCurve pillars must be after today");
+        times_.push_back(times[i]);
+        logDiscount_.push_back(zeroRates[i] * times[i]);
+    }
+}
+
+double RateCurve::zeroRate(double T) const {
+    if (times_.empty()) return 0.0;
+    if (T <= times_.front()) return logDiscount_.front() / times_.front();
+    if (T >= times_.back()) return logDiscount_.back() / times_.back();
+    size_t hi = std::upper_bound(times_.begin(), times_.end(), T) - times_.begin(), lo = hi - 1;
+    double t = (T - times_[lo]) / (times_[hi] - times_[lo]);
+    return ((1.0 - t) * logDiscount_[lo] + t * logDiscount_[hi]) / T;
+}
+
+double RateCurve::discount(double T) const {
+    return std::exp(-zeroRate(T) * T);
+}
+
+MarketCurves::MarketCurves(RateCurve discount, RateCurve carry, std::vector<CashDividend> dividends)
+        : discount_(std::move(discount)), carry_(std::move(carry)) {
+    setDividends(std::move(dividends));
+}
+
+void MarketCurves::setDiscount(RateCurve curve) {
+    discount_ = std::move(curve);
+    cache_.clear();
+}
+
+void MarketCurves::setCarry(RateCurve curve) {
+    carry_ = std::move(curve);
+    cache_.clear();
+}
+
+void MarketCurves::setDividends(std::vector<CashDividend> dividends) {
+    std::sort(dividends.begin(), dividends.end(), [](const CashDividend& a, const CashDividend& b) { return a.time < b.time; });
+    dividends_ = std::move(dividends);
+    cache_.clear();
+}
+
+ExpiryTerms MarketCurves::compute(double T) const {
+    ExpiryTerms e;
+    e.T = T;
+    e.r = discount_.zeroRate(T);
+    e.q = carry_.zeroRate(T);
+    e.discount = std::exp(-e.r * T);
+    e.carryDiscount = std::exp(-e.q * T);
+    e.sqrtT = std::sqrt(T);
+    for (const CashDividend& d : dividends_) {
+        if (d.time > T) break;
+        if (d.time > 0.0) e.pvDividends += d.amount * discount_.discount(d.time);
+    }
+    return e;
+}
+
+ExpiryTerms MarketCurves::terms(double T) {
+    auto it = std::lower_bound(cache_.begin(), cache_.end(), T, [](const ExpiryTerms& e, double t) { return e.T < t; });
+    if (it != cache_.end() && it->T == T) return *it;
+    //T usually drifts with the clock, so a long-running book keeps meeting new expiries: start over once full
+    if (cache_.size() >= MAX_CACHED_EXPIRIES) {
+        cache_.clear();
+        it = cache_.end();
+    }
+    return *cache_.insert(it, compute(T));
+}
+
+ExpiryBuckets MarketCurves::buckets(const OptionBatchView& batch) {
+    ExpiryBuckets out;
+    out.bucket.resize(batch.size());
+    std::unordered_map<double, uint32_t> index;
+    //books are usually grouped by expiry, so most rows hit the previous bucket without hashing
+    double lastT = NAN;
+    uint32_t last = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        double T = batch.T[i];
+        if (T != lastT) {
+            auto [it, added] = index.try_emplace(T, static_cast<uint32_t>(out.terms.size()));
+            if (added) out.terms.push_back(terms(T));
+            last = it->second;
+            lastT = T;
+        }
+        out.bucket[i] = last;
+    }
+    return out;
+}
+
+void MarketCurves::apply(OptionBatch& batch) {
+    double lastT = NAN, lastS = NAN, q = 0.0;
+    ExpiryTerms e;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        double S = batch.S[i], T = batch.T[i];
+        if (T != lastT) {
+            e = terms(T);
+            lastT = T;
+            lastS = NAN;
+        }
+        if (S != lastS) {
+            // S e^{-qT} = S e^{-carry T} - PV; a prepaid forward at or below 0 leaves carry alone
+            double prepaid = S * e.carryDiscount - e.pvDividends;
+            q = e.pvDividends > 0.0 && prepaid > 0.0 ? -std::log(prepaid / S) / T : e.q;
+            lastS = S;
+        }
+        batch.r[i] = e.r;
+        batch.q[i] = q;
+    }
+}
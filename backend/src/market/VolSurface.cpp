@@ -0,0 +1,313 @@
+#include "market/VolSurface.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+double SVIParams::totalVariance(double k) const {
+    double x = k - m;
+    return a + b * (rho * x + std::sqrt(x * x + sigma * sigma));
+}
+
+namespace {
+    // w ~ a + d * y + c * z with y = (k - m) / s, z = sqrt(y^2 + 1); i.e. d = b * rho * s, c = b * s
+    struct LinearFit {
+        double a = 0.0, d = 0.0, c = 0.0, sse = 0.0;
+    };
+
+    // weighted sums for one (m, s); a single vectorized pass over the quotes
+    struct Moments {
+        double n = 0, y = 0, z = 0, yy = 0, yz = 0, zz = 0, w = 0, yw = 0, zw = 0, ww = 0;
+
+        Moments(const double* k, const double* target, const double* wt, size_t count, double m, double s) {
+            double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0, s6 = 0, s7 = 0, s8 = 0, s9 = 0;
+            const double inv = 1.0 / s;
+            #pragma omp simd reduction(+:s0, s1, s2, s3, s4, s5, s6, s7, s8, s9)
+            for (size_t j = 0; j < count; ++j) {
+                double yj = (k[j] - m) * inv;
+                double zj = std::sqrt(yj * yj + 1.0);
+                double q = wt[j], v = target[j];
+                s0 += q; s1 += q * yj; s2 += q * zj;
+                s3 += q * yj * yj; s4 += q * yj * zj; s5 += q * zj * zj;
+                s6 += q * v; s7 += q * yj * v; s8 += q * zj * v; s9 += q * v * v;
+            }
+            n = s0; y = s1; z = s2; yy = s3; yz = s4; zz = s5; w = s6; yw = s7; zw = s8; ww = s9;
+        }
+
+        double sse(double a, double d, double c) const {
+            return ww - 2.0 * (a * w + d * yw + c * zw) + a * a * n + d * d * yy + c * c * zz
+                   + 2.0 * (a * d * y + a * c * z + d * c * yz);
+        }
+    };
+
+    double det3(double a, double b, double c, double d, double e, double f, double g, double h, double i) {
+        return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+    }
+
+    // least squares in (a, d, c) projected onto 0 <= c <= 4s, |d| <= min(c, 4s - c), 0 <= a <= maxW.
+    // when the free solution leaves the box, c is clamped and (a, d) refit, then d clamped and a refit
+    LinearFit solveLinear(const Moments& mo, double s, double maxW) {
+        LinearFit f;
+        double D = det3(mo.n, mo.y, mo.z, mo.y, mo.yy, mo.yz, mo.z, mo.yz, mo.zz);
+        if (std::abs(D) > 1e-300) {
+            f.a = det3(mo.w, mo.y, mo.z, mo.yw, mo.yy, mo.yz, mo.zw, mo.yz, mo.zz) / D;
+            f.d = det3(mo.n, mo.w, mo.z, mo.y, mo.yw, mo.yz, mo.z, mo.zw, mo.zz) / D;
+            f.c = det3(mo.n, mo.y, mo.w, mo.y, mo.yy, mo.yw, mo.z, mo.yz, mo.zw) / D;
+        }
+        double dMax = std::min(f.c, 4.0 * s - f.c);
+        bool feasible = f.c >= 0.0 && f.c <= 4.0 * s && std::abs(f.d) <= dMax && f.a >= 0.0 && f.a <= maxW;
+        if (!feasible) {
+            f.c = std::clamp(f.c, 0.0, 4.0 * s);
+            double D2 = mo.n * mo.yy - mo.y * mo.y;
+            if (std::abs(D2) > 1e-300) {
+                double rw = mo.w - f.c * mo.z, ryw = mo.yw - f.c * mo.yz;
+                f.d = (mo.n * ryw - mo.y * rw) / D2;
+            }
+            dMax = std::min(f.c, 4.0 * s - f.c);
+            f.d = std::clamp(f.d, -dMax, dMax);
+            f.a = std::clamp((mo.w - f.d * mo.y - f.c * mo.z) / mo.n, 0.0, maxW);
+        }
+        f.sse = mo.sse(f.a, f.d, f.c);
+        return f;
+    }
+
+    // 2-d Nelder-Mead over (m, ln s)
+    template<typename Objective>
+    void nelderMead(Objective objective, double (&x)[2], const double (&step)[2], int maxIterations = 300) {
+        double p[3][2] = {{x[0], x[1]}, {x[0] + step[0], x[1]}, {x[0], x[1] + step[1]}};
+        double f[3] = {objective(p[0]), objective(p[1]), objective(p[2])};
+        for (int it = 0; it < maxIterations; ++it) {
+            int order[3] = {0, 1, 2};
+            std::sort(order, order + 3, [&](int i, int j) { return f[i] < f[j]; });
+            int best = order[0], mid = order[1], worst = order[2];
+            double size = std::max(std::abs(p[worst][0] - p[best][0]), std::abs(p[worst][1] - p[best][1]));
+            if (f[worst] - f[best] <= 1e-14 + 1e-10 * std::abs(f[best]) && size < 1e-7) break;
+
+            double c[2] = {0.5 * (p[best][0] + p[mid][0]), 0.5 * (p[best][1] + p[mid][1])};
+            auto along = [&](double t, double (&out)[2]) {
+                out[0] = c[0] + t * (p[worst][0] - c[0]);
+                out[1] = c[1] + t * (p[worst][1] - c[1]);
+                return objective(out);
+            };
+            double r[2], e[2], k[2];
+            double fr = along(-1.0, r);
+            if (fr < f[best]) {
+                double fe = along(-2.0, e);
+                if (fe < fr) { p[worst][0] = e[0]; p[worst][1] = e[1]; f[worst] = fe; }
+                else { p[worst][0] = r[0]; p[worst][1] = r[1]; f[worst] = fr; }
+            } else if (fr < f[mid]) {
+                p[worst][0] = r[0]; p[worst][1] = r[1]; f[worst] = fr;
+            } else {
+                double fk = fr < f[worst] ? along(-0.5, k) : along(0.5, k);
+                if (fk < std::min(fr, f[worst])) {
+                    p[worst][0] = k[0]; p[worst][1] = k[1]; f[worst] = fk;
+                } else {
+                    for (int i : {mid, worst}) {
+                        p[i][0] = 0.5 * (p[i][0] + p[best][0]);
+                        p[i][1] = 0.5 * (p[i][1] + p[best][1]);
+                        f[i] = objective(p[i]);
+                    }
+                }
+            }
+        }
+        int best = std::min_element(f, f + 3) - f;
+        x[0] = p[best][0];
+        x[1] = p[best][1];
+    }
+}
+
+void VolSurface::fit(Slice& slice) {
+    const size_t n = slice.K.size();
+    std::vector<double> k(n), w(n);
+    double maxW = 0.0, minK = 0.0, maxK = 0.0, kAtMinW = 0.0, minW = INFINITY;
+    for (size_t j = 0; j < n; ++j) {
+        k[j] = std::log(slice.K[j] / slice.forward);
+        w[j] = slice.iv[j] * slice.iv[j] * slice.T;
+        maxW = std::max(maxW, w[j]);
+        minK = j == 0 ? k[j] : std::min(minK, k[j]);
+        maxK = j == 0 ? k[j] : std::max(maxK, k[j]);
+        if (w[j] < minW) { minW = w[j]; kAtMinW = k[j]; }
+    }
+    const double* wt = slice.weight.data();
+
+    if (n < 3) { // not enough to fit a smile: flat at the mean quoted variance
+        double mean = 0.0;
+        for (double v : w) mean += v;
+        slice.params = SVIParams{n ? mean / n : 0.0, 0.0, 0.0, 0.0, 0.1};
+    } else {
+        const double loM = minK - 1.0, hiM = maxK + 1.0;
+        auto objective = [&](const double (&x)[2]) {
+            double s = std::exp(x[1]);
+            if (x[0] < loM || x[0] > hiM || s < 1e-4 || s > 10.0) return 1e30;
+            return solveLinear(Moments(k.data(), w.data(), wt, n, x[0], s), s, maxW).sse;
+        };
+        double x[2], step[2];
+        if (slice.fitted) { // warm start: small simplex around the last fit
+            x[0] = slice.params.m; x[1] = std::log(slice.params.sigma);
+            step[0] = 0.02; step[1] = 0.1;
+        } else {
+            x[0] = kAtMinW; x[1] = std::log(0.1);
+            step[0] = 0.1; step[1] = 0.5;
+        }
+        nelderMead(objective, x, step);
+        double s = std::exp(x[1]);
+        LinearFit f = solveLinear(Moments(k.data(), w.data(), wt, n, x[0], s), s, maxW);
+        SVIParams& p = slice.params;
+        p.a = f.a; p.m = x[0]; p.sigma = s;
+        p.b = f.c / s;
+        p.rho = f.c > 0.0 ? f.d / f.c : 0.0;
+    }
+
+    double sq = 0.0;
+    for (size_t j = 0; j < n; ++j) {
+        double model = std::sqrt(std::max(slice.params.totalVariance(k[j]), 0.0) / slice.T);
+        sq += (model - slice.iv[j]) * (model - slice.iv[j]);
+    }
+    slice.rmse = n ? std::sqrt(sq / n) : 0.0;
+    slice.fitted = true;
+    slice.dirty = false;
+}
+
+VolSurface::Slice& VolSurface::sliceFor(double T, double forward) {
+    if (!(T > 0.0) || !(forward > 0.0)) throw std::invalid_argument("VolSurface needs T > 0 and forward > 0");
+    auto it = std::lower_bound(slices_.begin(), slices_.end(), T, [](const Slice& s, double t) { return s.T < t; });
+    if (it == slices_.end() || std::abs(it->T - T) > 1e-12 * std::max(1.0, T)) {
+        Slice slice;
+        slice.T = T;
+        it = slices_.insert(it, slice);
+    }
+    it->forward = forward;
+    it->logForward = std::log(forward);
+    it->dirty = true;
+    return *it;
+}
+
+void VolSurface::setQuote(double T, double forward, double K, double iv, double weight) {
+    if (!(iv > 0.0)) return removeQuote(T, K);
+    Slice& slice = sliceFor(T, forward);
+    auto it = std::find(slice.K.begin(), slice.K.end(), K);
+    if (it == slice.K.end()) {
+        slice.K.push_back(K);
+        slice.iv.push_back(iv);
+        slice.weight.push_back(weight);
+        return;
+    }
+    size_t j = it - slice.K.begin();
+    slice.iv[j] = iv;
+    slice.weight[j] = weight;
+}
+
+//a pulled quote drops out of the fit; an expiry left without quotes goes too, so it can't price at MIN_VOL
+void VolSurface::removeQuote(double T, double K) {
+    auto it = std::lower_bound(slices_.begin(), slices_.end(), T, [](const Slice& s, double t) { return s.T < t; });
+    if (it == slices_.end() || std::abs(it->T - T) > 1e-12 * std::max(1.0, T)) return;
+    auto k = std::find(it->K.begin(), it->K.end(), K);
+    if (k == it->K.end()) return;
+    size_t j = k - it->K.begin();
+    it->K.erase(it->K.begin() + j);
+    it->iv.erase(it->iv.begin() + j);
+    it->weight.erase(it->weight.begin() + j);
+    if (it->K.empty()) slices_.erase(it);
+    else it->dirty = true;
+}
+
+void VolSurface::setSlice(double T, double forward, const std::vector<VolQuote>& quotes) {
+    bool any = std::any_of(quotes.begin(), quotes.end(), [](const VolQuote& q) { return q.iv > 0.0; });
+    if (!any) { // same as pulling every quote
+        auto it = std::lower_bound(slices_.begin(), slices_.end(), T, [](const Slice& s, double t) { return s.T < t; });
+        if (it != slices_.end() && std::abs(it->T - T) <= 1e-12 * std::max(1.0, T)) slices_.erase(it);
+        return;
+    }
+    Slice& slice = sliceFor(T, forward);
+    slice.K.clear(); slice.iv.clear(); slice.weight.clear();
+    for (const VolQuote& q : quotes) {
+        if (!(q.iv > 0.0)) continue;
+        slice.K.push_back(q.K);
+        slice.iv.push_back(q.iv);
+        slice.weight.push_back(q.weight);
+    }
+}
+
+size_t VolSurface::calibrate() {
+    size_t refit = 0;
+    for (Slice& slice : slices_) {
+        if (!slice.dirty) continue;
+        fit(slice);
+        ++refit;
+    }
+    return refit;
+}
+
+bool VolSurface::calibrated() const {
+    if (slices_.empty()) return false;
+    for (const Slice& slice : slices_)
+        if (!slice.fitted || slice.dirty) return false;
+    return true;
+}
+
+long VolSurface::bracket(double T, long hint) const {
+    const long n = static_cast<long>(slices_.size());
+    auto fits = [&](long i) {
+        return (i < 0 || slices_[i].T <= T) && (i + 1 >= n || T < slices_[i + 1].T);
+    };
+    if (hint >= -1 && hint < n && fits(hint)) return hint;
+    auto it = std::upper_bound(slices_.begin(), slices_.end(), T, [](double t, const Slice& s) { return t < s.T; });
+    return static_cast<long>(it - slices_.begin()) - 1;
+}
+
+double VolSurface::logForward(double T, long lo) const {
+    if (lo < 0) return slices_.front().logForward;
+    if (lo + 1 >= static_cast<long>(slices_.size())) return slices_.back().logForward;
+    const Slice &a = slices_[lo], &b = slices_[lo + 1];
+    double t = (T - a.T) / (b.T - a.T);
+    return (1.0 - t) * a.logForward + t * b.logForward;
+}
+
+double VolSurface::forward(double T) const {
+    if (slices_.empty()) throw std::logic_error("VolSurface has no expiries");
+    return std::exp(logForward(T, bracket(T)));
+}
+
+double VolSurface::interpolate(double k, double T, long lo) const {
+    const long n = static_cast<long>(slices_.size());
+    if (lo < 0) return slices_.front().params.totalVariance(k) * T / slices_.front().T;
+    if (lo + 1 >= n) return slices_.back().params.totalVariance(k) * T / slices_.back().T;
+    const Slice &a = slices_[lo], &b = slices_[lo + 1];
+    double t = (T - a.T) / (b.T - a.T);
+    return (1.0 - t) * a.params.totalVariance(k) + t * b.params.totalVariance(k);
+}
+
+double VolSurface::totalVariance(double k, double T) const {
+    if (slices_.empty()) throw std::logic_error("VolSurface has no expiries");
+    return interpolate(k, T, bracket(T));
+}
+
+//before the first expiry (and for T <= 0 or NaN) vol is the first smile's, without dividing by T
+double VolSurface::impliedVol(double k, double T, long lo) const {
+    if (lo < 0) {
+        const Slice& front = slices_.front();
+        return std::max(std::sqrt(std::max(front.params.totalVariance(k), 0.0) / front.T), MIN_VOL);
+    }
+    return std::max(std::sqrt(std::max(interpolate(k, T, lo), 0.0) / T), MIN_VOL);
+}
+
+double VolSurface::vol(double K, double T) const {
+    if (slices_.empty()) throw std::logic_error("VolSurface has no expiries");
+    long lo = T > 0.0 ? bracket(T) : -1;
+    return impliedVol(std::log(K) - logForward(T, lo), T, lo);
+}
+
+void VolSurface::fillSigma(OptionBatch& batch) const {
+    if (slices_.empty()) throw std::logic_error("VolSurface has no expiries");
+    //rows of one expiry are usually adjacent, so the previous bracket is tried first
+    long lo = -2;
+    double lastT = NAN, logF = 0.0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        double T = batch.T[i];
+        if (T != lastT) {
+            lo = T > 0.0 ? bracket(T, lo) : -1;
+            logF = logForward(T, lo);
+            lastT = T;
+        }
+        batch.sigma[i] = impliedVol(std::log(batch.K[i]) - logF, T, lo);
+    }
+}
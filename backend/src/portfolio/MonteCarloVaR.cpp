@@ -0,0 +1,163 @@
+#include "portfolio/MonteCarloVaR.h"
+#include "pricing/BlackScholes.h"
+#include "pricing/BAW.h"
+#include "pricing/PricingDispatcher.h"
+#include "shared/Philox.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <omp.h>
+
+static constexpr double MIN_T = 1e-6; // options expiring inside the horizon are priced at (almost) intrinsic
+
+std::vector<double> MonteCarloVaR::cholesky(const std::vector<double>& C, size_t n) {
+    if (C.size() != n * n) throw std::invalid_argument("Correlation matrix has wrong size");
+    std::vector<double> L(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            double sum = C[i * n + j];
+            for (size_t k = 0; k < j; ++k) sum -= L[i * n + k] * L[j * n + k];
+            if (i == j) {
+                if (sum <= 0.0) throw std::invalid_argument("Correlation matrix is not positive definite");
+                L[i * n + i] = std::sqrt(sum);
+            } else {
+                L[i * n + j] = sum / L[j * n + j];
+            }
+        }
+    }
+    return L;
+}
+
+namespace {
+    // one style's rows copied out contiguously, so the per-scenario loop streams through them
+    struct Rows {
+        OptionBatch batch;
+        std::vector<int> underlying;
+        std::vector<double> weight, base; // quantity * multiplier, unshocked price
+    };
+
+    double priceAmerican(const OptionBatch& batch, size_t i, int iterations) {
+        return BAW::priceParameters(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], iterations);
+    }
+}
+
+VaRResult MonteCarloVaR::run(const Portfolio& portfolio, const VaRConfig& config) {
+    const size_t U = portfolio.underlyings().size();
+    const size_t F = 2 * U;
+    const size_t scenarios = config.scenarios;
+    const double h = config.horizon;
+    if (U == 0 || scenarios == 0) return {};
+
+    std::vector<double> L = config.correlation.empty() ? std::vector<double>() : cholesky(config.correlation, F);
+
+    // split rows by style; spot vol defaults to the mean implied vol per underlying
+    Rows euro, amer;
+    std::vector<double> volSum(U, 0.0), volCount(U, 0.0);
+    const OptionBatch& book = portfolio.batch();
+    for (size_t i = 0; i < book.size(); ++i) {
+        Rows& rows = book.style[i] == OptionStyle::European ? euro : amer;
+        rows.batch.push_back(book.get(i));
+        rows.underlying.push_back(portfolio.underlyingIndex(i));
+        rows.weight.push_back(portfolio.quantity(i) * portfolio.multiplier(i));
+        volSum[portfolio.underlyingIndex(i)] += book.sigma[i];
+        volCount[portfolio.underlyingIndex(i)] += 1.0;
+    }
+    std::vector<double> spotVol(U), volOfVol(U);
+    for (size_t u = 0; u < U; ++u) {
+        spotVol[u] = config.spotVol.empty() ? volSum[u] / std::max(volCount[u], 1.0) : config.spotVol.at(u);
+        volOfVol[u] = config.volOfVol.empty() ? 1.0 : config.volOfVol.at(u);
+    }
+
+    // base prices with the same models used in the scenarios, so P&L has no model basis
+    euro.base.resize(euro.batch.size());
+    amer.base.resize(amer.batch.size());
+    PricingDispatcher::priceBatch(euro.batch.view(), euro.base.data());
+    if (config.surrogate) {
+        config.surrogate->priceBatch(amer.batch, amer.base.data());
+    } else {
+        int iterations = config.bawIterations;
+        #pragma omp parallel for schedule(dynamic, 64) default(none) shared(amer, iterations)
+        for (size_t i = 0; i < amer.batch.size(); ++i)
+            amer.base[i] = priceAmerican(amer.batch, i, iterations);
+    }
+
+    VaRResult result;
+    result.pnl.assign(scenarios, 0.0);
+    const ChebyshevSurrogate* surrogate = config.surrogate;
+    const uint64_t seed = config.seed;
+    const int iterations = config.bawIterations;
+    const double sqrtH = std::sqrt(h);
+    const double minT = MIN_T;
+
+    #pragma omp parallel default(none) shared(euro, amer, L, spotVol, volOfVol, result, surrogate) \
+            firstprivate(U, F, scenarios, h, sqrtH, minT, seed, iterations)
+    {
+        std::vector<float> eps(F);
+        std::vector<double> z(F), spotMove(U), volMove(U), amerPrices(amer.batch.size());
+        OptionBatch shocked = amer.batch; // per-thread american rows for the surrogate / BAW
+
+        const size_t nEuro = euro.batch.size();
+        const double *S = euro.batch.S.data(), *K = euro.batch.K.data(), *r = euro.batch.r.data();
+        const double *sigma = euro.batch.sigma.data(), *T = euro.batch.T.data(), *q = euro.batch.q.data();
+        const uint64_t* putMask = euro.batch.type.data();
+        const int* und = euro.underlying.data();
+        const double *weight = euro.weight.data(), *base = euro.base.data();
+
+    //scenario k depends only on (seed, k): any split over threads gives the same pnl vector
+    #pragma omp for schedule(dynamic, 16)
+        for (size_t k = 0; k < scenarios; ++k) {
+            Philox::normals(seed, k, eps.data(), F);
+            for (size_t f = 0; f < F; ++f) {
+                double sum = 0.0;
+                if (L.empty()) sum = eps[f];
+                else for (size_t g = 0; g <= f; ++g) sum += L[f * F + g] * eps[g];
+                z[f] = sum;
+            }
+            for (size_t u = 0; u < U; ++u) {
+                spotMove[u] = std::exp(-0.5 * spotVol[u] * spotVol[u] * h + spotVol[u] * sqrtH * z[u]);
+                volMove[u] = std::exp(-0.5 * volOfVol[u] * volOfVol[u] * h + volOfVol[u] * sqrtH * z[U + u]);
+            }
+
+            double pnl = 0.0;
+            const double* spotM = spotMove.data();
+            const double* volM = volMove.data();
+            #pragma omp simd reduction(+:pnl)
+            for (size_t i = 0; i < nEuro; ++i) {
+                double Si = S[i] * spotM[und[i]];
+                double sigmai = sigma[i] * volM[und[i]];
+                double Ti = std::max(T[i] - h, minT);
+                double d1 = (VecMath::log(Si / K[i]) + (r[i] + sigmai * sigmai / 2) * Ti) / (sigmai * VecMath::sqrt(Ti));
+                double d2 = d1 - sigmai * VecMath::sqrt(Ti);
+                double dfK = K[i] * VecMath::exp(-r[i] * Ti), dfS = VecMath::exp(-q[i] * Ti) * Si;
+                double price = putMask[i] ? normCDF(-d2) * dfK - dfS * normCDF(-d1) : dfS * normCDF(d1) - normCDF(d2) * dfK;
+                pnl += weight[i] * (price - base[i]);
+            }
+
+            if (shocked.size() > 0) {
+                for (size_t i = 0; i < shocked.size(); ++i) {
+                    shocked.S[i] = amer.batch.S[i] * spotMove[amer.underlying[i]];
+                    shocked.sigma[i] = amer.batch.sigma[i] * volMove[amer.underlying[i]];
+                    shocked.T[i] = std::max(amer.batch.T[i] - h, minT);
+                }
+                if (surrogate) surrogate->priceBatch(shocked, amerPrices.data()); // nested region runs serially
+                else for (size_t i = 0; i < shocked.size(); ++i) amerPrices[i] = priceAmerican(shocked, i, iterations);
+                for (size_t i = 0; i < shocked.size(); ++i)
+                    pnl += amer.weight[i] * (amerPrices[i] - amer.base[i]);
+            }
+            result.pnl[k] = pnl;
+        }
+    }
+
+    // statistics from the full vector, serially, so they are reproducible too
+    std::vector<double> sorted = result.pnl;
+    std::sort(sorted.begin(), sorted.end());
+    size_t tail = std::max<size_t>(1, static_cast<size_t>(std::floor((1.0 - config.confidence) * scenarios)));
+    result.var = -sorted[tail - 1];
+    result.expectedShortfall = -std::accumulate(sorted.begin(), sorted.begin() + tail, 0.0) / tail;
+    result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / scenarios;
+    double sq = 0.0;
+    for (double p : sorted) sq += (p - result.mean) * (p - result.mean);
+    result.stdev = std::sqrt(sq / std::max<size_t>(scenarios - 1, 1));
+    return result;
+}
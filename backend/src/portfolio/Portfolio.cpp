@@ -0,0 +1,171 @@
+#include "portfolio/Portfolio.h"
+#include "pricing/BlackScholes.h"
+#include "pricing/BinomialTree.h"
+#include "shared/BinomialWorkspace.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <omp.h>
+
+// price + greeks for one contract, in BlackScholes::computeGreeks units for both styles
+static PortfolioRisk unitRisk(const Option& opt, BinomialWorkspace& workspace, int steps) {
+    if (opt.style == OptionStyle::European) {
+        Greeks g = BlackScholes::computeGreeks(opt);
+        return {BlackScholes::price(opt), g.delta, g.gamma, g.vega, g.theta};
+    }
+    double price = BinomialTree::priceWorkspace(opt, steps, workspace);
+    Greeks g = BinomialTree::computeGreeks(opt, workspace, steps);
+    //tree greeks are per unit vol and per year
+    return {price, g.delta, g.gamma, g.vega / 100.0, g.theta / 365.0};
+}
+
+size_t Portfolio::addPosition(const Option& opt, double quantity, const std::string& underlying,
+                              double multiplier, int expiryDays) {
+    if (expiryDays < 0) expiryDays = static_cast<int>(std::lround(opt.T * 365.0));
+    size_t row = batch_.size();
+    batch_.push_back(opt);
+    quantity_.push_back(quantity);
+    multiplier_.push_back(multiplier);
+    underlyingOf_.push_back(bucketUnderlying(underlying));
+    expiryOf_.push_back(bucketExpiry(expiryDays));
+    rowsByUnderlying_[underlyingOf_.back()].push_back(row);
+    unit_.emplace_back(); // priced (and counted) on the next reprice()
+    return row;
+}
+
+int Portfolio::bucketUnderlying(const std::string& underlying) {
+    auto it = underlyingIds_.find(underlying);
+    if (it != underlyingIds_.end()) return it->second;
+    int id = static_cast<int>(underlyingNames_.size());
+    underlyingIds_.emplace(underlying, id);
+    underlyingNames_.push_back(underlying);
+    rowsByUnderlying_.emplace_back();
+    byUnderlying_.emplace_back();
+    return id;
+}
+
+int Portfolio::bucketExpiry(int expiryDays) {
+    auto it = expiryIds_.find(expiryDays);
+    if (it != expiryIds_.end()) return it->second;
+    int id = static_cast<int>(expiryDays_.size());
+    expiryIds_.emplace(expiryDays, id);
+    expiryDays_.push_back(expiryDays);
+    byExpiry_.emplace_back();
+    return id;
+}
+
+PortfolioRisk Portfolio::scaled(size_t row) const {
+    double size = quantity_[row] * multiplier_[row];
+    const PortfolioRisk& u = unit_[row];
+    return {size * u.value, size * u.delta, size * u.gamma, size * u.vega, size * u.theta};
+}
+
+void Portfolio::reprice() {
+    size_t N = batch_.size();
+    size_t numUnderlyings = byUnderlying_.size(), numExpiries = byExpiry_.size();
+    book_ = {};
+    byUnderlying_.assign(numUnderlyings, {});
+    byExpiry_.assign(numExpiries, {});
+
+    #pragma omp parallel default(none) shared(N, numUnderlyings, numExpiries)
+    {
+        BinomialWorkspace workspace(steps_);
+        PortfolioRisk localBook;
+        std::vector<PortfolioRisk> localUnderlying(numUnderlyings), localExpiry(numExpiries);
+
+    //reduce while the row is still in registers; american rows are far slower, hence dynamic
+    #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < N; ++i) {
+            unit_[i] = unitRisk(batch_.get(i), workspace, steps_);
+            PortfolioRisk contribution = scaled(i);
+            localBook += contribution;
+            localUnderlying[underlyingOf_[i]] += contribution;
+            localExpiry[expiryOf_[i]] += contribution;
+        }
+
+    #pragma omp critical
+        {
+            book_ += localBook;
+            for (size_t u = 0; u < numUnderlyings; ++u) byUnderlying_[u] += localUnderlying[u];
+            for (size_t e = 0; e < numExpiries; ++e) byExpiry_[e] += localExpiry[e];
+        }
+    }
+}
+
+// sign = -1 removes the row's current contribution, +1 adds it back
+void Portfolio::applyRow(size_t row, double sign) {
+    PortfolioRisk contribution = scaled(row);
+    if (sign < 0) {
+        book_ -= contribution;
+        byUnderlying_[underlyingOf_[row]] -= contribution;
+        byExpiry_[expiryOf_[row]] -= contribution;
+    } else {
+        book_ += contribution;
+        byUnderlying_[underlyingOf_[row]] += contribution;
+        byExpiry_[expiryOf_[row]] += contribution;
+    }
+}
+
+void Portfolio::priceRow(size_t row) {
+    static thread_local BinomialWorkspace workspace(0);
+    workspace.resize(steps_);
+    unit_[row] = unitRisk(batch_.get(row), workspace, steps_);
+}
+
+void Portfolio::repriceRow(size_t row) {
+    applyRow(row, -1.0);
+    priceRow(row);
+    applyRow(row, 1.0);
+}
+
+void Portfolio::updatePosition(size_t row, const Option& opt, const std::string& underlying, int expiryDays) {
+    if (row >= batch_.size()) throw std::out_of_range("Portfolio row out of range");
+    if (expiryDays < 0 && opt.T != batch_.T[row]) expiryDays = static_cast<int>(std::lround(opt.T * 365.0));
+    int newUnderlying = underlying.empty() ? underlyingOf_[row] : bucketUnderlying(underlying);
+    int newExpiry = expiryDays < 0 ? expiryOf_[row] : bucketExpiry(expiryDays);
+
+    //old contribution comes out of the old buckets, the repriced one goes into the new ones
+    applyRow(row, -1.0);
+    if (newUnderlying != underlyingOf_[row]) {
+        std::vector<size_t>& rows = rowsByUnderlying_[underlyingOf_[row]];
+        rows.erase(std::find(rows.begin(), rows.end(), row));
+        rowsByUnderlying_[newUnderlying].push_back(row);
+        underlyingOf_[row] = newUnderlying;
+    }
+    expiryOf_[row] = newExpiry;
+    batch_.set(row, opt);
+    priceRow(row);
+    applyRow(row, 1.0);
+}
+
+void Portfolio::setQuantity(size_t row, double quantity) {
+    if (row >= batch_.size()) throw std::out_of_range("Portfolio row out of range");
+    applyRow(row, -1.0);
+    quantity_[row] = quantity;
+    applyRow(row, 1.0);
+}
+
+void Portfolio::updateSpot(const std::string& underlying, double S) {
+    auto it = underlyingIds_.find(underlying);
+    if (it == underlyingIds_.end()) return;
+    for (size_t row : rowsByUnderlying_[it->second]) {
+        batch_.S[row] = S;
+        repriceRow(row);
+    }
+}
+
+const PortfolioRisk& Portfolio::underlyingRisk(const std::string& underlying) const {
+    auto it = underlyingIds_.find(underlying);
+    if (it == underlyingIds_.end()) throw std::out_of_range("Unknown underlying " + underlying);
+    return byUnderlying_[it->second];
+}
+
+const PortfolioRisk& Portfolio::expiryRisk(int expiryDays) const {
+    auto it = expiryIds_.find(expiryDays);
+    if (it == expiryIds_.end()) throw std::out_of_range("Unknown expiry bucket");
+    return byExpiry_[it->second];
+}
+
+PortfolioRisk Portfolio::positionRisk(size_t row) const {
+    return scaled(row);
+}
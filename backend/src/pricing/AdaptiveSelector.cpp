@@ -0,0 +1,147 @@
+#include "pricing/AdaptiveSelector.h"
+#include "pricing/BAW.h"
+#include "pricing/BinomialTree.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <omp.h>
+
+static constexpr int MODEL_STEPS[AdaptiveModelSelector::NUM_MODELS] = {0, 100, 250, 500, 1000};
+
+// bin edges; n edges -> n+1 bins
+static constexpr double MONEYNESS_EDGES[] = {-1.0, -0.3, 0.0, 0.3, 1.0}; // ln(S/K) / (sigma*sqrt(T))
+static constexpr double EXPIRY_EDGES[] = {0.1, 0.25, 0.5, 1.0};
+static constexpr double VOL_EDGES[] = {0.1, 0.2, 0.35, 0.6};
+static constexpr double CARRY_EDGES[] = {0.0, 0.03};                   // r - q
+
+template<size_t N>
+static int binOf(double x, const double (&edges)[N]) {
+    return static_cast<int>(std::upper_bound(edges, edges + N, x) - edges);
+}
+
+AdaptiveModelSelector::AdaptiveModelSelector(double tolerance)
+        : tolerance_(tolerance),
+          maxError_(NUM_REGIONS * NUM_MODELS, -1.0),
+          samples_(NUM_REGIONS, 0),
+          choice_(NUM_REGIONS, AmericanModel::Binomial1000) {}
+
+int AdaptiveModelSelector::regionOf(double S, double K, double r, double sigma, double T, double q, OptionType type) {
+    int m = binOf(std::log(S / K) / (sigma * std::sqrt(T)), MONEYNESS_EDGES);
+    int t = binOf(T, EXPIRY_EDGES);
+    int v = binOf(sigma, VOL_EDGES);
+    int c = binOf(r - q, CARRY_EDGES);
+    return ((((m * EXPIRY_BINS + t) * VOL_BINS + v) * CARRY_BINS + c) * 2) + (type == OptionType::Put ? 1 : 0);
+}
+
+double AdaptiveModelSelector::priceWith(AmericanModel model, double S, double K, double r, double sigma, double T,
+                                        double q, OptionType type, BinomialWorkspace& workspace) {
+    if (model == AmericanModel::BAW)
+        return BAW::priceParameters(S, K, r, sigma, T, q, type);
+    return BinomialTree::priceParametersWorkspace(S, K, r, sigma, T, q, type,
+                                                  MODEL_STEPS[static_cast<int>(model)], workspace);
+}
+
+void AdaptiveModelSelector::calibrate(const std::vector<Option>& sample, int referenceSteps) {
+    size_t n = sample.size();
+    std::vector<double> errors(n * NUM_MODELS);
+
+    #pragma omp parallel default(none) shared(sample, errors, referenceSteps, n)
+    {
+        // the candidates run on the same workspace, so it must also fit the biggest model when the reference is small
+        BinomialWorkspace workspace(std::max(referenceSteps + 1, MAX_STEPS));
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t i = 0; i < n; ++i) {
+            const Option& o = sample[i];
+            // averaging adjacent step counts cancels most of the CRR odd/even oscillation
+            double reference = 0.5 * (
+                    BinomialTree::priceParametersWorkspace(o.S, o.K, o.r, o.sigma, o.T, o.q, o.type, referenceSteps, workspace) +
+                    BinomialTree::priceParametersWorkspace(o.S, o.K, o.r, o.sigma, o.T, o.q, o.type, referenceSteps + 1, workspace));
+            for (int m = 0; m < NUM_MODELS; ++m) {
+                double p = priceWith(static_cast<AmericanModel>(m), o.S, o.K, o.r, o.sigma, o.T, o.q, o.type, workspace);
+                errors[i * NUM_MODELS + m] = std::abs(p - reference) / o.K;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        const Option& o = sample[i];
+        int region = regionOf(o.S, o.K, o.r, o.sigma, o.T, o.q, o.type);
+        ++samples_[region];
+        for (int m = 0; m < NUM_MODELS; ++m) {
+            double& worst = maxError_[region * NUM_MODELS + m];
+            worst = std::max(worst, errors[i * NUM_MODELS + m]);
+        }
+    }
+    route();
+}
+
+void AdaptiveModelSelector::setTolerance(double tolerance) {
+    tolerance_ = tolerance;
+    route();
+}
+
+// unseen or thinly sampled regions get the most accurate model; no bound can be claimed there
+void AdaptiveModelSelector::route() {
+    for (int region = 0; region < NUM_REGIONS; ++region) {
+        choice_[region] = AmericanModel::Binomial1000;
+        if (samples_[region] < MIN_SAMPLES) continue;
+        for (int m = 0; m < NUM_MODELS; ++m) {
+            if (maxError_[region * NUM_MODELS + m] * SAFETY <= tolerance_) {
+                choice_[region] = static_cast<AmericanModel>(m);
+                break;
+            }
+        }
+    }
+}
+
+double AdaptiveModelSelector::regionError(int region, AmericanModel model) const {
+    return maxError_[region * NUM_MODELS + static_cast<int>(model)];
+}
+
+AmericanModel AdaptiveModelSelector::select(double S, double K, double r, double sigma, double T, double q,
+                                            OptionType type) const {
+    return choice_[regionOf(S, K, r, sigma, T, q, type)];
+}
+
+double AdaptiveModelSelector::price(double S, double K, double r, double sigma, double T, double q, OptionType type,
+                                    BinomialWorkspace& workspace) const {
+    return priceWith(select(S, K, r, sigma, T, q, type), S, K, r, sigma, T, q, type, workspace);
+}
+
+// plain text: header, then one line per region w/ sample count and per-model worst error
+bool AdaptiveModelSelector::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out.precision(17);
+    out << "adaptive-selector 1 " << NUM_REGIONS << ' ' << NUM_MODELS << ' ' << tolerance_ << '\n';
+    for (int region = 0; region < NUM_REGIONS; ++region) {
+        out << samples_[region];
+        for (int m = 0; m < NUM_MODELS; ++m) out << ' ' << maxError_[region * NUM_MODELS + m];
+        out << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+// the table only; the selector keeps its own tolerance and routes the loaded errors with it.
+// parsed into locals so a bad or short file leaves the selector as it was
+bool AdaptiveModelSelector::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::string magic;
+    int version = 0, regions = 0, models = 0;
+    double savedTolerance = 0.0;
+    in >> magic >> version >> regions >> models >> savedTolerance;
+    if (!in || magic != "adaptive-selector" || version != 1 || regions != NUM_REGIONS || models != NUM_MODELS)
+        return false;
+    std::vector<int> samples(NUM_REGIONS);
+    std::vector<double> maxError(NUM_REGIONS * NUM_MODELS);
+    for (int region = 0; region < NUM_REGIONS; ++region) {
+        in >> samples[region];
+        for (int m = 0; m < NUM_MODELS; ++m) in >> maxError[region * NUM_MODELS + m];
+    }
+    if (!in) return false;
+    samples_ = std::move(samples);
+    maxError_ = std::move(maxError);
+    route();
+    return true;
+}
@@ -60,7 +60,7 @@ static double find_critical_Sx(double K, double r, double q, double sigma, doubl
         double f_double_prime = second_derivative(Sx, K, r, q, sigma, T, type);
         double newSx = Sx - f_prime / f_double_prime;
         if (std::abs(newSx - Sx) < tol) // on event difference is so minimal
-            return newSx;
+            return newSx > 0.0 ? newSx : -1; // low vol puts with q > r can settle on a negative root
         Sx = newSx;
     }
 //    std::cerr << "Fallback "<<baw_fallback_counter<<"\n";
@@ -103,33 +103,7 @@ double BAW::price(const Option& opt, int steps) {
     return amer;
 }
 
-double BAW::priceParameters(double S, double K, double r, double sigma, double T, double q, OptionType type, int steps){
-    double sigma2 = sigma*sigma;
-
-    double n = calc_n(r, q, sigma2);
-    double k = calc_k(r, T, sigma2);
-
-    int maxIterations = steps;
+double BAW::criticalPrice(double K, double r, double sigma, double T, double q, OptionType type, int maxIterations) {
     double tol = 1e-5;
-    double Sx = find_critical_Sx(K, r, q, sigma, T, type, maxIterations, tol);
-    if(Sx==-1){
-//        std::cerr<<"Did not converge\n";
-        return BinomialTree::priceParameters(S, K, r, sigma, T, q, type, 1000);
-    }
-    double d1 = (std::log(Sx / K) + (r - q + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
-
-    double euro = BlackScholes::priceParameter(S, K, r, sigma, T, q, type);
-    double amer = euro;
-
-    if (type == OptionType::Call) {
-        double q2 = 0.5 * (-n + std::sqrt((n - 1.0) * (n - 1.0) + 4.0 * k));
-        double A2 = Sx * (1.0 - std::exp(-q * T) * normCDF(d1)) / q2;
-        amer = (S < Sx) ? euro + A2 * std::pow(S / Sx, q2) : std::max(0.0, S - K);
-    } else {
-        double q1 = 0.5 * (-n - std::sqrt((n - 1.0) * (n - 1.0) + 4.0 * k));
-        double A1 = -Sx * (1.0 - std::exp(-q * T) * normCDF(-d1)) / q1;
-        amer = (S > Sx) ? euro + A1 * std::pow(S / Sx, q1) : std::max(0.0, K - S);
-    }
-
-    return amer;
+    return find_critical_Sx(K, r, q, sigma, T, type, maxIterations, tol);
 }
\ No newline at end of file
@@ -4,12 +4,28 @@
 
 #include "pricing/BinomialTree.h"
 #include <vector>
+#include <cmath>
 #include "shared/MathUtils.h"
 
+//the workspace-less overloads share one per-thread lattice (grown to the largest steps seen), so BAW's fallback and
+//other per-option callers don't allocate two vectors per call
+BinomialWorkspace& BinomialTree::threadWorkspace(int steps) {
+    static thread_local BinomialWorkspace workspace(0);
+    workspace.reserveSteps(steps);
+    return workspace;
+}
+
 double BinomialTree::price(const Option& opt, int steps) {
+    return priceWorkspace(opt, steps, threadWorkspace(steps));
+}
+
+double BinomialTree::priceWorkspace(const Option &opt, int steps, BinomialWorkspace &workspace) {
+    auto& prices = workspace.prices;
+    auto& option_values = workspace.optionValues;
+
     double dt = opt.T / steps;
-    double u =std::exp(opt.sigma*std::sqrt(dt));//up factor; stock price increase by factor of u
-    double d = 1.0 /u; //down factor
+    double u = std::exp(opt.sigma * std::sqrt(dt)); //up factor; stock price increase by factor of u
+    double d = 1.0 / u; //down factor
     double p = (std::exp((opt.r - opt.q) * dt) - d) / (u - d); //risk neutral probability q
     double discount = std::exp(-opt.r * dt); //discount factor: to calculate how much money is worth today
 
@@ -18,10 +34,6 @@ double BinomialTree::price(const Option& opt, int steps) {
     /* Reaching node with k up moves, N-k down moves:
      * Price S_k = S_0 * u^k * d^(N-k)
      * Probability = N choose k * q^k * (1-q)^(N-k) */
-    std::vector<double> prices(steps + 1);
-    std::vector<double> option_values(steps + 1);
-
-    // calculate terminal prices
     for (int i = 0; i <= steps; i++) {
         prices[i] = opt.S * std::pow(u, steps - i) * std::pow(d, i); //terminal stock price
         if (opt.type == OptionType::Call)
@@ -33,7 +45,7 @@ double BinomialTree::price(const Option& opt, int steps) {
     // Backward induction: calculate option today by moving backwards
     for (int step = steps - 1; step >= 0; step--) {
         for (int i = 0; i <= step; i++) {
-            prices[i] = prices[i] / u; //move prices back a step
+            prices[i] /= u; //move prices back a step
             double continuation = discount * (p * option_values[i] + (1 - p) * option_values[i + 1]); //val of option considering two possibilities
             double exercise; //intrinsic val/early exercise val
             if (opt.type == OptionType::Call)
@@ -48,104 +60,206 @@ double BinomialTree::price(const Option& opt, int steps) {
     return option_values[0];
 }
 
-double BinomialTree::priceWorkspace(const Option &opt, int steps, BinomialWorkspace &workspace) {
-    auto& prices = workspace.prices;
-    auto& option_values = workspace.optionValues;
+double BinomialTree::priceParameters(double S, double K, double r, double sigma, double T, double q,
+                                              OptionType type, int steps) {
+    return priceWorkspace(Option(S, K, r, sigma, T, q, type, OptionStyle::American), steps, threadWorkspace(steps));
+}
 
-    double dt = opt.T / steps;
-    double u = std::exp(opt.sigma * std::sqrt(dt));
-    double d = 1.0 / u;
-    double p = (std::exp((opt.r - opt.q) * dt) - d) / (u - d);
-    double discount = std::exp(-opt.r * dt);
+void BinomialLattice::build(double S_, double r_, double sigma_, double T_, double q_, int steps_) {
+    steps = steps_; S = S_; r = r_; sigma = sigma_; T = T_; q = q_;
+    double dt = T / steps;
+    double logU = sigma * std::sqrt(dt);
+    u = std::exp(logU);
+    p = (std::exp((r - q) * dt) - 1.0 / u) / (u - 1.0 / u);
+    discount = std::exp(-r * dt);
+    spot.assign(2 * (static_cast<size_t>(steps) + 1), 0.0);
+    //price S u^(j - steps) for j in [0, 2 steps]; node (n, i) has j = steps + n - 2i
+    for (int j = 0; j <= 2 * steps; ++j)
+        spot[(j & 1) * (steps + 1) + ((2 * steps - j) >> 1)] = S * std::exp((j - steps) * logU);
+}
 
-    for (int i = 0; i <= steps; i++) {
-        prices[i] = opt.S * std::pow(u, steps - i) * std::pow(d, i);
-        if (opt.type == OptionType::Call)
-            option_values[i] = std::max(prices[i] - opt.K, 0.0); //terminal option vals
-        else
-            option_values[i] = std::max(opt.K - prices[i], 0.0);
-    }
+double BinomialTree::priceOnLattice(const BinomialLattice& lattice, double K, OptionType type, BinomialWorkspace& workspace) {
+    const int N = lattice.steps;
+    if (workspace.optionValues.size() < static_cast<size_t>(N) + 1) workspace.resize(N);
+    double* V = workspace.optionValues.data();
+    const double p = lattice.p, discount = lattice.discount;
+    const double sign = type == OptionType::Call ? 1.0 : -1.0;
 
-    for (int step = steps - 1; step >= 0; step--) {
+    const double* terminal = lattice.level(N);
+    for (int i = 0; i <= N; i++) V[i] = std::max(sign * (terminal[i] - K), 0.0);
+    for (int step = N - 1; step >= 0; step--) {
+        const double* level = lattice.level(step);
+        #pragma omp simd
         for (int i = 0; i <= step; i++) {
-            prices[i] /= u;
-            double continuation = discount * (p * option_values[i] + (1 - p) * option_values[i + 1]);
-            double exercise;
-            if (opt.type == OptionType::Call)
-                exercise = std::max(prices[i] - opt.K, 0.0);
-            else
-                exercise = std::max(opt.K - prices[i], 0.0);
-            option_values[i] = std::max(continuation, exercise);
+            double continuation = discount * (p * V[i] + (1 - p) * V[i + 1]);
+            V[i] = std::max(continuation, std::max(sign * (level[i] - K), 0.0));
         }
     }
+    return V[0];
+}
 
-    return option_values[0];
+void BinomialTree::priceStrikes(const BinomialLattice& lattice, const double* K, const OptionType* type, size_t count,
+                                double* out, BinomialWorkspace& workspace) {
+    constexpr size_t L = STRIKE_LANES;
+    const int N = lattice.steps;
+    const size_t nodes = static_cast<size_t>(N) + 1;
+    if (workspace.strikeValues.size() < nodes * L) workspace.strikeValues.resize(nodes * L);
+    double* V = workspace.strikeValues.data();
+    const double p = lattice.p, discount = lattice.discount;
+    const double up = discount * p, down = discount * (1 - p);
+
+    for (size_t first = 0; first < count; first += L) {
+        //spare lanes repeat the last strike
+        alignas(64) double strike[L], sign[L];
+        for (size_t l = 0; l < L; ++l) {
+            size_t j = first + std::min(l, count - first - 1);
+            strike[l] = K[j];
+            sign[l] = type[j] == OptionType::Call ? 1.0 : -1.0;
+        }
+
+        const double* terminal = lattice.level(N);
+        for (size_t i = 0; i < nodes; ++i) {
+            #pragma omp simd
+            for (size_t l = 0; l < L; ++l) V[i * L + l] = std::max(sign[l] * (terminal[i] - strike[l]), 0.0);
+        }
+
+        //nodes whose every reachable payoff is 0 stay exactly 0 and are skipped. all calls: 0 from node `hi` down
+        //(lower spot) at every step. all puts: 0 above node `lo`, and the block shrinks by one node per step back
+        bool calls = true, puts = true;
+        for (size_t l = 0; l < L; ++l) (sign[l] > 0 ? puts : calls) = false;
+        int hi = N + 1, lo = 0;
+        if (calls || puts) {
+            auto live = [&](int i) {
+                for (size_t l = 0; l < L; ++l) if (V[i * L + l] != 0.0) return true;
+                return false;
+            };
+            if (calls) while (hi > 0 && !live(hi - 1)) --hi;
+            if (puts) while (lo <= N && !live(lo)) ++lo;
+        }
+
+        for (int step = N - 1; step >= 0; step--) {
+            const double* level = lattice.level(step);
+            lo = std::max(lo - 1, 0);
+            const int last = std::min(step, hi - 1);
+            for (int i = lo; i <= last; i++) {
+                const double s = level[i];
+                double* v = V + i * L;
+                #pragma omp simd aligned(strike, sign : 64)
+                for (size_t l = 0; l < L; ++l) {
+                    double continuation = up * v[l] + down * v[l + L];
+                    v[l] = std::max(continuation, std::max(sign[l] * (s - strike[l]), 0.0));
+                }
+            }
+        }
+        for (size_t l = 0; l < L && first + l < count; ++l) out[first + l] = V[l];
+    }
 }
 
-double BinomialTree::priceParametersWorkspace(double S, double K, double r, double sigma, double T, double q,
-                                              OptionType type, int steps, BinomialWorkspace &workspace) {
+namespace {
+    //Peizer-Pratt method 2 inversion: binomial probability for n steps matching N(z). kept off 0 and 1: far from
+    //the strike with a tiny vol both probabilities saturate and d = (growth - p u) / (1 - p) would be 0 / 0; clamped
+    //alike, the tree collapses onto the forward, which is the right answer there
+    double peizerPratt(double z, int n) {
+        double t = z / (n + 1.0 / 3.0 + 0.1 / (n + 1.0));
+        double h = std::min(0.5 * std::sqrt(1.0 - std::exp(-t * t * (n + 1.0 / 6.0))), 0.5 - 1e-10);
+        return z >= 0 ? 0.5 + h : 0.5 - h;
+    }
+}
+
+double BinomialTree::priceLeisenReimer(const Option& opt, int steps, BinomialWorkspace& workspace) {
+    steps |= 1;
+    if (workspace.prices.size() < static_cast<size_t>(steps) + 1) workspace.resize(steps);
     auto& prices = workspace.prices;
     auto& option_values = workspace.optionValues;
 
-    double dt = T / steps;
-    double u = std::exp(sigma * std::sqrt(dt));
-    double d = 1.0 / u;
-    double p = (std::exp((r-q) * dt) - d) / (u - d);
-    double discount = std::exp(-r * dt);
+    double dt = opt.T / steps;
+    double volT = opt.sigma * std::sqrt(opt.T);
+    double d1 = (std::log(opt.S / opt.K) + (opt.r - opt.q + 0.5 * opt.sigma * opt.sigma) * opt.T) / volT;
+    double d2 = d1 - volT;
+    double p = peizerPratt(d2, steps), pBar = peizerPratt(d1, steps);
+    double growth = std::exp((opt.r - opt.q) * dt);
+    double u = growth * pBar / p;
+    double d = (growth - p * u) / (1.0 - p);
+    double discount = std::exp(-opt.r * dt);
+    const double sign = opt.type == OptionType::Call ? 1.0 : -1.0;
+
+    //node (n, i) = S u^(n - i) d^i; stepping back divides by u as in the CRR tree, u * d just isn't 1 here
     for (int i = 0; i <= steps; i++) {
-        prices[i] = S * std::pow(u, steps - i) * std::pow(d, i);
-        if (type == OptionType::Call)
-            option_values[i] = std::max(prices[i] - K, 0.0);
-        else
-            option_values[i] = std::max(K - prices[i], 0.0);
+        prices[i] = opt.S * std::pow(u, steps - i) * std::pow(d, i);
+        option_values[i] = std::max(sign * (prices[i] - opt.K), 0.0);
     }
     for (int step = steps - 1; step >= 0; step--) {
         for (int i = 0; i <= step; i++) {
             prices[i] /= u;
             double continuation = discount * (p * option_values[i] + (1 - p) * option_values[i + 1]);
-            double exercise;
-            if (type == OptionType::Call)
-                exercise = std::max(prices[i] - K, 0.0);
-            else
-                exercise = std::max(K - prices[i], 0.0);
-            option_values[i] = std::max(continuation, exercise);
+            option_values[i] = std::max(continuation, sign * (prices[i] - opt.K));
         }
     }
     return option_values[0];
 }
 
-double BinomialTree::priceParameters(double S, double K, double r, double sigma, double T, double q,
-                                              OptionType type, int steps) {
-    std::vector<double> prices(steps + 1);
-    std::vector<double> option_values(steps + 1);
+double BinomialTree::priceLeisenReimer(const Option& opt, int steps) {
+    static thread_local BinomialWorkspace workspace(0);
+    return priceLeisenReimer(opt, steps, workspace);
+}
 
-    double dt = T / steps;
-    double u = std::exp(sigma * std::sqrt(dt));
-    double d = 1.0 / u;
-    double p = (std::exp((r-q) * dt) - d) / (u - d);
-    double discount = std::exp(-r * dt);
+double BinomialTree::priceDividends(const Option& opt, const std::vector<CashDividend>& dividends, int steps,
+                                    BinomialWorkspace& workspace) {
+    if (workspace.prices.size() < static_cast<size_t>(steps) + 1) workspace.resize(steps);
+    auto& prices = workspace.prices;
+    auto& option_values = workspace.optionValues;
+
+    //dividends paid before expiry; the escrowed part of spot is riskless, only S* diffuses
+    size_t paid = std::upper_bound(dividends.begin(), dividends.end(), opt.T,
+                                   [](double t, const CashDividend& d) { return t < d.time; }) - dividends.begin();
+    double pv = 0.0;
+    for (size_t j = 0; j < paid; ++j)
+        if (dividends[j].time > 0.0) pv += dividends[j].amount * std::exp(-opt.r * dividends[j].time);
+    const double sStar = std::max(opt.S - pv, 1e-12 * opt.S);
+
+    const double dt = opt.T / steps;
+    const double u = std::exp(opt.sigma * std::sqrt(dt));
+    const double d = 1.0 / u;
+    const double p = (std::exp((opt.r - opt.q) * dt) - d) / (u - d);
+    const double discount = std::exp(-opt.r * dt);
+    const double sign = opt.type == OptionType::Call ? 1.0 : -1.0;
+    const double K = opt.K;
+    const bool american = opt.style == OptionStyle::American;
+
+    //every dividend is paid by expiry, so the terminal payoff is on S* alone
     for (int i = 0; i <= steps; i++) {
-        prices[i] = S * std::pow(u, steps - i) * std::pow(d, i);
-        if (type == OptionType::Call)
-            option_values[i] = std::max(prices[i] - K, 0.0);
-        else
-            option_values[i] = std::max(K - prices[i], 0.0);
+        prices[i] = sStar * std::pow(u, steps - i) * std::pow(d, i);
+        option_values[i] = std::max(sign * (prices[i] - K), 0.0);
     }
+
+    //escrow(t) = PV at t of dividends in (t, T]; rolled back one step at a time, adding dividends as they're passed
+    double escrow = 0.0;
+    size_t next = paid;
     for (int step = steps - 1; step >= 0; step--) {
+        const double t = step * dt;
+        escrow *= discount;
+        for (; next > 0 && dividends[next - 1].time > t; --next)
+            escrow += dividends[next - 1].amount * std::exp(-opt.r * (dividends[next - 1].time - t));
+        const double never = american ? 0.0 : -INFINITY; // european: exercise value never wins
+
+        double* S = prices.data();
+        double* V = option_values.data();
+        #pragma omp simd
         for (int i = 0; i <= step; i++) {
-            prices[i] /= u;
-            double continuation = discount * (p * option_values[i] + (1 - p) * option_values[i + 1]);
-            double exercise;
-            if (type == OptionType::Call)
-                exercise = std::max(prices[i] - K, 0.0);
-            else
-                exercise = std::max(K - prices[i], 0.0);
-            option_values[i] = std::max(continuation, exercise);
+            S[i] /= u;
+            double continuation = discount * (p * V[i] + (1 - p) * V[i + 1]);
+            double exercise = std::max(sign * (S[i] + escrow - K), 0.0) + never;
+            V[i] = std::max(continuation, exercise);
         }
     }
     return option_values[0];
 }
 
+double BinomialTree::priceDividends(const Option& opt, const std::vector<CashDividend>& dividends, int steps) {
+    static thread_local BinomialWorkspace workspace(0);
+    return priceDividends(opt, dividends, steps, workspace);
+}
+
 Greeks BinomialTree::computeGreeks(const Option& opt, BinomialWorkspace& workspace, int steps,
                                           double dS, double dT,
                                           double dSigma, double dR) {
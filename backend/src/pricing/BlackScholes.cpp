@@ -17,15 +17,6 @@ double BlackScholes::price(const Option& opt){
     else
         return normCDF(-d2)*opt.K*exp(-opt.r*opt.T)-normCDF(-d1)*opt.S * std::exp(-opt.q*opt.T);
 }
-double BlackScholes::priceParameter(double S, double K, double r, double sigma, double T, double q, OptionType type){
-    double d1 = (std::log(S/K)+(r+sigma*sigma/2)*T)/(sigma*std::sqrt(T));
-    double d2 = d1-sigma*std::sqrt(T);
-
-    if(type == OptionType::Call)
-        return std::exp(-q * T)* normCDF(d1)*S-normCDF(d2)*K*exp(-r*T);
-    else
-        return normCDF(-d2)*K*exp(-r*T)-std::exp(-q * T)*normCDF(-d1)*S;
-}
 
 double BlackScholes::delta(const Option& opt) {
     double d1 = (std::log(opt.S / opt.K) + (opt.r - opt.q + 0.5 * opt.sigma * opt.sigma) * opt.T) / (opt.sigma * sqrt(opt.T));
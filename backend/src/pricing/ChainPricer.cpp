@@ -0,0 +1,84 @@
+#include "pricing/ChainPricer.h"
+#include "pricing/BAW.h"
+#include "pricing/BinomialTree.h"
+#include "shared/MathUtils.h"
+#include <cmath>
+#include <omp.h>
+
+namespace {
+    // every row of the group as european; american rows are overwritten afterwards
+    void priceEuropeanGroup(const OptionBatchView& batch, const ChainGroup& g, double* out) {
+        const double sqrtT = std::sqrt(g.T);
+        const double discount = std::exp(-g.r * g.T);
+        const double prepaid = g.S * std::exp(-g.q * g.T);
+        const double logForward = std::log(g.S) + (g.r - g.q) * g.T;
+        const double *K = batch.K + g.first, *sigma = batch.sigma + g.first;
+        const uint64_t* put = batch.type.data() + g.first;
+        double* o = out + g.first;
+
+        #pragma omp simd
+        for (size_t j = 0; j < g.count; ++j) {
+            double volSqrtT = sigma[j] * sqrtT;
+            double d1 = (logForward - std::log(K[j]) + 0.5 * volSqrtT * volSqrtT) / volSqrtT;
+            double d2 = d1 - volSqrtT;
+            double discountedK = K[j] * discount;
+            double call = prepaid * normCDF(d1) - discountedK * normCDF(d2);
+            double putValue = discountedK * normCDF(-d2) - prepaid * normCDF(-d1);
+            o[j] = put[j] ? putValue : call;
+        }
+    }
+}
+
+void ChainPricer::priceBatch(const OptionChain& chain, double* out, int steps) {
+    const OptionBatchView batch = chain.view();
+    const std::vector<ChainGroup>& groups = chain.groups();
+    const size_t numGroups = groups.size();
+
+    #pragma omp parallel for schedule(dynamic, 1) default(none) shared(batch, groups, out, steps, numGroups)
+    for (size_t gi = 0; gi < numGroups; ++gi) {
+        const ChainGroup& g = groups[gi];
+        priceEuropeanGroup(batch, g, out);
+        for (size_t i = g.first; i < g.first + g.count; ++i)
+            if (batch.style[i] == OptionStyle::American)
+                out[i] = BAW::priceParameters(g.S, batch.K[i], g.r, batch.sigma[i], g.T, g.q, batch.type[i], steps);
+    }
+}
+
+void ChainPricer::priceBatchBinomial(const OptionChain& chain, double* out, int steps) {
+    const OptionBatchView batch = chain.view();
+    const std::vector<ChainGroup>& groups = chain.groups();
+    const size_t numGroups = groups.size();
+
+    #pragma omp parallel default(none) shared(batch, groups, out, steps, numGroups)
+    {
+        BinomialWorkspace workspace(steps);
+        BinomialLattice lattice;
+        std::vector<OptionType> types;
+    #pragma omp for schedule(dynamic, 1)
+        for (size_t gi = 0; gi < numGroups; ++gi) {
+            const ChainGroup& g = groups[gi];
+            priceEuropeanGroup(batch, g, out);
+            //american rows come after european ones and are sorted by sigma: each run of one vol is a smile
+            //priced on one lattice, all strikes stepped together
+            const size_t end = g.first + g.count;
+            for (size_t i = g.first; i < end;) {
+                if (batch.style[i] != OptionStyle::American) { ++i; continue; }
+                size_t run = i;
+                while (run < end && batch.sigma[run] == batch.sigma[i]) ++run;
+                lattice.build(g.S, g.r, batch.sigma[i], g.T, g.q, steps);
+                types.resize(run - i);
+                for (size_t j = i; j < run; ++j) types[j - i] = batch.type[j];
+                BinomialTree::priceStrikes(lattice, batch.K + i, types.data(), run - i, out + i, workspace);
+                i = run;
+            }
+        }
+    }
+}
+
+std::vector<double> ChainPricer::priceBatch(const OptionBatch& batch, int steps) {
+    OptionChain chain(batch.view());
+    std::vector<double> chainOrdered(batch.size()), prices(batch.size());
+    priceBatch(chain, chainOrdered.data(), steps);
+    chain.scatter(chainOrdered.data(), prices.data());
+    return prices;
+}
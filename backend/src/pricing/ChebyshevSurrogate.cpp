@@ -0,0 +1,384 @@
+#include "pricing/ChebyshevSurrogate.h"
+#include "pricing/BinomialTree.h"
+#include "pricing/BAW.h"
+#include "shared/MathUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <omp.h>
+
+static constexpr int MAX_DEGREE = 64;
+static constexpr char MAGIC[8] = {'C', 'H', 'E', 'B', 'S', 'U', 'R', 'R'};
+static constexpr uint32_t VERSION = 2; // 2: trust flags after the coefs
+// validation points per trust cell, as fractions of the cell along each dim: both corners, then {1/4, 3/4}^4
+static constexpr int CELL_POINTS = 18;
+static double cellPoint(int point, int d) {
+    if (point < 2) return point;
+    return ((point - 2) >> d) & 1 ? 0.75 : 0.25;
+}
+static constexpr double SAFETY = 1.5; // headroom over the worst validated error, few points per cell
+
+// black-scholes w/ K = 1, T = 1 in normalized inputs
+static double europeanUnit(double x, double v, double a, double b, OptionType type) {
+    double d1 = (x + a - b + 0.5 * v * v) / v;
+    double d2 = d1 - v;
+    if (type == OptionType::Call)
+        return std::exp(x - b) * normCDF(d1) - std::exp(-a) * normCDF(d2);
+    return std::exp(-a) * normCDF(-d2) - std::exp(x - b) * normCDF(-d1);
+}
+
+static double toUnit(double value, double lo, double hi) {
+    return (2.0 * value - (lo + hi)) / (hi - lo);
+}
+
+// untrusted cells: the same smoothed (steps, steps+1) tree the table is sampled from, ~4e-5 per unit strike at 500
+// steps and cheaper than one 1000-step tree, which oscillates by more than the budget on its own
+static double treePrice(double S, double K, double r, double sigma, double T, double q, OptionType type,
+                        BinomialWorkspace& workspace) {
+    constexpr int steps = ChebyshevSurrogate::TREE_STEPS;
+    return 0.5 * (BinomialTree::priceParametersWorkspace(S, K, r, sigma, T, q, type, steps, workspace) +
+                  BinomialTree::priceParametersWorkspace(S, K, r, sigma, T, q, type, steps + 1, workspace));
+}
+
+// in place DCT along one axis: node values -> chebyshev coefficients
+static void transformAxis(std::vector<double>& data, const int* sizes, int axis) {
+    int n = sizes[axis];
+    size_t stride = 1;
+    for (int d = 0; d < axis; ++d) stride *= sizes[d];
+    size_t lines = data.size() / n;
+
+    std::vector<double> line(n), out(n);
+    for (size_t l = 0; l < lines; ++l) {
+        size_t base = (l / stride) * stride * n + (l % stride);
+        for (int m = 0; m < n; ++m) line[m] = data[base + m * stride];
+        for (int k = 0; k < n; ++k) {
+            double sum = 0.0;
+            for (int m = 0; m < n; ++m) sum += line[m] * std::cos(M_PI * k * (m + 0.5) / n);
+            out[k] = (k == 0 ? 1.0 : 2.0) * sum / n;
+        }
+        for (int k = 0; k < n; ++k) data[base + k * stride] = out[k];
+    }
+}
+
+void ChebyshevSurrogate::build(const int (&degrees)[DIMS], const Domain& domain, int steps) {
+    std::copy(degrees, degrees + DIMS, degrees_);
+    domain_ = domain;
+    for (int d = 0; d < DIMS; ++d) degrees_[d] = std::clamp(degrees_[d], 1, MAX_DEGREE);
+
+    // chebyshev nodes (first kind) mapped into the domain
+    std::vector<double> nodes[DIMS];
+    for (int d = 0; d < DIMS; ++d) {
+        nodes[d].resize(degrees_[d]);
+        for (int m = 0; m < degrees_[d]; ++m) {
+            double t = std::cos(M_PI * (m + 0.5) / degrees_[d]);
+            nodes[d][m] = 0.5 * (domain_.lo[d] + domain_.hi[d]) + 0.5 * (domain_.hi[d] - domain_.lo[d]) * t;
+        }
+    }
+
+    size_t total = static_cast<size_t>(degrees_[0]) * degrees_[1] * degrees_[2] * degrees_[3];
+    for (int t = 0; t < 2; ++t) {
+        OptionType type = t == 0 ? OptionType::Call : OptionType::Put;
+        std::vector<double>& values = coefs_[t];
+        values.assign(total, 0.0);
+
+        #pragma omp parallel default(none) shared(values, nodes, total, type, steps)
+        {
+            BinomialWorkspace workspace(steps + 1);
+            #pragma omp for schedule(dynamic, 8)
+            for (size_t idx = 0; idx < total; ++idx) {
+                size_t rest = idx;
+                int i = rest % degrees_[0]; rest /= degrees_[0];
+                int j = rest % degrees_[1]; rest /= degrees_[1];
+                int k = rest % degrees_[2]; rest /= degrees_[2];
+                int l = static_cast<int>(rest);
+                double x = nodes[0][i], v = nodes[1][j], a = nodes[2][k], b = nodes[3][l];
+                double S = std::exp(x);
+                double amer = 0.5 * (
+                        BinomialTree::priceParametersWorkspace(S, 1.0, a, v, 1.0, b, type, steps, workspace) +
+                        BinomialTree::priceParametersWorkspace(S, 1.0, a, v, 1.0, b, type, steps + 1, workspace));
+                values[idx] = amer - europeanUnit(x, v, a, b, type);
+            }
+        }
+        for (int d = 0; d < DIMS; ++d) transformAxis(values, degrees_, d);
+    }
+    validate(steps);
+}
+
+int ChebyshevSurrogate::cellOf(double x, double v, double a, double b) const {
+    const double in[DIMS] = {x, v, a, b};
+    int cell = 0;
+    for (int d = DIMS - 1; d >= 0; --d) {
+        int c = static_cast<int>((in[d] - domain_.lo[d]) / (domain_.hi[d] - domain_.lo[d]) * TRUST_CELLS[d]);
+        cell = cell * TRUST_CELLS[d] + std::clamp(c, 0, TRUST_CELLS[d] - 1);
+    }
+    return cell;
+}
+
+double ChebyshevSurrogate::unitPrice(double x, double v, double a, double b, OptionType type) const {
+    double premium;
+    evaluateLanes(&x, &v, &a, &b, type, 1, &premium);
+    double intrinsic = type == OptionType::Call ? std::exp(x) - 1.0 : 1.0 - std::exp(x);
+    return std::max(europeanUnit(x, v, a, b, type) + premium, std::max(intrinsic, 0.0));
+}
+
+// every cell of both tables against the tree they were sampled from. the table's own error gets half the budget (with
+// headroom), the other half is left for that tree's error against the true price (~4e-5 at 500 steps)
+void ChebyshevSurrogate::validate(int steps) {
+    std::vector<uint8_t> trust(2 * NUM_CELLS);
+
+    #pragma omp parallel default(none) shared(trust, steps)
+    {
+        BinomialWorkspace workspace(steps + 1);
+        #pragma omp for schedule(dynamic)
+        for (int job = 0; job < 2 * NUM_CELLS; ++job) {
+            OptionType type = job < NUM_CELLS ? OptionType::Call : OptionType::Put;
+            int rest = job % NUM_CELLS, index[DIMS];
+            for (int d = 0; d < DIMS; ++d) {
+                index[d] = rest % TRUST_CELLS[d];
+                rest /= TRUST_CELLS[d];
+            }
+            double worst = 0.0;
+            for (int point = 0; point < CELL_POINTS; ++point) {
+                double in[DIMS];
+                for (int d = 0; d < DIMS; ++d)
+                    in[d] = domain_.lo[d] + (index[d] + cellPoint(point, d)) * (domain_.hi[d] - domain_.lo[d]) / TRUST_CELLS[d];
+                double S = std::exp(in[0]);
+                double sampled = 0.5 * (
+                        BinomialTree::priceParametersWorkspace(S, 1.0, in[2], in[1], 1.0, in[3], type, steps, workspace) +
+                        BinomialTree::priceParametersWorkspace(S, 1.0, in[2], in[1], 1.0, in[3], type, steps + 1, workspace));
+                worst = std::max(worst, std::abs(unitPrice(in[0], in[1], in[2], in[3], type) - sampled));
+            }
+            trust[job] = worst * SAFETY <= 0.5 * MAX_ERROR;
+        }
+    }
+    trust_[0].assign(trust.begin(), trust.begin() + NUM_CELLS);
+    trust_[1].assign(trust.begin() + NUM_CELLS, trust.end());
+}
+
+bool ChebyshevSurrogate::inDomain(double S, double K, double r, double sigma, double T, double q) const {
+    double in[DIMS] = {std::log(S / K), sigma * std::sqrt(T), r * T, q * T};
+    for (int d = 0; d < DIMS; ++d)
+        if (in[d] < domain_.lo[d] || in[d] > domain_.hi[d]) return false;
+    return true;
+}
+
+bool ChebyshevSurrogate::trusted(double S, double K, double r, double sigma, double T, double q, OptionType type) const {
+    if (empty() || !inDomain(S, K, r, sigma, T, q)) return false;
+    return trust_[type == OptionType::Call ? 0 : 1][cellOf(std::log(S / K), sigma * std::sqrt(T), r * T, q * T)] != 0;
+}
+
+double ChebyshevSurrogate::trustedFraction() const {
+    if (empty()) return 0.0;
+    size_t covered = std::count(trust_[0].begin(), trust_[0].end(), 1) + std::count(trust_[1].begin(), trust_[1].end(), 1);
+    return static_cast<double>(covered) / (2 * NUM_CELLS);
+}
+
+// premium for up to LANES options of one type; every loop runs across lanes so it vectorizes
+void ChebyshevSurrogate::evaluateLanes(const double* x, const double* v, const double* a, const double* b,
+                                       OptionType type, int lanes, double* premium) const {
+    alignas(64) double basis[DIMS][MAX_DEGREE][LANES];
+    const double* inputs[DIMS] = {x, v, a, b};
+    for (int d = 0; d < DIMS; ++d) {
+        #pragma omp simd
+        for (int w = 0; w < LANES; ++w) {
+            double t = w < lanes ? toUnit(inputs[d][w], domain_.lo[d], domain_.hi[d]) : 0.0;
+            basis[d][0][w] = 1.0;
+            basis[d][1][w] = t;
+        }
+        for (int k = 2; k < degrees_[d]; ++k) {
+            #pragma omp simd
+            for (int w = 0; w < LANES; ++w)
+                basis[d][k][w] = 2.0 * basis[d][1][w] * basis[d][k - 1][w] - basis[d][k - 2][w];
+        }
+    }
+
+    const double* c = coefs_[type == OptionType::Call ? 0 : 1].data();
+    alignas(64) double acc[LANES] = {};
+    alignas(64) double outer[LANES], inner[LANES];
+    for (int l = 0; l < degrees_[3]; ++l) {
+        for (int k = 0; k < degrees_[2]; ++k) {
+            #pragma omp simd
+            for (int w = 0; w < LANES; ++w) outer[w] = basis[3][l][w] * basis[2][k][w];
+            for (int j = 0; j < degrees_[1]; ++j) {
+                #pragma omp simd
+                for (int w = 0; w < LANES; ++w) inner[w] = outer[w] * basis[1][j][w];
+                for (int i = 0; i < degrees_[0]; ++i, ++c) {
+                    double coef = *c;
+                    #pragma omp simd
+                    for (int w = 0; w < LANES; ++w) acc[w] += coef * basis[0][i][w] * inner[w];
+                }
+            }
+        }
+    }
+    for (int w = 0; w < lanes; ++w) premium[w] = acc[w];
+}
+
+double ChebyshevSurrogate::price(double S, double K, double r, double sigma, double T, double q, OptionType type) const {
+    if (empty() || !inDomain(S, K, r, sigma, T, q))
+        return BAW::priceParameters(S, K, r, sigma, T, q, type);
+    double x = std::log(S / K), v = sigma * std::sqrt(T), a = r * T, b = q * T;
+    if (!trust_[type == OptionType::Call ? 0 : 1][cellOf(x, v, a, b)])
+        return treePrice(S, K, r, sigma, T, q, type, BinomialTree::threadWorkspace(TREE_STEPS + 1));
+    return K * unitPrice(x, v, a, b, type);
+}
+
+void ChebyshevSurrogate::priceBatch(const OptionBatch& batch, double* out) const {
+    priceBatch(batch.view(), out);
+}
+
+void ChebyshevSurrogate::priceBatch(const OptionBatchView& batch, double* out) const {
+    constexpr size_t CHUNK = 1024;
+    size_t N = batch.size();
+    size_t chunks = (N + CHUNK - 1) / CHUNK;
+
+    #pragma omp parallel for schedule(dynamic) default(none) shared(batch, out, N, chunks)
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        // gather trusted rows per type into lane blocks; out-of-domain ones go straight to BAW, untrusted to the tree
+        BinomialWorkspace& workspace = BinomialTree::threadWorkspace(TREE_STEPS + 1);
+        alignas(64) double x[2][LANES], v[2][LANES], a[2][LANES], b[2][LANES], premium[LANES];
+        size_t rows[2][LANES];
+        int pending[2] = {0, 0};
+
+        auto flush = [&](int t) {
+            OptionType type = t == 0 ? OptionType::Call : OptionType::Put;
+            evaluateLanes(x[t], v[t], a[t], b[t], type, pending[t], premium);
+            for (int w = 0; w < pending[t]; ++w) {
+                size_t i = rows[t][w];
+                double intrinsic = type == OptionType::Call ? batch.S[i] - batch.K[i] : batch.K[i] - batch.S[i];
+                double euro = europeanUnit(x[t][w], v[t][w], a[t][w], b[t][w], type);
+                out[i] = std::max(batch.K[i] * (euro + premium[w]), std::max(intrinsic, 0.0));
+            }
+            pending[t] = 0;
+        };
+
+        size_t end = std::min(N, (chunk + 1) * CHUNK);
+        for (size_t i = chunk * CHUNK; i < end; ++i) {
+            if (batch.style[i] == OptionStyle::European) continue;
+            if (empty() || !inDomain(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i])) {
+                out[i] = BAW::priceParameters(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i]);
+                continue;
+            }
+            int t = batch.type[i] == OptionType::Call ? 0 : 1;
+            double xi = std::log(batch.S[i] / batch.K[i]), vi = batch.sigma[i] * std::sqrt(batch.T[i]);
+            double ai = batch.r[i] * batch.T[i], bi = batch.q[i] * batch.T[i];
+            if (!trust_[t][cellOf(xi, vi, ai, bi)]) {
+                out[i] = treePrice(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i],
+                                   workspace);
+                continue;
+            }
+            int w = pending[t]++;
+            rows[t][w] = i;
+            x[t][w] = xi;
+            v[t][w] = vi;
+            a[t][w] = ai;
+            b[t][w] = bi;
+            if (pending[t] == LANES) flush(t);
+        }
+        for (int t = 0; t < 2; ++t)
+            if (pending[t] > 0) flush(t);
+    }
+}
+
+ChebyshevSurrogate::ErrorReport ChebyshevSurrogate::checkAgainstBinomial(const std::vector<Option>& options, int steps,
+                                                                        double budget) const {
+    ErrorReport report;
+    report.count = options.size();
+    report.budget = budget;
+    double maxErr = 0.0, sumSq = 0.0;
+    size_t outside = 0, onTree = 0;
+
+    #pragma omp parallel default(none) shared(options, steps) reduction(max:maxErr) reduction(+:sumSq, outside, onTree)
+    {
+        BinomialWorkspace workspace(steps + 1);
+        #pragma omp for schedule(dynamic, 16)
+        for (size_t i = 0; i < options.size(); ++i) {
+            const Option& o = options[i];
+            if (!inDomain(o.S, o.K, o.r, o.sigma, o.T, o.q)) {
+                ++outside;
+                continue;
+            }
+            if (!trusted(o.S, o.K, o.r, o.sigma, o.T, o.q, o.type)) ++onTree;
+            // averaging adjacent step counts cancels most of the CRR odd/even oscillation
+            double ref = 0.5 * (BinomialTree::priceWorkspace(o, steps, workspace) +
+                                BinomialTree::priceWorkspace(o, steps + 1, workspace));
+            double err = std::abs(price(o.S, o.K, o.r, o.sigma, o.T, o.q, o.type) - ref) / o.K;
+            maxErr = std::max(maxErr, err);
+            sumSq += err * err;
+        }
+    }
+    report.outOfDomain = outside;
+    report.onTree = onTree;
+    report.maxAbsPerStrike = maxErr;
+    size_t inside = options.size() - outside;
+    report.rmsPerStrike = inside == 0 ? 0.0 : std::sqrt(sumSq / inside);
+    return report;
+}
+
+// layout: magic, version, degrees, domain lo/hi, call coefs, put coefs, call trust flags, put trust flags.
+// written to path.tmp and renamed over path, so an empty surrogate or a failed write never clobbers an existing file
+bool ChebyshevSurrogate::save(const std::string& path) const {
+    if (empty()) return false;
+    const std::string tmp = path + ".tmp";
+    std::ofstream out(tmp, std::ios::binary);
+    if (!out.is_open()) return false;
+    int32_t degrees[DIMS];
+    std::copy(degrees_, degrees_ + DIMS, degrees);
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    out.write(reinterpret_cast<const char*>(degrees), sizeof(degrees));
+    out.write(reinterpret_cast<const char*>(domain_.lo), sizeof(domain_.lo));
+    out.write(reinterpret_cast<const char*>(domain_.hi), sizeof(domain_.hi));
+    for (const auto& c : coefs_)
+        out.write(reinterpret_cast<const char*>(c.data()), static_cast<std::streamsize>(c.size() * sizeof(double)));
+    for (const auto& t : trust_)
+        out.write(reinterpret_cast<const char*>(t.data()), static_cast<std::streamsize>(t.size()));
+    out.close();
+    if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ChebyshevSurrogate::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    char magic[sizeof(MAGIC)];
+    uint32_t version = 0;
+    int32_t degrees[DIMS];
+    Domain domain;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(degrees), sizeof(degrees));
+    in.read(reinterpret_cast<char*>(domain.lo), sizeof(domain.lo));
+    in.read(reinterpret_cast<char*>(domain.hi), sizeof(domain.hi));
+    if (!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) return false;
+
+    size_t total = 1;
+    for (int d = 0; d < DIMS; ++d) {
+        if (degrees[d] < 1 || degrees[d] > MAX_DEGREE) return false;
+        total *= degrees[d];
+    }
+    std::vector<double> coefs[2];
+    for (auto& c : coefs) {
+        c.resize(total);
+        in.read(reinterpret_cast<char*>(c.data()), static_cast<std::streamsize>(total * sizeof(double)));
+    }
+    std::vector<uint8_t> trust[2];
+    for (auto& t : trust) {
+        t.resize(NUM_CELLS);
+        in.read(reinterpret_cast<char*>(t.data()), NUM_CELLS);
+    }
+    if (!in) return false;
+
+    std::copy(degrees, degrees + DIMS, degrees_);
+    domain_ = domain;
+    coefs_[0] = std::move(coefs[0]);
+    coefs_[1] = std::move(coefs[1]);
+    trust_[0] = std::move(trust[0]);
+    trust_[1] = std::move(trust[1]);
+    return true;
+}
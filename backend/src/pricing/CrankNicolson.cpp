@@ -0,0 +1,192 @@
+#include "pricing/CrankNicolson.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <omp.h>
+
+namespace {
+    constexpr size_t L = PDEWorkspace::LANES;
+    constexpr double NO_FLOOR = -1e300; // european lanes: projection never binds
+    constexpr int RANNACHER_STEPS = 4;  // implicit half steps replacing the first two crank-nicolson steps
+
+    // payoff averaged over the cell around y (log spot relative to S, cell width dx) when the strike falls inside
+    // it; pointwise otherwise. keeps an off-node strike from biasing the start value
+    double startValue(double S, double K, double y, double dx, bool put) {
+        double lo = y - 0.5 * dx, hi = y + 0.5 * dx, yK = std::log(K / S);
+        if (yK <= lo || yK >= hi) return std::max(put ? K - S * std::exp(y) : S * std::exp(y) - K, 0.0);
+        if (put) return (K * (yK - lo) - (K - S * std::exp(lo))) / dx;
+        return (S * std::exp(hi) - K - K * (hi - yK)) / dx;
+    }
+
+    // the elimination needs interior nodes on both sides of spot; fewer space steps would wrap the size_t indices
+    void checkGrid(const PDEGrid& grid) {
+        if (grid.spaceSteps < 4) throw std::invalid_argument("PDEGrid needs spaceSteps >= 4");
+        if (grid.timeSteps < 1) throw std::invalid_argument("PDEGrid needs timeSteps >= 1");
+        if (!(grid.width > 0.0)) throw std::invalid_argument("PDEGrid needs width > 0");
+    }
+}
+
+void CrankNicolson::priceLanes(const OptionBatchView& batch, size_t first, size_t count, const PDEGrid& grid,
+                               PDEWorkspace& workspace, const GreekColumns& out) {
+    checkGrid(grid);
+    if (count == 0) return;
+    const int steps = grid.spaceSteps + (grid.spaceSteps & 1);
+    const size_t M = static_cast<size_t>(steps) + 1, mid = static_cast<size_t>(steps / 2);
+    const int N = std::max(grid.timeSteps, 2);
+    if (workspace.nodes != M) workspace.resize(M);
+    double* V = workspace.value.data();
+    double* rhs = workspace.rhs.data();
+    double* intrinsic = workspace.intrinsic.data();
+    double* floor = workspace.floor.data();
+
+    // lane constants; spare lanes repeat the last row so every lane does valid arithmetic
+    alignas(64) double S[L], K[L], r[L], q[L], T[L], sgn[L], dx[L], lowS[L];
+    alignas(64) double alpha[L], beta[L], gamma[L];
+    bool american[L];
+    for (size_t l = 0; l < L; ++l) {
+        size_t i = first + std::min(l, count - 1);
+        S[l] = batch.S[i]; K[l] = batch.K[i]; r[l] = batch.r[i]; q[l] = batch.q[i]; T[l] = batch.T[i];
+        double sigma = batch.sigma[i];
+        bool put = batch.type[i] == OptionType::Put;
+        american[l] = batch.style[i] == OptionStyle::American;
+        sgn[l] = put ? 1.0 : -1.0; // calls run on the reflected grid: node index grows as spot falls
+        double volT = std::max(sigma * std::sqrt(T[l]), 1e-8);
+        double half = std::max(grid.width * volT, std::abs(std::log(K[l] / S[l])) + 0.5 * grid.width * volT);
+        dx[l] = 2.0 * half / steps;
+        double mu = sgn[l] * (r[l] - q[l] - 0.5 * sigma * sigma);
+        double diffusion = 0.5 * sigma * sigma / (dx[l] * dx[l]), convection = 0.5 * mu / dx[l];
+        alpha[l] = diffusion - convection;
+        gamma[l] = diffusion + convection;
+        beta[l] = -2.0 * diffusion - r[l];
+        lowS[l] = S[l] * std::exp(-sgn[l] * mid * dx[l]);
+        for (size_t j = 0; j < M; ++j) {
+            double y = sgn[l] * (static_cast<double>(j) - static_cast<double>(mid)) * dx[l];
+            double Sj = S[l] * std::exp(y);
+            double exercise = put ? K[l] - Sj : Sj - K[l];
+            intrinsic[j * L + l] = exercise;
+            floor[j * L + l] = american[l] ? exercise : NO_FLOOR;
+            V[j * L + l] = startValue(S[l], K[l], y, dx[l], put);
+        }
+    }
+
+    // theta scheme: (I - theta h A) V_new = (I + (1 - theta) h A) V_old. the implicit matrix is fixed per phase,
+    // so the elimination (from the top node down) is factored once and only replayed on the right hand side
+    alignas(64) double a[PDEWorkspace::PHASES][L], c[PDEWorkspace::PHASES][L];
+    alignas(64) double ea[PDEWorkspace::PHASES][L], eb[PDEWorkspace::PHASES][L], ec[PDEWorkspace::PHASES][L];
+    alignas(64) double h[PDEWorkspace::PHASES][L];
+    for (int p = 0; p < PDEWorkspace::PHASES; ++p) {
+        const double theta = p == 0 ? 1.0 : 0.5;
+        double* invPivot = workspace.invPivot[p].data();
+        double* multiplier = workspace.multiplier[p].data();
+        double b[L];
+        for (size_t l = 0; l < L; ++l) {
+            h[p][l] = (p == 0 ? 0.5 : 1.0) * T[l] / N;
+            a[p][l] = -theta * h[p][l] * alpha[l];
+            b[l] = 1.0 - theta * h[p][l] * beta[l];
+            c[p][l] = -theta * h[p][l] * gamma[l];
+            ea[p][l] = (1.0 - theta) * h[p][l] * alpha[l];
+            eb[p][l] = 1.0 + (1.0 - theta) * h[p][l] * beta[l];
+            ec[p][l] = (1.0 - theta) * h[p][l] * gamma[l];
+            invPivot[(M - 2) * L + l] = 1.0 / b[l];
+            multiplier[(M - 2) * L + l] = 0.0;
+        }
+        for (size_t j = M - 3; j >= 1; --j) {
+            #pragma omp simd
+            for (size_t l = 0; l < L; ++l) {
+                double m = c[p][l] * invPivot[(j + 1) * L + l];
+                multiplier[j * L + l] = m;
+                invPivot[j * L + l] = 1.0 / (b[l] - m * a[p][l]);
+            }
+        }
+    }
+
+    alignas(64) double tau[L] = {}, previous[L] = {};
+    const int totalSteps = RANNACHER_STEPS + N - 2;
+    for (int step = 0; step < totalSteps; ++step) {
+        const int p = step < RANNACHER_STEPS ? 0 : 1;
+        const double* invPivot = workspace.invPivot[p].data();
+        const double* multiplier = workspace.multiplier[p].data();
+        const double *ap = a[p], *eap = ea[p], *ebp = eb[p], *ecp = ec[p];
+        if (step == totalSteps - 1)
+            for (size_t l = 0; l < L; ++l) previous[l] = V[mid * L + l];
+
+        for (size_t j = 1; j + 1 < M; ++j) {
+            #pragma omp simd
+            for (size_t l = 0; l < L; ++l)
+                rhs[j * L + l] = eap[l] * V[(j - 1) * L + l] + ebp[l] * V[j * L + l] + ecp[l] * V[(j + 1) * L + l];
+        }
+        // top node stays 0 (far out of the money), so nothing to move into rhs[M - 2]
+        for (size_t j = M - 3; j >= 1; --j) {
+            #pragma omp simd
+            for (size_t l = 0; l < L; ++l) rhs[j * L + l] -= multiplier[j * L + l] * rhs[(j + 1) * L + l];
+        }
+        for (size_t l = 0; l < L; ++l) {
+            tau[l] += h[p][l];
+            // deep in the money: intrinsic if american, discounted forward intrinsic if european
+            double forward = sgn[l] * (K[l] * std::exp(-r[l] * tau[l]) - lowS[l] * std::exp(-q[l] * tau[l]));
+            V[l] = american[l] ? intrinsic[l] : std::max(forward, 0.0);
+        }
+        //brennan-schwartz: back substitute from the exercise end, projecting onto the payoff as we go
+        for (size_t j = 1; j + 1 < M; ++j) {
+            #pragma omp simd
+            for (size_t l = 0; l < L; ++l) {
+                double v = (rhs[j * L + l] - ap[l] * V[(j - 1) * L + l]) * invPivot[j * L + l];
+                V[j * L + l] = std::max(v, floor[j * L + l]);
+            }
+        }
+    }
+
+    const int lastPhase = totalSteps > RANNACHER_STEPS ? 1 : 0;
+    for (size_t l = 0; l < count; ++l) {
+        size_t i = first + l;
+        double up = V[(mid + 1) * L + l], centre = V[mid * L + l], down = V[(mid - 1) * L + l];
+        double Vx = sgn[l] * (up - down) / (2.0 * dx[l]);
+        double Vxx = (up - 2.0 * centre + down) / (dx[l] * dx[l]);
+        if (out.price) out.price[i] = centre;
+        if (out.delta) out.delta[i] = Vx / S[l];
+        if (out.gamma) out.gamma[i] = (Vxx - Vx) / (S[l] * S[l]);
+        if (out.theta) out.theta[i] = (previous[l] - centre) / h[lastPhase][l];
+        if (out.vega) out.vega[i] = 0.0;
+        if (out.rho) out.rho[i] = 0.0;
+    }
+}
+
+GreekResult CrankNicolson::priceAndGreeks(const Option& opt, const PDEGrid& grid, PDEWorkspace& workspace) {
+    OptionBatch row;
+    row.push_back(opt);
+    GreekResult result;
+    GreekColumns out{&result.price, &result.greeks.delta, &result.greeks.gamma, &result.greeks.theta,
+                     &result.greeks.vega, &result.greeks.rho};
+    // fills the other lanes with copies of this row; the sweep costs the same either way
+    priceLanes(row.view(), 0, 1, grid, workspace, out);
+    return result;
+}
+
+double CrankNicolson::price(const Option& opt, const PDEGrid& grid) {
+    static thread_local PDEWorkspace workspace(0);
+    return priceAndGreeks(opt, grid, workspace).price;
+}
+
+void CrankNicolson::priceBatch(const OptionBatchView& batch, const GreekColumns& out, const PDEGrid& grid) {
+    checkGrid(grid); // here too: a throw from inside the parallel region would terminate
+    const size_t n = batch.size(), lanes = L, groups = (n + lanes - 1) / lanes;
+    #pragma omp parallel default(none) shared(batch, out, grid, n, lanes, groups)
+    {
+        PDEWorkspace workspace(0);
+    #pragma omp for schedule(dynamic, 4)
+        for (size_t g = 0; g < groups; ++g)
+            priceLanes(batch, g * lanes, std::min(lanes, n - g * lanes), grid, workspace, out);
+    }
+}
+
+void CrankNicolson::priceBatch(const OptionBatchView& batch, double* out, const PDEGrid& grid) {
+    GreekColumns columns;
+    columns.price = out;
+    priceBatch(batch, columns, grid);
+}
+
+std::vector<double> CrankNicolson::priceBatch(const OptionBatch& batch, const PDEGrid& grid) {
+    std::vector<double> prices(batch.size());
+    priceBatch(batch.view(), prices.data(), grid);
+    return prices;
+}
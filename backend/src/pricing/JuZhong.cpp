@@ -0,0 +1,91 @@
+#include "pricing/JuZhong.h"
+#include "pricing/BinomialTree.h"
+#include "shared/MathUtils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr int MAX_ITERATIONS = 100;
+    constexpr double TOLERANCE = 1e-6; // on the exercise boundary equation, per unit strike
+
+    //discounted black-scholes on the forward (d1 includes q)
+    double black(double forward, double K, double stdDev, double discount, double phi) {
+        double d1 = (std::log(forward / K) + 0.5 * stdDev * stdDev) / stdDev, d2 = d1 - stdDev;
+        return discount * phi * (forward * normCDF(phi * d1) - K * normCDF(phi * d2));
+    }
+
+    //BAW critical price: seed from the perpetual boundary, then the Barone-Adesi/Whaley fixed point iteration.
+    //-1 when it doesn't settle
+    double criticalPrice(double K, double stdDev, double riskFree, double dividend, double phi) {
+        const double variance = stdDev * stdDev;
+        const double n = 2.0 * std::log(dividend / riskFree) / variance;
+        const double m = -2.0 * std::log(riskFree) / variance;
+        const double bT = std::log(dividend / riskFree);
+        const double qu = (-(n - 1.0) + phi * std::sqrt((n - 1.0) * (n - 1.0) + 4.0 * m)) / 2.0;
+        const double Su = K / (1.0 - 1.0 / qu);
+        double Si;
+        if (phi > 0) {
+            double h = -(bT + 2.0 * stdDev) * K / (Su - K);
+            Si = K + (Su - K) * (1.0 - std::exp(h));
+        } else {
+            double h = (bT - 2.0 * stdDev) * K / (K - Su);
+            Si = Su + (K - Su) * std::exp(h);
+        }
+
+        const double kk = std::abs(1.0 - riskFree) > 1e-12 ? -2.0 * std::log(riskFree) / (variance * (1.0 - riskFree))
+                                                           : 2.0 / variance;
+        const double Q = (-(n - 1.0) + phi * std::sqrt((n - 1.0) * (n - 1.0) + 4.0 * kk)) / 2.0;
+        for (int it = 0; it < MAX_ITERATIONS; ++it) {
+            double forward = Si * dividend / riskFree;
+            double d1 = (std::log(forward / K) + 0.5 * variance) / stdDev;
+            double lhs = phi * (Si - K);
+            double rhs = black(forward, K, stdDev, riskFree, phi) + phi * (1.0 - dividend * normCDF(phi * d1)) * Si / Q;
+            if (std::abs(lhs - rhs) / K <= TOLERANCE) return Si;
+            double slope = phi * dividend * normCDF(phi * d1) * (1.0 - 1.0 / Q)
+                           + (phi - dividend * normPDF(d1) / stdDev) / Q;
+            Si = (phi * K + rhs - slope * Si) / (phi - slope);
+            if (!(Si > 0.0) || !std::isfinite(Si)) return -1.0;
+        }
+        return -1.0;
+    }
+}
+
+double JuZhong::price(const Option& opt, int steps) {
+    const double phi = opt.type == OptionType::Call ? 1.0 : -1.0;
+    if (opt.T <= 0.0) return std::max(phi * (opt.S - opt.K), 0.0);
+    const double stdDev = opt.sigma * std::sqrt(opt.T);
+    const double riskFree = std::exp(-opt.r * opt.T), dividend = std::exp(-opt.q * opt.T);
+    const double forward = opt.S * dividend / riskFree;
+    const double euro = black(forward, opt.K, stdDev, riskFree, phi);
+    //never worth exercising early: calls without a yield, puts without a positive rate
+    if ((phi > 0 && opt.q <= 0.0) || (phi < 0 && opt.r <= 0.0)) return euro;
+
+    const double Sk = criticalPrice(opt.K, stdDev, riskFree, dividend, phi);
+    if (Sk < 0.0) return BinomialTree::price(opt, steps);
+    if (phi * (Sk - opt.S) <= 0.0) return phi * (opt.S - opt.K);
+
+    const double variance = stdDev * stdDev;
+    const double forwardSk = Sk * dividend / riskFree;
+    const double alpha = -2.0 * std::log(riskFree) / variance;
+    const double beta = 2.0 * std::log(dividend / riskFree) / variance;
+    const double h = 1.0 - riskFree;
+    //alpha and h both go to 0 with r, so everything below is written in alpha / h (-> 2 / variance, the kk limit of
+    //criticalPrice) and alpha * lambda' instead of the raw ratios
+    const double alphaOverH = std::abs(h) > 1e-12 ? alpha / h : 2.0 / variance;
+    const double root = std::sqrt((beta - 1.0) * (beta - 1.0) + 4.0 * alphaOverH);
+    const double lambda = (-(beta - 1.0) + phi * root) / 2.0;
+    const double alphaLambdaPrime = -phi * alphaOverH * alphaOverH / root;
+
+    const double hA = phi * (Sk - opt.K) - black(forwardSk, opt.K, stdDev, riskFree, phi);
+    const double d1 = (std::log(forwardSk / opt.K) + 0.5 * variance) / stdDev, d2 = d1 - stdDev;
+    //alpha * dV_E/dh at the boundary
+    const double alphaVh = forwardSk * normPDF(d1) / stdDev
+                           + 2.0 * phi * forwardSk * normCDF(phi * d1) * std::log(dividend) / variance
+                           + alpha * phi * opt.K * normCDF(phi * d2);
+    const double denom = 2.0 * lambda + beta - 1.0;
+    const double b = (1.0 - h) * alphaLambdaPrime / (2.0 * denom);
+    const double c = -((1.0 - h) / denom) * (alphaVh / hA + alphaOverH + alphaLambdaPrime / denom);
+    const double x = std::log(opt.S / Sk);
+    const double chi = b * x * x + c * x;
+    return euro + hA * std::pow(opt.S / Sk, lambda) / (1.0 - chi);
+}
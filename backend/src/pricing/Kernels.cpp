@@ -0,0 +1,151 @@
+#include "pricing/Kernels.h"
+#include "pricing/BAW.h"
+#include "pricing/BinomialTree.h"
+#include "pricing/BlackScholes.h"
+#include <iterator>
+#include <utility>
+
+namespace {
+    template<typename Real>
+    inline void blackScholesBody(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out) {
+        const Real *Sc = batch.S + first, *Kc = batch.K + first, *rc = batch.r + first, *sigmac = batch.sigma + first;
+        const Real* Tc = batch.T + first;
+        const LaneMask<Real>* putMask = batch.type.data() + first;
+        Real* o = out + first;
+        //put mask selects the payoff branch-free; float: VecMath polynomials keep the loop vectorized
+        #pragma omp simd
+        for (size_t i = 0; i < count; i++) {
+            Real S = Sc[i], K = Kc[i], r = rc[i], sigma = sigmac[i], T = Tc[i];
+
+            Real d1 = (VecMath::log(S / K) + (r + Real(0.5) * sigma * sigma) * T) / (sigma * VecMath::sqrt(T));
+            Real d2 = d1 - sigma * VecMath::sqrt(T);
+            Real discountedK = K * VecMath::exp(-r * T);
+
+            Real call = normCDF(d1) * S - normCDF(d2) * discountedK;
+            Real put = normCDF(-d2) * discountedK - normCDF(-d1) * S;
+            o[i] = putMask[i] ? put : call;
+        }
+    }
+
+    template<typename Real>
+    inline void priceRowsBody(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out, int steps) {
+        for (size_t i = first; i < first + count; ++i) {
+            if (batch.style[i] == OptionStyle::European)
+                out[i] = BlackScholes::priceParameter(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i]);
+            else
+                out[i] = BAW::priceParameters(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], steps);
+        }
+    }
+
+    template<int STEPS, typename Real>
+    inline void fixedBinomialRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out) {
+        for (size_t i = first; i < first + count; ++i) {
+            if (batch.style[i] == OptionStyle::European)
+                out[i] = BlackScholes::priceParameter(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i]);
+            else if (batch.type[i] == OptionType::Call)
+                out[i] = BinomialTree::priceFixed<STEPS, OptionType::Call>(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i]);
+            else
+                out[i] = BinomialTree::priceFixed<STEPS, OptionType::Put>(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i]);
+        }
+    }
+
+    //fold over the table, so adding a step count there is all it takes to get an instantiation; false: no match
+    template<typename Real, size_t... I>
+    inline bool fixedBinomialDispatch(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out,
+                                      int steps, std::index_sequence<I...>) {
+        return ((steps == BinomialTree::FIXED_STEPS[I] &&
+                 (fixedBinomialRows<BinomialTree::FIXED_STEPS[I]>(batch, first, count, out), true)) || ...);
+    }
+
+    template<typename Real>
+    inline void binomialRowsBody(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out, int steps,
+                                 BasicBinomialWorkspace<Real>& workspace) {
+        //one instantiation per chunk when the step count is one of BinomialTree::FIXED_STEPS
+        if (fixedBinomialDispatch(batch, first, count, out, steps,
+                                  std::make_index_sequence<std::size(BinomialTree::FIXED_STEPS)>{}))
+            return;
+        for (size_t i = first; i < first + count; ++i) {
+            if (batch.style[i] == OptionStyle::European)
+                out[i] = BlackScholes::priceParameter(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i]);
+            else
+                out[i] = BinomialTree::priceParametersWorkspace(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], steps, workspace);
+        }
+    }
+
+    //one copy of every kernel per isa. flatten inlines the bodies' whole call tree (as far as it is visible) into
+    //the target function, so the inline helpers are compiled for that isa too; their out of line copies stay at
+    //the baseline flags, which keeps the one-definition rule intact
+#define OPTIONS_KERNEL_VARIANT(NS, ATTRIBUTES)                                                                        \
+    namespace NS {                                                                                                    \
+        template<typename Real>                                                                                       \
+        ATTRIBUTES void blackScholes(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out) {\
+            blackScholesBody(batch, first, count, out);                                                               \
+        }                                                                                                             \
+        template<typename Real>                                                                                       \
+        ATTRIBUTES void priceRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out,     \
+                                  int steps) {                                                                        \
+            priceRowsBody(batch, first, count, out, steps);                                                           \
+        }                                                                                                             \
+        template<typename Real>                                                                                       \
+        ATTRIBUTES void binomialRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out,  \
+                                     int steps, BasicBinomialWorkspace<Real>& workspace) {                            \
+            binomialRowsBody(batch, first, count, out, steps, workspace);                                             \
+        }                                                                                                             \
+    }
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    OPTIONS_KERNEL_VARIANT(baseline, __attribute__((flatten)))
+    OPTIONS_KERNEL_VARIANT(sse42, __attribute__((target("sse4.2,popcnt"), flatten)))
+    OPTIONS_KERNEL_VARIANT(avx2, __attribute__((target("avx2,fma,bmi,bmi2,popcnt"), flatten)))
+    OPTIONS_KERNEL_VARIANT(avx512, __attribute__((target("avx512f,avx512dq,avx512vl,avx512bw,avx2,fma,bmi,bmi2,popcnt,"
+                                                         "prefer-vector-width=512"), flatten)))
+#define OPTIONS_KERNEL_SET(fn) {&baseline::fn<Real>, &sse42::fn<Real>, &avx2::fn<Real>, &avx512::fn<Real>}
+#else
+    //no x86 multi-versioning: every level runs the build's own flags
+    OPTIONS_KERNEL_VARIANT(baseline, )
+#define OPTIONS_KERNEL_SET(fn) {&baseline::fn<Real>, &baseline::fn<Real>, &baseline::fn<Real>, &baseline::fn<Real>}
+#endif
+
+    constexpr int LEVELS = static_cast<int>(IsaLevel::COUNT);
+
+    template<typename Real>
+    struct KernelSet {
+        void (*blackScholes[LEVELS])(const BasicOptionBatchView<Real>&, size_t, size_t, Real*);
+        void (*priceRows[LEVELS])(const BasicOptionBatchView<Real>&, size_t, size_t, Real*, int);
+        void (*binomialRows[LEVELS])(const BasicOptionBatchView<Real>&, size_t, size_t, Real*, int, BasicBinomialWorkspace<Real>&);
+    };
+
+    template<typename Real>
+    const KernelSet<Real>& kernels() {
+        static const KernelSet<Real> set{OPTIONS_KERNEL_SET(blackScholes), OPTIONS_KERNEL_SET(priceRows),
+                                         OPTIONS_KERNEL_SET(binomialRows)};
+        return set;
+    }
+#undef OPTIONS_KERNEL_SET
+#undef OPTIONS_KERNEL_VARIANT
+
+    int level() { return static_cast<int>(CpuDispatch::active()); }
+}
+
+template<typename Real>
+void Kernels::blackScholes(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out) {
+    kernels<Real>().blackScholes[level()](batch, first, count, out);
+}
+
+template<typename Real>
+void Kernels::priceRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out, int steps) {
+    kernels<Real>().priceRows[level()](batch, first, count, out, steps);
+}
+
+template<typename Real>
+void Kernels::binomialRows(const BasicOptionBatchView<Real>& batch, size_t first, size_t count, Real* out, int steps,
+                           BasicBinomialWorkspace<Real>& workspace) {
+    kernels<Real>().binomialRows[level()](batch, first, count, out, steps, workspace);
+}
+
+template void Kernels::blackScholes(const OptionBatchView&, size_t, size_t, double*);
+template void Kernels::blackScholes(const OptionBatchViewF&, size_t, size_t, float*);
+template void Kernels::priceRows(const OptionBatchView&, size_t, size_t, double*, int);
+template void Kernels::priceRows(const OptionBatchViewF&, size_t, size_t, float*, int);
+template void Kernels::binomialRows(const OptionBatchView&, size_t, size_t, double*, int, BinomialWorkspace&);
+template void Kernels::binomialRows(const OptionBatchViewF&, size_t, size_t, float*, int, BinomialWorkspaceF&);
@@ -0,0 +1,320 @@
+#include "pricing/LongstaffSchwartz.h"
+#include "shared/MathUtils.h"
+#include "shared/Philox.h"
+#include "shared/Sobol.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <omp.h>
+
+namespace {
+    // Jäckel's brownian bridge over t_i = (i + 1) / dates: point 0 fixes the terminal value, every later point is
+    // interpolated between two already known neighbours (left = -1 means W(0) = 0)
+    struct BrownianBridge {
+        std::vector<int> index, left, right;
+        std::vector<double> leftWeight, rightWeight, stdDev;
+
+        explicit BrownianBridge(int n) : index(n), left(n), right(n), leftWeight(n), rightWeight(n), stdDev(n) {
+            std::vector<double> t(n);
+            for (int i = 0; i < n; ++i) t[i] = static_cast<double>(i + 1) / n;
+            std::vector<int> placed(n, 0);
+            placed[n - 1] = 1;
+            index[0] = n - 1;
+            left[0] = right[0] = -1;
+            leftWeight[0] = rightWeight[0] = 0.0;
+            stdDev[0] = std::sqrt(t[n - 1]);
+            for (int i = 1, j = 0; i < n; ++i) {
+                while (placed[j]) ++j;
+                int k = j;
+                while (!placed[k]) ++k;
+                int l = j + ((k - 1 - j) >> 1);
+                placed[l] = 1;
+                double tLeft = j > 0 ? t[j - 1] : 0.0;
+                index[i] = l;
+                left[i] = j - 1;
+                right[i] = k;
+                leftWeight[i] = (t[k] - t[l]) / (t[k] - tLeft);
+                rightWeight[i] = (t[l] - tLeft) / (t[k] - tLeft);
+                stdDev[i] = std::sqrt((t[l] - tLeft) * (t[k] - t[l]) / (t[k] - tLeft));
+                j = k + 1;
+                if (j >= n) j = 0;
+            }
+        }
+    };
+
+    // per block partial sums: w * m^0..4 and w * cf * m^0..2 for the regression, or cf / cf^2 at the end
+    constexpr int SUMS = 8;
+
+    // least squares on {1, m, m^2}; too few in the money paths -> flat continuation at their mean
+    void regress(const double* s, double* beta) {
+        beta[0] = beta[1] = beta[2] = 0.0;
+        if (s[0] <= 0.0) return;
+        double A[3][4] = {{s[0], s[1], s[2], s[5]},
+                          {s[1], s[2], s[3], s[6]},
+                          {s[2], s[3], s[4], s[7]}};
+        if (s[0] < 3.0) {
+            beta[0] = s[5] / s[0];
+            return;
+        }
+        for (int c = 0; c < 3; ++c) {
+            int pivot = c;
+            for (int r = c + 1; r < 3; ++r)
+                if (std::abs(A[r][c]) > std::abs(A[pivot][c])) pivot = r;
+            if (std::abs(A[pivot][c]) < 1e-14 * s[0]) {
+                beta[0] = s[5] / s[0];
+                return;
+            }
+            std::swap(A[c], A[pivot]);
+            for (int r = c + 1; r < 3; ++r) {
+                double f = A[r][c] / A[c][c];
+                for (int k = c; k < 4; ++k) A[r][k] -= f * A[c][k];
+            }
+        }
+        for (int c = 2; c >= 0; --c) {
+            double v = A[c][3];
+            for (int k = c + 1; k < 3; ++k) v -= A[c][k] * beta[k];
+            beta[c] = v / A[c][c];
+        }
+    }
+
+    double europeanValue(double S, double K, double r, double q, double sigma, double tau, bool isPut) {
+        double volT = sigma * std::sqrt(tau);
+        double d1 = (std::log(S / K) + (r - q + 0.5 * sigma * sigma) * tau) / volT;
+        double d2 = d1 - volT;
+        double dfS = S * std::exp(-q * tau), dfK = K * std::exp(-r * tau);
+        return isPut ? dfK * normCDF(-d2) - dfS * normCDF(-d1) : dfS * normCDF(d1) - dfK * normCDF(d2);
+    }
+
+    // exercising below the european value of the remaining life is never optimal. intrinsic - european is monotone
+    // in spot (slope -1 + e^-q tau N(-d1) for puts, 1 - e^-q tau N(d1) for calls), so the rule is a single spot
+    // boundary per date: puts may exercise below it, calls above it. bisection in log spot.
+    double europeanBoundary(double K, double r, double q, double sigma, double tau, bool isPut) {
+        auto gap = [&](double S) { return (isPut ? K - S : S - K) - europeanValue(S, K, r, q, sigma, tau, isPut); };
+        double lo = std::log(K), hi = lo;
+        if (isPut) {
+            if (r <= 0.0) return 0.0; // put is never exercised early
+            lo -= 20.0;
+        } else {
+            if (q <= 0.0) return INFINITY; // nor is a call without dividends
+            while (gap(std::exp(hi)) < 0.0 && hi < lo + 20.0) hi += 1.0;
+            if (gap(std::exp(hi)) < 0.0) return INFINITY;
+        }
+        for (int k = 0; k < 60; ++k) {
+            double mid = 0.5 * (lo + hi);
+            //put: gap > 0 below the boundary; call: gap > 0 above it
+            if ((gap(std::exp(mid)) > 0.0) == isPut) lo = mid;
+            else hi = mid;
+        }
+        return std::exp(0.5 * (lo + hi));
+    }
+
+    // cashflow / regressor / exercise value per path, reused across options on the same thread
+    struct Scratch {
+        std::vector<double> cf, m, exercise, sums;
+        void resize(size_t paths) {
+            cf.resize(paths);
+            m.resize(paths);
+            exercise.resize(paths);
+            sums.resize(paths / LSMPaths::BLOCK * SUMS);
+        }
+    };
+
+    LSMResult priceOne(const LSMPaths& paths, double S, double K, double r, double sigma, double T, double q,
+                       OptionType type, OptionStyle style, bool parallel) {
+        static thread_local Scratch scratch;
+        const size_t P = paths.paths, B = LSMPaths::BLOCK, blocks = P / B;
+        const int N = paths.dates;
+        scratch.resize(P);
+        double *cf = scratch.cf.data(), *m = scratch.m.data(), *exercise = scratch.exercise.data();
+        double* sums = scratch.sums.data();
+
+        const double isPut = type == OptionType::Put ? 1.0 : 0.0;
+        const double logS = std::log(S), invK = 1.0 / K;
+        const double drift = (r - q - 0.5 * sigma * sigma) * T, volT = sigma * std::sqrt(T);
+        const double df = std::exp(-r * T / N);
+        const bool american = style == OptionStyle::American;
+        double beta[3];
+
+        #pragma omp parallel if(parallel) default(none) \
+                shared(paths, cf, m, exercise, sums, beta) firstprivate(P, B, blocks, N, isPut, logS, K, invK, r, q, sigma, T, drift, volT, df, american)
+        {
+            const double* last = paths.date(N - 1);
+        #pragma omp for schedule(static)
+            for (size_t b = 0; b < blocks; ++b) {
+        #pragma omp simd
+                for (size_t p = b * B; p < (b + 1) * B; ++p) {
+                    double s = VecMath::expSimd(logS + drift + volT * last[p]);
+                    double payoff = isPut * (K - s) + (1.0 - isPut) * (s - K);
+                    cf[p] = payoff > 0.0 ? payoff : 0.0;
+                }
+            }
+
+            for (int i = N - 2; american && i >= 0; --i) {
+                const double* Wi = paths.date(i);
+                const double a = logS + drift * (i + 1) / N;
+                //discount to t_i, then regression sums over in the money paths
+        #pragma omp for schedule(static)
+                for (size_t b = 0; b < blocks; ++b) {
+                    double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, y0 = 0, y1 = 0, y2 = 0;
+        #pragma omp simd reduction(+:s0, s1, s2, s3, s4, y0, y1, y2)
+                    for (size_t p = b * B; p < (b + 1) * B; ++p) {
+                        double value = cf[p] * df;
+                        double s = VecMath::expSimd(a + volT * Wi[p]);
+                        double e = isPut * (K - s) + (1.0 - isPut) * (s - K);
+                        double w = e > 0.0 ? 1.0 : 0.0;
+                        double x = s * invK - 1.0, x2 = x * x;
+                        cf[p] = value;
+                        m[p] = x;
+                        exercise[p] = e;
+                        s0 += w; s1 += w * x; s2 += w * x2; s3 += w * x2 * x; s4 += w * x2 * x2;
+                        y0 += w * value; y1 += w * value * x; y2 += w * value * x2;
+                    }
+                    double* out = sums + b * SUMS;
+                    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3; out[4] = s4;
+                    out[5] = y0; out[6] = y1; out[7] = y2;
+                }
+        #pragma omp single
+                {
+                    double total[SUMS] = {};
+                    for (size_t b = 0; b < blocks; ++b)
+                        for (int k = 0; k < SUMS; ++k) total[k] += sums[b * SUMS + k];
+                    regress(total, beta);
+                }
+                const double b0 = beta[0], b1 = beta[1], b2 = beta[2];
+                //regressor m = S/K - 1, so the boundary becomes a bound on m
+                const double bound = europeanBoundary(K, r, q, sigma, T * (N - 1 - i) / N, isPut > 0.0) * invK - 1.0;
+        #pragma omp for schedule(static)
+                for (size_t b = 0; b < blocks; ++b) {
+        #pragma omp simd
+                    for (size_t p = b * B; p < (b + 1) * B; ++p) {
+                        double x = m[p], e = exercise[p];
+                        double continuation = b0 + (b1 + b2 * x) * x;
+                        //the european floor stops the quadratic fit from exercising where the time value is
+                        //smaller than its error (deep in the money calls, mostly)
+                        bool allowed = isPut > 0.0 ? x < bound : x > bound;
+                        cf[p] = (e > 0.0 && e > continuation && allowed) ? e : cf[p];
+                    }
+                }
+            }
+
+        #pragma omp for schedule(static)
+            for (size_t b = 0; b < blocks; ++b) {
+                double sum = 0.0, sq = 0.0;
+        #pragma omp simd reduction(+:sum, sq)
+                for (size_t p = b * B; p < (b + 1) * B; ++p) {
+                    sum += cf[p];
+                    sq += cf[p] * cf[p];
+                }
+                sums[b * SUMS] = sum;
+                sums[b * SUMS + 1] = sq;
+            }
+        }
+
+        double sum = 0.0, sq = 0.0;
+        for (size_t b = 0; b < blocks; ++b) {
+            sum += sums[b * SUMS];
+            sq += sums[b * SUMS + 1];
+        }
+        //american cashflows sit at t_0 = T / N after the loop, european ones at expiry
+        double discount = american ? df : std::exp(-r * T);
+        double mean = sum / P;
+        double variance = std::max(sq / P - mean * mean, 0.0);
+        LSMResult result{discount * mean, discount * std::sqrt(variance / P)};
+        if (american) {
+            double intrinsic = type == OptionType::Put ? K - S : S - K;
+            result.price = std::max(result.price, intrinsic);
+        }
+        return result;
+    }
+}
+
+LSMPaths LSMPaths::generate(int dates, size_t paths, uint64_t seed) {
+    if (dates < 1) throw std::invalid_argument("LSM needs at least one exercise date");
+    const size_t B = BLOCK;
+    paths = std::max<size_t>(1, (paths + B - 1) / B) * B;
+    if (paths > (size_t{1} << 32)) throw std::invalid_argument("Too many LSM paths");
+
+    LSMPaths out;
+    out.dates = dates;
+    out.paths = paths;
+    out.W.resize(static_cast<size_t>(dates) * paths);
+
+    const BrownianBridge bridge(dates);
+    const int sobolDims = std::min(dates, Sobol::MAX_DIMS);
+    const Sobol sobol(sobolDims, seed);
+    const size_t blocks = paths / B;
+    double* W = out.W.data();
+
+    #pragma omp parallel default(none) shared(bridge, sobol, W) firstprivate(dates, paths, seed, sobolDims, blocks, B)
+    {
+        std::vector<double> z(static_cast<size_t>(dates) * B); // [bridge point][path in block]
+        std::vector<uint32_t> x(sobolDims);
+
+    #pragma omp for schedule(static)
+        for (size_t b = 0; b < blocks; ++b) {
+            const uint32_t first = static_cast<uint32_t>(b * B);
+            sobol.point(first, x.data());
+            for (size_t p = 0; p < B; ++p) {
+                if (p > 0) sobol.next(first + static_cast<uint32_t>(p) - 1, x.data());
+                for (int d = 0; d < sobolDims; ++d) z[d * B + p] = invNormCDF(Sobol::toUniform(x[d]));
+                //bridge points past the sobol dims: Philox stream = path, counter = (point, 1)
+                const uint64_t path = first + p;
+                for (int d = sobolDims; d < dates; d += 4) {
+                    uint32_t c[4] = {static_cast<uint32_t>(d), 1u, static_cast<uint32_t>(path), static_cast<uint32_t>(path >> 32)};
+                    Philox::block(c, seed);
+                    for (int k = 0; k < 4 && d + k < dates; ++k) z[(d + k) * B + p] = invNormCDF(Sobol::toUniform(c[k]));
+                }
+            }
+
+            //bridge across the block, one (point, paths) row at a time so the inner loop vectorizes
+            double* base = W + b * B;
+            for (int i = 0; i < dates; ++i) {
+                double* target = base + static_cast<size_t>(bridge.index[i]) * paths;
+                const double* zi = z.data() + static_cast<size_t>(i) * B;
+                const double sd = bridge.stdDev[i];
+                if (i == 0) {
+                    for (size_t p = 0; p < B; ++p) target[p] = sd * zi[p];
+                    continue;
+                }
+                const double* right = base + static_cast<size_t>(bridge.right[i]) * paths;
+                const double rw = bridge.rightWeight[i];
+                if (bridge.left[i] < 0) {
+        #pragma omp simd
+                    for (size_t p = 0; p < B; ++p) target[p] = rw * right[p] + sd * zi[p];
+                } else {
+                    const double* left = base + static_cast<size_t>(bridge.left[i]) * paths;
+                    const double lw = bridge.leftWeight[i];
+        #pragma omp simd
+                    for (size_t p = 0; p < B; ++p) target[p] = lw * left[p] + rw * right[p] + sd * zi[p];
+                }
+            }
+        }
+    }
+    return out;
+}
+
+LSMResult LongstaffSchwartz::price(const Option& opt, const LSMConfig& config) {
+    return price(opt, LSMPaths::generate(config.exerciseDates, config.paths, config.seed));
+}
+
+LSMResult LongstaffSchwartz::price(const Option& opt, const LSMPaths& paths) {
+    return priceOne(paths, opt.S, opt.K, opt.r, opt.sigma, opt.T, opt.q, opt.type, opt.style, !omp_in_parallel());
+}
+
+void LongstaffSchwartz::priceBatch(const OptionBatchView& batch, double* out, const LSMConfig& config, double* stdError) {
+    const LSMPaths paths = LSMPaths::generate(config.exerciseDates, config.paths, config.seed);
+    const size_t N = batch.size();
+    #pragma omp parallel for schedule(dynamic, 1) default(none) shared(batch, out, stdError, paths, N)
+    for (size_t i = 0; i < N; ++i) {
+        LSMResult result = priceOne(paths, batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i],
+                                    batch.type[i], batch.style[i], false);
+        out[i] = result.price;
+        if (stdError) stdError[i] = result.stdError;
+    }
+}
+
+std::vector<double> LongstaffSchwartz::priceBatch(const OptionBatch& batch, const LSMConfig& config) {
+    std::vector<double> prices(batch.size());
+    priceBatch(batch.view(), prices.data(), config);
+    return prices;
+}
@@ -7,10 +7,38 @@
 #include "pricing/BinomialTree.h"
 #include "shared/BinomialWorkspace.h"
 #include "pricing/BAW.h"
+#include "pricing/Kernels.h"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <omp.h>
 
+namespace {
+    //rows per Kernels call. multiples of 64 keep every chunk on the columns' 64-byte alignment
+    constexpr size_t SIMD_CHUNK = 1024;
+    constexpr size_t ROW_CHUNK = 256;
+    constexpr size_t LATTICE_CHUNK = 64;
+
+    //tree greeks are per unit vol/rate and per year; bring them to BlackScholes::computeGreeks units (vega and rho per
+    //point, theta per calendar day) so a batch of mixed styles has one set of units, as Portfolio does
+    Greeks inBlackScholesUnits(Greeks g) {
+        g.vega /= 100.0;
+        g.rho /= 100.0;
+        g.theta /= 365.0;
+        return g;
+    }
+
+    //lattice scratch per omp thread, kept across calls (the pool's threads live as long as the process), so a
+    //steady-state tick allocates nothing. separate from BinomialTree's own per-thread workspace, which BAW's
+    //fallback may use while a row here is holding this one
+    template<typename Real>
+    BasicBinomialWorkspace<Real>& batchWorkspace(int steps) {
+        static thread_local BasicBinomialWorkspace<Real> workspace(0);
+        workspace.reserveSteps(steps);
+        return workspace;
+    }
+}
+
 //singular
 double PricingDispatcher::price(const Option& opt) {
     switch (opt.style) {
@@ -26,7 +54,11 @@ double PricingDispatcher::price(const Option& opt) {
 // barch include w/ parallelization
 std::vector<double> PricingDispatcher::priceParallelized(const std::vector<Option>& opts, AmericanPricerFn americanPricer, int steps){
     std::vector<double> prices(opts.size());
+    priceParallelized(opts, americanPricer, prices.data(), steps);
+    return prices;
+}
 
+void PricingDispatcher::priceParallelized(const std::vector<Option>& opts, AmericanPricerFn americanPricer, double* prices, int steps) {
     //allow parallelization across cpus; no vars shared
     #pragma omp parallel default(none) shared(opts, prices, steps, americanPricer)
     {
@@ -40,67 +72,209 @@ std::vector<double> PricingDispatcher::priceParallelized(const std::vector<Optio
             }
         }
     }
-    return prices;
 }
 //for memory locality, avoid edit every object
-std::vector<double> PricingDispatcher::priceBatch(const OptionBatch& batch, int steps) {
+template<typename Real>
+std::vector<Real> PricingDispatcher::priceBatch(const BasicOptionBatch<Real>& batch, int steps) {
+    std::vector<Real> prices(batch.size());
+    priceBatch(batch.view(), prices.data(), steps);
+    return prices;
+}
+
+template<typename Real>
+void PricingDispatcher::priceBatch(const BasicOptionBatchView<Real>& batch, Real* out, int steps) {
+    const size_t N = batch.size(), chunk = ROW_CHUNK, chunks = (N + chunk - 1) / chunk;
+
+    #pragma omp parallel default(none) shared(batch, out, steps, N, chunk, chunks)
+    {
+        //BAW's fallback lattice, sized on every thread before any row can need it
+        BinomialTree::threadWorkspace(BAW::FALLBACK_STEPS);
+
+    //isa-specific row loop per chunk (Kernels); BAW's cost varies by row, so chunks are handed out dynamically
+    #pragma omp for schedule(dynamic)
+        for (size_t c = 0; c < chunks; ++c)
+            Kernels::priceRows(batch, c * chunk, std::min(chunk, N - c * chunk), out, steps);
+    }
+}
+
+template<typename Real>
+void PricingDispatcher::priceBatchBinomial(const BasicOptionBatchView<Real>& batch, Real* out, int steps) {
+    const size_t N = batch.size(), chunk = LATTICE_CHUNK, chunks = (N + chunk - 1) / chunk;
+
+    #pragma omp parallel default(none) shared(batch, out, steps, N, chunk, chunks)
+    {
+        BasicBinomialWorkspace<Real>& workspace = batchWorkspace<Real>(steps);
+
+    #pragma omp for schedule(dynamic)
+        for (size_t c = 0; c < chunks; ++c)
+            Kernels::binomialRows(batch, c * chunk, std::min(chunk, N - c * chunk), out, steps, workspace);
+    }
+}
+
+void PricingDispatcher::priceBatch(const OptionBatchView& batch, const ExpiryBuckets& buckets, double* out, int steps) {
+    size_t N = batch.size();
+    const double *Sc = batch.S, *Kc = batch.K, *sigmac = batch.sigma;
+    const ExpiryTerms* terms = buckets.terms.data();
+    const uint32_t* bucket = buckets.bucket.data();
+
+    //every row as european first: no exp per row, just a gather of its expiry's terms
+    #pragma omp parallel for simd default(none) shared(batch, Sc, Kc, sigmac, terms, bucket, out, N)
+    for (size_t i = 0; i < N; ++i) {
+        const ExpiryTerms& e = terms[bucket[i]];
+        double prepaid = Sc[i] * e.carryDiscount - e.pvDividends;
+        double discountedK = Kc[i] * e.discount;
+        double volSqrtT = sigmac[i] * e.sqrtT;
+        //dividends worth more than the carried spot: no log, the price is intrinsic on the prepaid forward
+        bool live = prepaid > 0.0;
+        double d1 = (std::log(live ? prepaid / discountedK : 1.0) + 0.5 * volSqrtT * volSqrtT) / volSqrtT;
+        double d2 = d1 - volSqrtT;
+        double call = live ? prepaid * normCDF(d1) - discountedK * normCDF(d2) : 0.0;
+        double put = live ? discountedK * normCDF(-d2) - prepaid * normCDF(-d1) : discountedK - prepaid;
+        out[i] = batch.type[i] == OptionType::Put ? put : call;
+    }
+
+    #pragma omp parallel default(none) shared(batch, terms, bucket, out, N, steps)
+    {
+        BinomialTree::threadWorkspace(BAW::FALLBACK_STEPS);
+
+    #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < N; ++i) {
+            if (batch.style[i] != OptionStyle::American) continue;
+            const ExpiryTerms& e = terms[bucket[i]];
+            double S = batch.S[i], prepaid = S * e.carryDiscount - e.pvDividends;
+            double q = e.pvDividends > 0.0 && prepaid > 0.0 ? -std::log(prepaid / S) / e.T : e.q;
+            out[i] = BAW::priceParameters(S, batch.K[i], e.r, batch.sigma[i], e.T, q, batch.type[i], steps);
+        }
+    }
+}
+
+//same models as priceAndGreeks, written column-wise
+void PricingDispatcher::priceAndGreeksBatch(const OptionBatchView& batch, const GreekColumns& out, int steps) {
+    size_t N = batch.size();
+
+    #pragma omp parallel default(none) shared(batch, out, steps, N)
+    {
+        BinomialWorkspace& workspace = batchWorkspace<double>(steps);
+
+    #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < N; ++i) {
+            Option opt(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], batch.style[i]);
+            double price;
+            Greeks g;
+            if (opt.style == OptionStyle::European) {
+                price = BlackScholes::price(opt);
+                g = BlackScholes::computeGreeks(opt);
+            } else {
+                price = BinomialTree::priceWorkspace(opt, steps, workspace);
+                //bump spot by 1%: with the default 0.01 the lattice's own noise swamps the second difference and
+                //gamma comes out ~100x too big
+                g = inBlackScholesUnits(BinomialTree::computeGreeks(opt, workspace, steps, 0.01 * opt.S));
+            }
+            if (out.price) out.price[i] = price;
+            if (out.delta) out.delta[i] = g.delta;
+            if (out.gamma) out.gamma[i] = g.gamma;
+            if (out.theta) out.theta[i] = g.theta;
+            if (out.vega)  out.vega[i]  = g.vega;
+            if (out.rho)   out.rho[i]   = g.rho;
+        }
+    }
+}
+
+std::vector<double> PricingDispatcher::priceBatchAdaptive(const OptionBatch& batch, const AdaptiveModelSelector& selector) {
+    std::vector<double> prices(batch.size());
+    priceBatchAdaptive(batch.view(), selector, prices.data());
+    return prices;
+}
+
+void PricingDispatcher::priceBatchAdaptive(const OptionBatchView& batch, const AdaptiveModelSelector& selector, double* prices) {
     size_t N = batch.size();
-    std::vector<double> prices(N);
 
-    #pragma omp parallel default(none) shared(batch, prices, steps, N)
+    #pragma omp parallel default(none) shared(batch, prices, selector, N)
     {
-        BinomialWorkspace workspace(steps);  // per-thread workspace
+        BinomialWorkspace& workspace = batchWorkspace<double>(AdaptiveModelSelector::MAX_STEPS);
 
-    #pragma omp for
+    //routed models differ wildly in cost; dynamic keeps threads balanced
+    #pragma omp for schedule(dynamic, 64)
         for (size_t i = 0; i < N; ++i) {
             if (batch.style[i] == OptionStyle::European)
                 prices[i] = BlackScholes::priceParameter(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i]);
             else
-                prices[i] = BAW::priceParameters(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], steps);
-//                prices[i] = BinomialTree::priceParametersWorkspace(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], steps, workspace);
+                prices[i] = selector.price(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], workspace);
         }
     }
+}
+
+std::vector<double> PricingDispatcher::priceBatchSurrogate(const OptionBatch& batch, const ChebyshevSurrogate& surrogate) {
+    std::vector<double> prices(batch.size());
+    priceBatchSurrogate(batch.view(), surrogate, prices.data());
     return prices;
 }
 
-std::vector<double> PricingDispatcher::priceBatchBlackScholesSIMD(const OptionBatch& batch){
+void PricingDispatcher::priceBatchSurrogate(const OptionBatchView& batch, const ChebyshevSurrogate& surrogate, double* prices) {
     size_t N = batch.size();
-    std::vector<double> prices(N);
-
-    double S, K, r, sigma, T, d1, d2;
-    #pragma omp parallel for simd default(none) private(S, K, r, sigma, T, d1, d2) shared(batch, prices, N)
-    for (size_t i = 0; i < N; i++) {
-        S = batch.S[i], K = batch.K[i], r = batch.r[i], sigma = batch.sigma[i], T = batch.T[i];
-
-        d1 = (std::log(S / K) + (r + 0.5 * sigma * sigma) * T) / (sigma * std::sqrt(T));
-        d2 = d1 - sigma * std::sqrt(T);
+    surrogate.priceBatch(batch, prices);
 
-        if (batch.type[i] == OptionType::Call)
-            prices[i] = normCDF(d1) * S - normCDF(d2) * K * std::exp(-r * T);
-        else
-            prices[i] = normCDF(-d2) * K * std::exp(-r * T) - normCDF(-d1) * S;
+    #pragma omp parallel for default(none) shared(batch, prices, N)
+    for (size_t i = 0; i < N; ++i) {
+        if (batch.style[i] == OptionStyle::European)
+            prices[i] = BlackScholes::priceParameter(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i]);
     }
+}
+
+template<typename Real>
+std::vector<Real> PricingDispatcher::priceBatchBlackScholesSIMD(const BasicOptionBatch<Real>& batch){
+    std::vector<Real> prices(batch.size());
+    priceBatchBlackScholesSIMD(batch.view(), prices.data());
     return prices;
 }
+
+template<typename Real>
+void PricingDispatcher::priceBatchBlackScholesSIMD(const BasicOptionBatchView<Real>& view, Real* out) {
+    const size_t N = view.size(), chunk = SIMD_CHUNK, chunks = (N + chunk - 1) / chunk;
+    #pragma omp parallel for default(none) shared(view, out, N, chunk, chunks)
+    for (size_t c = 0; c < chunks; ++c)
+        Kernels::blackScholes(view, c * chunk, std::min(chunk, N - c * chunk), out);
+}
+
+template std::vector<double> PricingDispatcher::priceBatch(const OptionBatch&, int);
+template std::vector<float> PricingDispatcher::priceBatch(const OptionBatchF&, int);
+template void PricingDispatcher::priceBatch(const OptionBatchView&, double*, int);
+template void PricingDispatcher::priceBatch(const OptionBatchViewF&, float*, int);
+template void PricingDispatcher::priceBatchBinomial(const OptionBatchView&, double*, int);
+template void PricingDispatcher::priceBatchBinomial(const OptionBatchViewF&, float*, int);
+template std::vector<double> PricingDispatcher::priceBatchBlackScholesSIMD(const OptionBatch&);
+template std::vector<float> PricingDispatcher::priceBatchBlackScholesSIMD(const OptionBatchF&);
+template void PricingDispatcher::priceBatchBlackScholesSIMD(const OptionBatchView&, double*);
+template void PricingDispatcher::priceBatchBlackScholesSIMD(const OptionBatchViewF&, float*);
+
 //memory-reuse in Binomial Workspace; only american options
 std::vector<double> PricingDispatcher::priceBatchBinomialWorkspace(const std::vector<Option>& opts, int steps) {
     std::vector<double> prices(opts.size());
+    priceBatchBinomialWorkspace(opts, prices.data(), steps);
+    return prices;
+}
+
+void PricingDispatcher::priceBatchBinomialWorkspace(const std::vector<Option>& opts, double* prices, int steps) {
     #pragma omp parallel default(none) shared(opts, prices, steps)
     {
-        BinomialWorkspace workspace(steps); // Thread-local
+        BinomialWorkspace& workspace = batchWorkspace<double>(steps); // Thread-local
         #pragma omp for
         for (int i = 0; i < static_cast<int>(opts.size()); i++) {
             prices[i] = BinomialTree::priceWorkspace(opts[i], steps, workspace);
         }
     }
-    return prices;
 }
 
 std::vector<GreekResult> PricingDispatcher::priceAndGreeks(const std::vector<Option>& opts, int steps) {
     std::vector<GreekResult> results(opts.size());
+    priceAndGreeks(opts, results.data(), steps);
+    return results;
+}
+
+void PricingDispatcher::priceAndGreeks(const std::vector<Option>& opts, GreekResult* results, int steps) {
     #pragma omp parallel default(none) shared(opts, results, steps)
     {
-        BinomialWorkspace workspace(steps); //once per thread; no matter if european or american, there
+        BinomialWorkspace& workspace = batchWorkspace<double>(steps); //once per thread; no matter if european or american, there
         #pragma omp for
         for (size_t i = 0; i < opts.size(); ++i) {
             const Option& opt = opts[i];
@@ -111,20 +285,24 @@ std::vector<GreekResult> PricingDispatcher::priceAndGreeks(const std::vector<Opt
                 res.greeks = BlackScholes::computeGreeks(opt);
             } else {
                 res.price = BinomialTree::priceWorkspace(opt, steps, workspace);
-                res.greeks = BinomialTree::computeGreeks(opt, workspace); // will reuse workspace; also using default parameters
+                res.greeks = BinomialTree::computeGreeks(opt, workspace, steps); // will reuse workspace; sized for steps
             }
 
             results[i] = res;
         }
     }
-    return results;
 }
 
 std::vector<Greeks> PricingDispatcher::greeks(const std::vector<Option>& opts, int steps) {
     std::vector<Greeks> results(opts.size());
+    greeks(opts, results.data(), steps);
+    return results;
+}
+
+void PricingDispatcher::greeks(const std::vector<Option>& opts, Greeks* results, int steps) {
     #pragma omp parallel default(none) shared(opts, results, steps)
     {
-        BinomialWorkspace workspace(steps); //once per thread; no matter if european or american, there
+        BinomialWorkspace& workspace = batchWorkspace<double>(steps); //once per thread; no matter if european or american, there
         #pragma omp for
         for (size_t i = 0; i < opts.size(); ++i) {
             const Option& opt = opts[i];
@@ -133,11 +311,10 @@ std::vector<Greeks> PricingDispatcher::greeks(const std::vector<Option>& opts, i
             if (opt.style == OptionStyle::European) {
                 res= BlackScholes::computeGreeks(opt);
             } else {
-                res = BinomialTree::computeGreeks(opt, workspace); // will reuse workspace; also using default parameters
+                res = BinomialTree::computeGreeks(opt, workspace, steps); // will reuse workspace; sized for steps
             }
 
             results[i] = res;
         }
     }
-    return results;
 }
@@ -0,0 +1,155 @@
+#include "pricing/ScenarioEngine.h"
+#include "pricing/BlackScholes.h"
+#include "pricing/BinomialTree.h"
+#include "pricing/BAW.h"
+#include "shared/MathUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <omp.h>
+
+ScenarioGrid ScenarioGrid::uniform(double spotRange, int spotSteps, double volRange, int volSteps) {
+    auto axis = [](double range, int steps) {
+        std::vector<double> shocks(std::max(steps, 1), 0.0);
+        for (int k = 0; k < steps && steps > 1; ++k)
+            shocks[k] = -range + 2.0 * range * k / (steps - 1);
+        return shocks;
+    };
+    return {axis(spotRange, spotSteps), axis(volRange, volSteps)};
+}
+
+ScenarioEngine::ScenarioEngine(ScenarioGrid grid, int steps) : grid_(std::move(grid)), steps_(steps) {
+    for (double shock : grid_.spotShocks) {
+        if (shock <= -1.0) throw std::invalid_argument("Spot shock must be greater than -100%");
+        spotFactor_.push_back(1.0 + shock);
+        logSpotFactor_.push_back(std::log1p(shock));
+    }
+}
+
+// one option across the whole grid; row holds cells() entries
+void ScenarioEngine::priceRow(const OptionBatchView& batch, size_t i, double* row) const {
+    const double S = batch.S[i], K = batch.K[i], r = batch.r[i], T = batch.T[i], q = batch.q[i];
+    const OptionType type = batch.type[i];
+    const bool american = batch.style[i] == OptionStyle::American;
+    const bool isPut = type == OptionType::Put;
+    const size_t numSpot = spotFactor_.size();
+    const double* factor = spotFactor_.data();
+    const double* logFactor = logSpotFactor_.data();
+
+    // spot and vol independent
+    const double sqrtT = std::sqrt(T);
+    const double dfR = std::exp(-r * T);
+    const double dfQ = std::exp(-q * T);
+    const double discountedK = K * dfR;
+    const double logSK = std::log(S / K);
+
+    for (size_t v = 0; v < grid_.volShocks.size(); ++v) {
+        const double sigma = grid_.shockedVol(batch.sigma[i], v);
+        const double volSqrtT = sigma * sqrtT;
+        const double drift = (r + sigma * sigma / 2) * T; // same d1 as BlackScholes::priceParameter
+        double* out = row + v * numSpot;
+
+        if (!american) {
+            #pragma omp simd
+            for (size_t j = 0; j < numSpot; ++j) {
+                double Sj = S * factor[j];
+                double d1 = (logSK + logFactor[j] + drift) / volSqrtT;
+                double d2 = d1 - volSqrtT;
+                double call = dfQ * normCDF(d1) * Sj - normCDF(d2) * discountedK;
+                double put = normCDF(-d2) * discountedK - dfQ * normCDF(-d1) * Sj;
+                out[j] = isPut ? put : call;
+            }
+            continue;
+        }
+
+        // critical price depends on vol but not spot: one newton solve per vol shock instead of per cell
+        double Sx = BAW::criticalPrice(K, r, sigma, T, q, type, steps_);
+        if (Sx == -1) {
+            for (size_t j = 0; j < numSpot; ++j)
+                out[j] = BinomialTree::priceParameters(S * factor[j], K, r, sigma, T, q, type, BAW::FALLBACK_STEPS);
+            continue;
+        }
+
+        // BAW::priceWithCritical with the spot-independent terms pulled out
+        double sigma2 = sigma * sigma;
+        double n = 2 * (r - q) / sigma2;
+        double k = 2 * r / (sigma2 * (1 - std::exp(-r * T)));
+        double d1x = (std::log(Sx / K) + (r - q + 0.5 * sigma2) * T) / volSqrtT;
+        double exponent, coefficient;
+        if (isPut) {
+            exponent = 0.5 * (-n - std::sqrt((n - 1) * (n - 1) + 4 * k));
+            coefficient = -Sx * (1 - dfQ * normCDF(-d1x)) / exponent;
+        } else {
+            exponent = 0.5 * (-n + std::sqrt((n - 1) * (n - 1) + 4 * k));
+            coefficient = Sx * (1 - dfQ * normCDF(d1x)) / exponent;
+        }
+        const double logSSx = std::log(S / Sx);
+
+        #pragma omp simd
+        for (size_t j = 0; j < numSpot; ++j) {
+            double Sj = S * factor[j];
+            double d1 = (logSK + logFactor[j] + drift) / volSqrtT;
+            double d2 = d1 - volSqrtT;
+            double euro = isPut ? normCDF(-d2) * discountedK - dfQ * normCDF(-d1) * Sj
+                                : dfQ * normCDF(d1) * Sj - normCDF(d2) * discountedK;
+            double premium = coefficient * std::exp(exponent * (logSSx + logFactor[j]));
+            bool exercise = isPut ? Sj <= Sx : Sj >= Sx;
+            double intrinsic = std::max(0.0, isPut ? K - Sj : Sj - K);
+            out[j] = exercise ? intrinsic : euro + premium;
+        }
+    }
+}
+
+void ScenarioEngine::price(const OptionBatchView& batch, double* cube, double* base) const {
+    size_t N = batch.size();
+    size_t cells = grid_.cells();
+    int steps = steps_;
+
+    //american rows cost a newton solve per vol shock; dynamic keeps threads balanced on mixed books
+    #pragma omp parallel for schedule(dynamic, 16) default(none) shared(batch, cube, base, N, cells, steps)
+    for (size_t i = 0; i < N; ++i) {
+        priceRow(batch, i, cube + i * cells);
+        if (base) {
+            base[i] = batch.style[i] == OptionStyle::European
+                    ? BlackScholes::priceParameter(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i])
+                    : BAW::priceParameters(batch.S[i], batch.K[i], batch.r[i], batch.sigma[i], batch.T[i], batch.q[i], batch.type[i], steps);
+        }
+    }
+}
+
+std::vector<double> ScenarioEngine::price(const OptionBatch& batch) const {
+    std::vector<double> cube(batch.size() * cells());
+    price(batch.view(), cube.data());
+    return cube;
+}
+
+std::vector<double> ScenarioEngine::aggregate(const double* cube, const double* base, const std::vector<int>& underlying,
+                                              int numUnderlyings, const std::vector<double>& quantity) const {
+    size_t N = underlying.size();
+    size_t cells = grid_.cells();
+    if (!quantity.empty() && quantity.size() != N)
+        throw std::invalid_argument("Quantities must match underlying ids");
+    std::vector<double> totals(static_cast<size_t>(numUnderlyings) * cells, 0.0);
+
+    //per-thread partial cubes, merged once; avoids atomics on the shared output
+    #pragma omp parallel default(none) shared(cube, base, underlying, numUnderlyings, quantity, totals, N, cells)
+    {
+        std::vector<double> local(totals.size(), 0.0);
+    #pragma omp for schedule(static)
+        for (size_t i = 0; i < N; ++i) {
+            int u = underlying[i];
+            if (u < 0 || u >= numUnderlyings) continue;
+            double qty = quantity.empty() ? 1.0 : quantity[i];
+            double offset = base ? base[i] : 0.0;
+            const double* row = cube + i * cells;
+            double* acc = local.data() + static_cast<size_t>(u) * cells;
+            #pragma omp simd
+            for (size_t c = 0; c < cells; ++c)
+                acc[c] += qty * (row[c] - offset);
+        }
+    #pragma omp critical
+        for (size_t c = 0; c < totals.size(); ++c)
+            totals[c] += local[c];
+    }
+    return totals;
+}
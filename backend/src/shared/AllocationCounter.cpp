@@ -0,0 +1,53 @@
+#include "shared/AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t>& counter() {
+        static std::atomic<uint64_t> allocations{0};
+        return allocations;
+    }
+}
+
+#ifdef OPTIONS_COUNT_ALLOCATIONS
+bool AllocationCounter::enabled() { return true; }
+void AllocationCounter::record() { counter().fetch_add(1, std::memory_order_relaxed); }
+#else
+bool AllocationCounter::enabled() { return false; }
+void AllocationCounter::record() {}
+#endif
+
+uint64_t AllocationCounter::count() { return counter().load(std::memory_order_relaxed); }
+
+#ifdef OPTIONS_COUNT_ALLOCATIONS
+//every other form (arrays, nothrow) ends up in one of these two in libstdc++/libc++; the deletes are replaced too so
+//the pair always matches. lives in the same object as count(), so anything that reads the counter links it in
+namespace {
+    void* allocate(std::size_t size) {
+        AllocationCounter::record();
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+    void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+        AllocationCounter::record();
+        std::size_t align = static_cast<std::size_t>(alignment);
+        //aligned_alloc wants a size that is a multiple of the alignment
+        if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
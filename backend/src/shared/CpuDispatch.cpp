@@ -0,0 +1,67 @@
+#include "shared/CpuDispatch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    IsaLevel probe() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        //__builtin_cpu_supports also checks XCR0, so a kernel that doesn't save the wide registers reports no avx
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+            __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw"))
+            return IsaLevel::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2"))
+            return IsaLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return IsaLevel::SSE42;
+#endif
+        return IsaLevel::Baseline;
+    }
+
+    IsaLevel fromEnvironment(IsaLevel best) {
+        const char* requested = std::getenv("OPTIONS_ISA");
+        if (!requested || !*requested) return best;
+        try {
+            return std::min(CpuDispatch::fromName(requested), best);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << e.what() << "; using " << CpuDispatch::name(best) << "\n";
+            return best;
+        }
+    }
+
+    std::atomic<int>& current() {
+        static std::atomic<int> level{static_cast<int>(fromEnvironment(CpuDispatch::detected()))};
+        return level;
+    }
+}
+
+IsaLevel CpuDispatch::detected() {
+    static const IsaLevel level = probe();
+    return level;
+}
+
+IsaLevel CpuDispatch::active() {
+    return static_cast<IsaLevel>(current().load(std::memory_order_relaxed));
+}
+
+void CpuDispatch::setActive(IsaLevel level) {
+    current().store(static_cast<int>(std::min(level, detected())), std::memory_order_relaxed);
+}
+
+const char* CpuDispatch::name(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::Baseline: return "baseline";
+        case IsaLevel::SSE42: return "sse4.2";
+        case IsaLevel::AVX2: return "avx2";
+        case IsaLevel::AVX512: return "avx512";
+        default: return "?";
+    }
+}
+
+IsaLevel CpuDispatch::fromName(const std::string& name) {
+    for (int l = 0; l < static_cast<int>(IsaLevel::COUNT); ++l)
+        if (name == CpuDispatch::name(static_cast<IsaLevel>(l))) return static_cast<IsaLevel>(l);
+    throw std::invalid_argument("Unknown ISA level: " + name + " (baseline, sse4.2, avx2, avx512)");
+}
@@ -0,0 +1,285 @@
+#include "shared/OptionBatchFile.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char BOOK_MAGIC[8] = {'O', 'P', 'T', 'B', 'A', 'T', 'C', 'H'};
+    constexpr char RESULT_MAGIC[8] = {'O', 'P', 'T', 'R', 'E', 'S', 'L', 'T'};
+    constexpr uint32_t ENDIAN_TAG = 0x01020304;
+
+    size_t alignUp(size_t n) {
+        return (n + BatchFile::ALIGNMENT - 1) & ~(BatchFile::ALIGNMENT - 1);
+    }
+
+    struct PendingColumn {
+        BatchFile::Column id;
+        uint32_t elementSize;
+        const void* data;
+        size_t bytes;
+    };
+
+    // lays out columns after the header on 64 byte boundaries
+    BatchFile::Header makeHeader(const char (&magic)[8], size_t rows, const std::vector<PendingColumn>& columns) {
+        BatchFile::Header header{};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = BatchFile::VERSION;
+        header.columnCount = static_cast<uint32_t>(columns.size());
+        header.rows = rows;
+        header.endianTag = ENDIAN_TAG;
+        size_t offset = alignUp(sizeof(BatchFile::Header));
+        for (size_t c = 0; c < columns.size(); ++c) {
+            header.columns[c] = {static_cast<uint32_t>(columns[c].id), columns[c].elementSize, offset, columns[c].bytes};
+            offset = alignUp(offset + columns[c].bytes);
+        }
+        return header;
+    }
+
+    size_t fileSize(const BatchFile::Header& header) {
+        size_t end = alignUp(sizeof(BatchFile::Header));
+        for (uint32_t c = 0; c < header.columnCount; ++c)
+            end = std::max<size_t>(end, alignUp(header.columns[c].offset + header.columns[c].bytes));
+        return end;
+    }
+
+    const BatchFile::Header& validate(const MappedRegion& region, const char (&magic)[8]) {
+        if (region.size() < sizeof(BatchFile::Header))
+            throw std::runtime_error("Batch file too small");
+        const auto& header = *static_cast<const BatchFile::Header*>(region.data());
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+            throw std::runtime_error("Batch file has wrong magic");
+        if (header.version != BatchFile::VERSION)
+            throw std::runtime_error("Unsupported batch file version");
+        if (header.endianTag != ENDIAN_TAG)
+            throw std::runtime_error("Batch file written with different byte order");
+        if (header.columnCount > BatchFile::MAX_COLUMNS)
+            throw std::runtime_error("Batch file has too many columns");
+        //every section has to lie inside the mapping, checked without letting offset + bytes wrap
+        for (uint32_t c = 0; c < header.columnCount; ++c) {
+            const auto& col = header.columns[c];
+            if (col.offset % BatchFile::ALIGNMENT != 0 || col.offset < sizeof(BatchFile::Header))
+                throw std::runtime_error("Batch file column is misaligned");
+            if (col.offset > region.size() || col.bytes > region.size() - col.offset)
+                throw std::runtime_error("Batch file is truncated");
+        }
+        //per-row columns hold >= 8 bytes a row, so more rows than that can't be backed (and would wrap padToLanes)
+        if (header.rows > region.size() / sizeof(double))
+            throw std::runtime_error("Batch file is truncated");
+        return header;
+    }
+
+    // minRows: entries the column must hold (padded rows for per-row columns)
+    // bytes: the column's length, if asked for
+    const void* findColumn(const MappedRegion& region, const BatchFile::Header& header, BatchFile::Column id,
+                           uint32_t elementSize, bool required, size_t minRows = 0, size_t* bytes = nullptr) {
+        for (uint32_t c = 0; c < header.columnCount; ++c) {
+            const auto& col = header.columns[c];
+            if (col.id != static_cast<uint32_t>(id)) continue;
+            if (col.elementSize != elementSize)
+                throw std::runtime_error("Batch file column has unexpected element size");
+            if (col.bytes / elementSize < minRows)
+                throw std::runtime_error("Batch file column is shorter than its row count");
+            if (bytes) *bytes = col.bytes;
+            return static_cast<const char*>(region.data()) + col.offset;
+        }
+        if (required) throw std::runtime_error("Batch file is missing a column");
+        return nullptr;
+    }
+}
+
+void BatchFile::writeBook(const std::string& path, const OptionBatchView& batch, const std::vector<std::string>& ids) {
+    size_t n = batch.size();
+    if (!ids.empty() && ids.size() != n)
+        throw std::invalid_argument("Instrument ids must match batch size");
+
+    std::vector<uint64_t> idOffsets;
+    std::string idChars;
+    if (!ids.empty()) {
+        idOffsets.reserve(n + 1);
+        idOffsets.push_back(0);
+        for (const auto& id : ids) {
+            idChars += id;
+            idOffsets.push_back(idChars.size());
+        }
+    }
+
+    // views only promise padded rows are readable; zero them on disk either way
+    size_t padded = padToLanes(n);
+    size_t bytes = padded * sizeof(double);
+    std::vector<PendingColumn> columns = {
+            {Column::S, sizeof(double), batch.S, bytes},
+            {Column::K, sizeof(double), batch.K, bytes},
+            {Column::r, sizeof(double), batch.r, bytes},
+            {Column::sigma, sizeof(double), batch.sigma, bytes},
+            {Column::T, sizeof(double), batch.T, bytes},
+            {Column::q, sizeof(double), batch.q, bytes},
+            {Column::type, sizeof(uint64_t), batch.type.data(), bytes},
+            {Column::style, sizeof(uint64_t), batch.style.data(), bytes},
+    };
+    if (!ids.empty()) {
+        columns.push_back({Column::idOffsets, sizeof(uint64_t), idOffsets.data(), idOffsets.size() * sizeof(uint64_t)});
+        columns.push_back({Column::idChars, 1, idChars.data(), idChars.size()});
+    }
+
+    Header header = makeHeader(BOOK_MAGIC, n, columns);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) throw std::runtime_error("Could not open batch file for writing");
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    static const char zeros[ALIGNMENT] = {};
+    size_t written = sizeof(header);
+    for (uint32_t c = 0; c < header.columnCount; ++c) {
+        out.write(zeros, static_cast<std::streamsize>(header.columns[c].offset - written));
+        bool perRow = columns[c].id <= Column::style;
+        size_t dataBytes = perRow ? n * columns[c].elementSize : columns[c].bytes;
+        out.write(static_cast<const char*>(columns[c].data), static_cast<std::streamsize>(dataBytes));
+        for (size_t pad = dataBytes; pad < columns[c].bytes; pad += columns[c].elementSize)
+            out.write(zeros, columns[c].elementSize);
+        written = header.columns[c].offset + columns[c].bytes;
+    }
+    out.write(zeros, static_cast<std::streamsize>(alignUp(written) - written));
+    if (!out) throw std::runtime_error("Failed writing batch file");
+}
+
+MappedRegion::MappedRegion(const std::string& path, bool writable) {
+    int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open " + path);
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = ::mmap(nullptr, size_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // mapping keeps the file alive
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Could not mmap " + path);
+    }
+}
+
+MappedRegion::~MappedRegion() {
+    release();
+}
+
+MappedRegion::MappedRegion(MappedRegion&& other) noexcept : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedRegion& MappedRegion::operator=(MappedRegion&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedRegion::release() {
+    if (data_) ::munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void MappedRegion::sync() const {
+    if (data_) ::msync(data_, size_, MS_SYNC);
+}
+
+MappedOptionBatch::MappedOptionBatch(const std::string& path) : region_(path, false) {
+    using BatchFile::Column;
+    const auto& header = validate(region_, BOOK_MAGIC);
+    size_t padded = padToLanes(header.rows);
+    auto col = [&](Column id, uint32_t size, bool required = true) {
+        return findColumn(region_, header, id, size, required, required ? padded : 0);
+    };
+    view_.S = static_cast<const double*>(col(Column::S, sizeof(double)));
+    view_.K = static_cast<const double*>(col(Column::K, sizeof(double)));
+    view_.r = static_cast<const double*>(col(Column::r, sizeof(double)));
+    view_.sigma = static_cast<const double*>(col(Column::sigma, sizeof(double)));
+    view_.T = static_cast<const double*>(col(Column::T, sizeof(double)));
+    view_.q = static_cast<const double*>(col(Column::q, sizeof(double)));
+    view_.type = {static_cast<const uint64_t*>(col(Column::type, sizeof(uint64_t)))};
+    view_.style = {static_cast<const uint64_t*>(col(Column::style, sizeof(uint64_t)))};
+    view_.n = header.rows;
+    view_.padded = padded;
+    size_t offsetBytes = 0, charBytes = 0;
+    idOffsets_ = static_cast<const uint64_t*>(findColumn(region_, header, Column::idOffsets, sizeof(uint64_t), false,
+                                                         0, &offsetBytes));
+    idChars_ = static_cast<const char*>(findColumn(region_, header, Column::idChars, 1, false, 0, &charBytes));
+    if (idOffsets_ && !idChars_) idOffsets_ = nullptr;
+    //instrumentId trusts these without checks, so the whole table is checked once here
+    if (idOffsets_) {
+        if (offsetBytes / sizeof(uint64_t) < header.rows + 1 || idOffsets_[0] != 0)
+            throw std::runtime_error("Batch file id offsets don't cover every row");
+        for (size_t i = 0; i < header.rows; ++i)
+            if (idOffsets_[i + 1] < idOffsets_[i]) throw std::runtime_error("Batch file id offsets are not monotone");
+        if (idOffsets_[header.rows] > charBytes) throw std::runtime_error("Batch file id offsets run past the id chars");
+    }
+}
+
+std::string_view MappedOptionBatch::instrumentId(size_t i) const {
+    if (!idOffsets_) return {};
+    return {idChars_ + idOffsets_[i], static_cast<size_t>(idOffsets_[i + 1] - idOffsets_[i])};
+}
+
+MappedResultFile MappedResultFile::create(const std::string& path, size_t rows) {
+    using BatchFile::Column;
+    size_t bytes = padToLanes(rows) * sizeof(double);
+    std::vector<PendingColumn> columns;
+    for (Column id : {Column::price, Column::delta, Column::gamma, Column::theta, Column::vega, Column::rho})
+        columns.push_back({id, sizeof(double), nullptr, bytes});
+    BatchFile::Header header = makeHeader(RESULT_MAGIC, rows, columns);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) throw std::runtime_error("Could not create result file");
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out) throw std::runtime_error("Failed writing result file header");
+    }
+    // size the rest sparsely; columns are filled through the mapping
+    if (::truncate(path.c_str(), static_cast<off_t>(fileSize(header))) != 0)
+        throw std::runtime_error("Could not size result file");
+    return MappedResultFile(MappedRegion(path, true), true);
+}
+
+MappedResultFile MappedResultFile::open(const std::string& path, bool writable) {
+    return MappedResultFile(MappedRegion(path, writable), writable);
+}
+
+// the columns are held as double* either way; columns() only hands them out when the mapping is writable
+MappedResultFile::MappedResultFile(MappedRegion region, bool writable) : region_(std::move(region)), writable_(writable) {
+    using BatchFile::Column;
+    const auto& header = validate(region_, RESULT_MAGIC);
+    auto col = [&](Column id) {
+        const void* column = findColumn(region_, header, id, sizeof(double), true, padToLanes(header.rows));
+        return const_cast<double*>(static_cast<const double*>(column));
+    };
+    rows_ = header.rows;
+    columns_ = {col(Column::price), col(Column::delta), col(Column::gamma),
+                col(Column::theta), col(Column::vega), col(Column::rho)};
+}
+
+const GreekColumns& MappedResultFile::columns() const {
+    if (!writable_) throw std::logic_error("Result file is mapped read-only");
+    return columns_;
+}
+
+const double* MappedResultFile::column(BatchFile::Column id) const {
+    using BatchFile::Column;
+    switch (id) {
+        case Column::price: return columns_.price;
+        case Column::delta: return columns_.delta;
+        case Column::gamma: return columns_.gamma;
+        case Column::theta: return columns_.theta;
+        case Column::vega: return columns_.vega;
+        case Column::rho: return columns_.rho;
+        default: throw std::invalid_argument("Not a result column");
+    }
+}
@@ -0,0 +1,42 @@
+#include "shared/OptionChain.h"
+#include <algorithm>
+#include <tuple>
+
+OptionChain::OptionChain(const OptionBatchView& batch) : batch_(batch.size()), order_(batch.size()) {
+    const size_t n = batch.size();
+    //keys gathered once so the sort compares contiguous structs rather than chasing six columns per comparison
+    struct Key {
+        double S, T, r, q;
+        int style;
+        double sigma;
+        int type;
+        double K;
+        size_t row;
+        bool operator<(const Key& o) const {
+            return std::tie(S, T, r, q, style, sigma, type, K, row) < std::tie(o.S, o.T, o.r, o.q, o.style, o.sigma, o.type, o.K, o.row);
+        }
+    };
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = {batch.S[i], batch.T[i], batch.r[i], batch.q[i], static_cast<int>(batch.style[i]), batch.sigma[i],
+                   static_cast<int>(batch.type[i]), batch.K[i], i};
+    std::sort(keys.begin(), keys.end());
+    for (size_t k = 0; k < n; ++k) order_[k] = keys[k].row;
+
+    for (size_t k = 0; k < n; ++k) {
+        size_t i = order_[k];
+        batch_.S[k] = batch.S[i]; batch_.K[k] = batch.K[i]; batch_.r[k] = batch.r[i];
+        batch_.sigma[k] = batch.sigma[i]; batch_.T[k] = batch.T[i]; batch_.q[k] = batch.q[i];
+        batch_.type.set(k, batch.type[i]);
+        batch_.style.set(k, batch.style[i]);
+
+        bool same = !groups_.empty() && groups_.back().S == batch.S[i] && groups_.back().T == batch.T[i]
+                    && groups_.back().r == batch.r[i] && groups_.back().q == batch.q[i];
+        if (same) ++groups_.back().count;
+        else groups_.push_back({batch.S[i], batch.T[i], batch.r[i], batch.q[i], k, 1});
+    }
+}
+
+void OptionChain::scatter(const double* chainOrdered, double* original) const {
+    for (size_t k = 0; k < order_.size(); ++k) original[order_[k]] = chainOrdered[k];
+}
@@ -0,0 +1,105 @@
+#include "shared/OptionGenerator.h"
+#include "shared/Philox.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <omp.h>
+
+namespace {
+    // eight uniforms in (0, 1) for item `index` of one stream; 32 bits each is plenty for option parameters
+    struct Draws {
+        double u[8];
+
+        Draws(uint64_t seed, uint32_t stream, uint64_t index) {
+            for (uint32_t half = 0; half < 2; ++half) {
+                uint32_t c[4] = {static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), half, stream};
+                Philox::block(c, seed);
+                for (int w = 0; w < 4; ++w) u[4 * half + w] = (c[w] + 0.5) * (1.0 / 4294967296.0);
+            }
+        }
+    };
+
+    constexpr uint32_t ROW_STREAM = 0x524F5700, UNDERLYING_STREAM = 0x554E4400; // "ROW", "UND" + profile
+
+    double lerp(double lo, double hi, double u) { return lo + (hi - lo) * u; }
+    double logLerp(double lo, double hi, double u) { return lo * std::exp(std::log(hi / lo) * u); }
+
+    constexpr double LISTED_DAYS[] = {7, 14, 30, 61, 91, 182, 273, 365, 547, 730, 1095, 1825};
+
+    // listed strike spacing for a given spot: 1-2.5-5 steps of roughly 2.5% of spot
+    double strikeTick(double S) {
+        double raw = 0.025 * S, decade = std::pow(10.0, std::floor(std::log10(raw)));
+        for (double m : {1.0, 2.5, 5.0})
+            if (raw <= m * decade * 1.5) return m * decade;
+        return 10.0 * decade;
+    }
+
+    Option uniformRow(const Draws& d, double europeanFraction) {
+        return {lerp(90, 110, d.u[0]), lerp(90, 110, d.u[1]), lerp(0.01, 0.05, d.u[2]), lerp(0.05, 0.3, d.u[3]),
+                lerp(0.2, 2.0, d.u[4]), lerp(0.0, 0.04, d.u[5]), d.u[6] < 0.5 ? OptionType::Call : OptionType::Put,
+                d.u[7] < europeanFraction ? OptionStyle::European : OptionStyle::American};
+    }
+
+    Option stressRow(const Draws& d, double europeanFraction) {
+        double S = logLerp(1.0, 10'000.0, d.u[0]);
+        return {S, S * std::exp(lerp(-2.5, 2.5, d.u[1])), lerp(-0.01, 0.15, d.u[2]), logLerp(0.01, 2.5, d.u[3]),
+                logLerp(1.0 / 8760.0, 10.0, d.u[4]), lerp(0.0, 0.12, d.u[5]),
+                d.u[6] < 0.5 ? OptionType::Call : OptionType::Put,
+                d.u[7] < europeanFraction ? OptionStyle::European : OptionStyle::American};
+    }
+
+    Option chainRow(uint64_t i, const GeneratorConfig& config, int expiries, int strikes) {
+        const uint64_t perUnderlying = static_cast<uint64_t>(expiries) * strikes * 2;
+        const uint64_t u = i / perUnderlying, rem = i % perUnderlying;
+        const int e = static_cast<int>(rem / (2 * strikes)), k = static_cast<int>(rem / 2 % strikes);
+
+        Draws und(config.seed, UNDERLYING_STREAM | static_cast<uint32_t>(OptionProfile::Chain), u);
+        double S = logLerp(20.0, 500.0, und.u[0]), r = lerp(0.02, 0.05, und.u[1]), q = lerp(0.0, 0.03, und.u[2]);
+        double atm = lerp(0.15, 0.6, und.u[3]), skew = lerp(-0.25, -0.05, und.u[4]);
+        OptionStyle style = und.u[5] < config.europeanFraction ? OptionStyle::European : OptionStyle::American;
+
+        double T = LISTED_DAYS[e] / 365.0, F = S * std::exp((r - q) * T), tick = strikeTick(S);
+        double K = std::max(tick, (std::round(F / tick) + k - strikes / 2) * tick);
+        double m = std::log(K / F) / std::sqrt(T);
+        double sigma = std::clamp(atm * (1.0 + skew * m + 0.05 * m * m), 0.05, 3.0);
+        return {S, K, r, sigma, T, q, rem % 2 ? OptionType::Put : OptionType::Call, style};
+    }
+}
+
+void OptionGenerator::generate(OptionBatch& batch, size_t n, const GeneratorConfig& config) {
+    batch.resize(n);
+    const int expiries = std::clamp(config.expiries, 1, static_cast<int>(std::size(LISTED_DAYS)));
+    const int strikes = std::max(config.strikesPerExpiry, 1);
+    const uint32_t stream = ROW_STREAM | static_cast<uint32_t>(config.profile);
+
+    #pragma omp parallel for schedule(static) default(none) shared(batch, n, config, expiries, strikes, stream)
+    for (size_t i = 0; i < n; ++i) {
+        switch (config.profile) {
+            case OptionProfile::Uniform: batch.set(i, uniformRow(Draws(config.seed, stream, i), config.europeanFraction)); break;
+            case OptionProfile::Stress: batch.set(i, stressRow(Draws(config.seed, stream, i), config.europeanFraction)); break;
+            case OptionProfile::Chain: batch.set(i, chainRow(i, config, expiries, strikes)); break;
+        }
+    }
+}
+
+OptionBatch OptionGenerator::generate(size_t n, const GeneratorConfig& config) {
+    OptionBatch batch;
+    generate(batch, n, config);
+    return batch;
+}
+
+OptionProfile OptionGenerator::profileFromName(const std::string& name) {
+    if (name == "uniform") return OptionProfile::Uniform;
+    if (name == "chain") return OptionProfile::Chain;
+    if (name == "stress") return OptionProfile::Stress;
+    throw std::invalid_argument("Unknown option profile " + name + " (uniform, chain, stress)");
+}
+
+const char* OptionGenerator::profileName(OptionProfile profile) {
+    switch (profile) {
+        case OptionProfile::Uniform: return "uniform";
+        case OptionProfile::Chain: return "chain";
+        case OptionProfile::Stress: return "stress";
+    }
+    return "unknown";
+}
@@ -0,0 +1,225 @@
+#include "shared/PerfCounters.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <omp.h>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+    double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char* eventName(PerfEvent e) {
+        switch (e) {
+            case PerfEvent::Cycles: return "cycles";
+            case PerfEvent::Instructions: return "instructions";
+            case PerfEvent::CacheReferences: return "cache_references";
+            case PerfEvent::CacheMisses: return "cache_misses";
+            case PerfEvent::Branches: return "branches";
+            case PerfEvent::BranchMisses: return "branch_misses";
+            case PerfEvent::FpScalar: return "fp_scalar";
+            case PerfEvent::FpPacked: return "fp_packed";
+            case PerfEvent::PageFaults: return "page_faults";
+            default: return "?";
+        }
+    }
+
+    //FP_ARITH_INST_RETIRED exists on intel cores from broadwell on; other vendors would need their own codes
+    bool intelFpEvents() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned a, b, c, d;
+        if (!__get_cpuid(0, &a, &b, &c, &d)) return false;
+        return b == 0x756e6547 && d == 0x49656e69 && c == 0x6c65746e; // "GenuineIntel"
+#else
+        return false;
+#endif
+    }
+
+#if defined(__linux__)
+    struct Spec { PerfEvent event; uint32_t type; uint64_t config; };
+
+    std::vector<Spec> specs() {
+        std::vector<Spec> s = {
+            {PerfEvent::Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PerfEvent::Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PerfEvent::CacheReferences, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+            {PerfEvent::CacheMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PerfEvent::Branches, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+            {PerfEvent::BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PerfEvent::PageFaults, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        };
+        if (intelFpEvents()) {
+            //event 0xC7; umask 0x03 = scalar double | single, 0xFC = 128/256/512-bit packed double | single
+            s.push_back({PerfEvent::FpScalar, PERF_TYPE_RAW, 0x03C7});
+            s.push_back({PerfEvent::FpPacked, PERF_TYPE_RAW, 0xFCC7});
+        }
+        return s;
+    }
+
+    int open(const Spec& spec) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // user space only, which perf_event_paranoid <= 2 allows
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)); // this thread, any cpu
+    }
+#endif
+}
+
+PerfCounters::PerfCounters() {
+#if defined(__linux__)
+    const std::vector<Spec> wanted = specs();
+    std::vector<std::string> failures(wanted.size());
+    #pragma omp parallel default(none) shared(wanted, failures)
+    {
+        std::vector<Counter> mine;
+        std::vector<std::string> why(wanted.size());
+        for (size_t e = 0; e < wanted.size(); ++e) {
+            int fd = open(wanted[e]);
+            if (fd >= 0) mine.push_back({fd, wanted[e].event});
+            else why[e] = std::strerror(errno);
+        }
+        #pragma omp critical
+        {
+            counters_.insert(counters_.end(), mine.begin(), mine.end());
+            for (size_t e = 0; e < wanted.size(); ++e)
+                if (failures[e].empty()) failures[e] = why[e];
+        }
+    }
+    for (size_t e = 0; e < wanted.size(); ++e) {
+        if (failures[e].empty()) continue;
+        if (!error_.empty()) error_ += "; ";
+        error_ += std::string(eventName(wanted[e].event)) + ": " + failures[e];
+    }
+    if (!intelFpEvents()) error_ += std::string(error_.empty() ? "" : "; ") + "fp events: intel only";
+#else
+    error_ = "perf_event_open needs linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+    for (const Counter& c : counters_) close(c.fd);
+#endif
+}
+
+bool PerfCounters::available() const { return !counters_.empty(); }
+
+void PerfCounters::start() {
+#if defined(__linux__)
+    for (const Counter& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+    startSeconds_ = now();
+    for (const Counter& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+#else
+    startSeconds_ = now();
+#endif
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+#if defined(__linux__)
+    for (const Counter& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+    sample.seconds = now() - startSeconds_;
+    for (const Counter& c : counters_) {
+        uint64_t values[3]; // value, time enabled, time running
+        if (read(c.fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) continue;
+        double value = static_cast<double>(values[0]);
+        if (values[2] > 0 && values[2] < values[1]) value *= static_cast<double>(values[1]) / values[2];
+        int64_t& total = sample.count[static_cast<int>(c.event)];
+        total = (total < 0 ? 0 : total) + static_cast<int64_t>(value);
+    }
+#else
+    sample.seconds = now() - startSeconds_;
+#endif
+    return sample;
+}
+
+bool PerfCounters::enabledFromEnv() {
+    const char* v = std::getenv("PERF_COUNTERS");
+    return v && *v && std::strcmp(v, "0") != 0;
+}
+
+double PerfSample::ipc() const {
+    if (!has(PerfEvent::Cycles) || !has(PerfEvent::Instructions) || (*this)[PerfEvent::Cycles] == 0) return -1.0;
+    return (*this)[PerfEvent::Instructions] / (*this)[PerfEvent::Cycles];
+}
+
+double PerfSample::cacheMissesPerKiloInstruction() const {
+    if (!has(PerfEvent::CacheMisses) || !has(PerfEvent::Instructions) || (*this)[PerfEvent::Instructions] == 0) return -1.0;
+    return 1000.0 * (*this)[PerfEvent::CacheMisses] / (*this)[PerfEvent::Instructions];
+}
+
+double PerfSample::branchMissRate() const {
+    if (!has(PerfEvent::BranchMisses) || !has(PerfEvent::Branches) || (*this)[PerfEvent::Branches] == 0) return -1.0;
+    return (*this)[PerfEvent::BranchMisses] / (*this)[PerfEvent::Branches];
+}
+
+double PerfSample::vectorShare() const {
+    if (!has(PerfEvent::FpScalar) || !has(PerfEvent::FpPacked)) return -1.0;
+    double total = (*this)[PerfEvent::FpScalar] + (*this)[PerfEvent::FpPacked];
+    return total > 0 ? (*this)[PerfEvent::FpPacked] / total : -1.0;
+}
+
+std::string PerfSample::summary(size_t options) const {
+    const double n = options > 0 ? static_cast<double>(options) : 1.0;
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(1);
+    auto perOption = [&](const char* label, PerfEvent e) {
+        out << label << "/opt ";
+        if (has(e)) out << (*this)[e] / n;
+        else out << "n/a";
+        out << "  ";
+    };
+    auto ratio = [&](const char* label, double v, double scale) {
+        out << label << " ";
+        if (v >= 0) out << v * scale;
+        else out << "n/a";
+        out << "  ";
+    };
+    perOption("cycles", PerfEvent::Cycles);
+    perOption("instr", PerfEvent::Instructions);
+    out.precision(2);
+    ratio("IPC", ipc(), 1.0);
+    perOption("llc-miss", PerfEvent::CacheMisses);
+    ratio("MPKI", cacheMissesPerKiloInstruction(), 1.0);
+    ratio("br-miss%", branchMissRate(), 100.0);
+    perOption("fp-packed", PerfEvent::FpPacked);
+    ratio("packed%", vectorShare(), 100.0);
+    out.precision(4);
+    perOption("faults", PerfEvent::PageFaults);
+    return out.str();
+}
+
+std::string PerfSample::json(size_t options) const {
+    const double n = options > 0 ? static_cast<double>(options) : 1.0;
+    std::ostringstream out;
+    out.precision(6);
+    bool first = true;
+    auto put = [&](const std::string& key, double v) {
+        out << (first ? "" : ", ") << "\"" << key << "\": " << v;
+        first = false;
+    };
+    for (int e = 0; e < EVENTS; ++e)
+        if (count[e] >= 0) put(std::string(eventName(static_cast<PerfEvent>(e))) + "_per_option", count[e] / n);
+    if (ipc() >= 0) put("ipc", ipc());
+    if (vectorShare() >= 0) put("packed_fp_share", vectorShare());
+    return out.str();
+}
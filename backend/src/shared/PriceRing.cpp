@@ -0,0 +1,202 @@
+#include "shared/PriceRing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char RING_MAGIC[8] = {'O', 'P', 'T', 'R', 'I', 'N', 'G', '1'};
+
+    std::string shmName(const std::string& name) {
+        if (name.empty()) throw std::invalid_argument("Price ring needs a name");
+        return name[0] == '/' ? name : "/" + name;
+    }
+
+    size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    PriceRing::Slot* slotsAfter(void* data) {
+        return reinterpret_cast<PriceRing::Slot*>(static_cast<char*>(data) + sizeof(PriceRing::Header));
+    }
+}
+
+size_t PriceRing::bytesFor(size_t capacity) {
+    return sizeof(Header) + capacity * sizeof(Slot);
+}
+
+int64_t PriceRing::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PricePublisher::PricePublisher(const std::string& name, size_t capacity, bool unlinkOnClose)
+    : name_(shmName(name)), unlink_(unlinkOnClose), mask_(roundUpPow2(std::max<size_t>(capacity, 1)) - 1) {
+    //a fresh object every time: truncating one that readers still map would SIGBUS them
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) throw std::runtime_error("Could not create shared memory " + name_);
+    size_ = PriceRing::bytesFor(mask_ + 1);
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("Could not size shared memory " + name_);
+    }
+    data_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // mapping keeps the object alive
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("Could not mmap shared memory " + name_);
+    }
+
+    //ftruncate zero-fills: every slot starts at version 0 (never written) and head at 0.
+    //magic goes in last, so a reader that sees it also sees the rest of the header
+    header_ = static_cast<PriceRing::Header*>(data_);
+    slots_ = slotsAfter(data_);
+    header_->version = PriceRing::VERSION;
+    header_->recordBytes = sizeof(PriceRing::Record);
+    header_->capacity = mask_ + 1;
+    //touch every page now, so the first lap doesn't take a page fault per 32 records
+    for (size_t i = 0; i <= mask_; ++i) slots_[i].version.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, RING_MAGIC, sizeof(RING_MAGIC));
+}
+
+PricePublisher::~PricePublisher() {
+    if (data_) ::munmap(data_, size_);
+    if (unlink_) ::shm_unlink(name_.c_str());
+}
+
+void PricePublisher::write(const PriceRing::Record& record) {
+    PriceRing::Slot& slot = slots_[record.seq & mask_];
+    uint64_t words[PriceRing::RECORD_WORDS];
+    std::memcpy(words, &record, sizeof(words));
+
+    //seqlock: odd while writing; the release fence keeps the payload stores after the odd version
+    slot.version.store(2 * record.seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t w = 0; w < PriceRing::RECORD_WORDS; ++w) slot.words[w].store(words[w], std::memory_order_relaxed);
+    slot.version.store(2 * record.seq + 2, std::memory_order_release);
+    header_->head.store(record.seq + 1, std::memory_order_release);
+}
+
+uint64_t PricePublisher::publish(uint64_t instrument, double price, const Greeks* greeks, int64_t timestampNs) {
+    const double none = std::numeric_limits<double>::quiet_NaN();
+    PriceRing::Record record{instrument, next_++, timestampNs, price, none, none, none, none, none};
+    if (greeks) {
+        record.delta = greeks->delta;
+        record.gamma = greeks->gamma;
+        record.theta = greeks->theta;
+        record.vega = greeks->vega;
+        record.rho = greeks->rho;
+    }
+    write(record);
+    return record.seq;
+}
+
+uint64_t PricePublisher::publishBatch(const GreekColumns& columns, size_t count, uint64_t firstInstrument) {
+    const double none = std::numeric_limits<double>::quiet_NaN();
+    const int64_t timestamp = PriceRing::now();
+    const uint64_t first = next_;
+    for (size_t i = 0; i < count; ++i) {
+        PriceRing::Record record{firstInstrument + i, next_++, timestamp,
+                                 columns.price ? columns.price[i] : none,
+                                 columns.delta ? columns.delta[i] : none,
+                                 columns.gamma ? columns.gamma[i] : none,
+                                 columns.theta ? columns.theta[i] : none,
+                                 columns.vega ? columns.vega[i] : none,
+                                 columns.rho ? columns.rho[i] : none};
+        write(record);
+    }
+    return first;
+}
+
+PriceReader::PriceReader(const std::string& name, bool fromOldest) {
+    const std::string path = shmName(name);
+    int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw std::runtime_error("Could not open shared memory " + path);
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PriceRing::Header)) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory " + path + " is not a price ring");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Could not mmap shared memory " + path);
+    }
+
+    header_ = static_cast<const PriceRing::Header*>(data_);
+    const char* problem = nullptr;
+    if (std::memcmp(header_->magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0) problem = " is not a price ring (or not initialised yet)";
+    else if (header_->version != PriceRing::VERSION || header_->recordBytes != sizeof(PriceRing::Record))
+        problem = " was written by an incompatible version";
+    else if (header_->capacity == 0 || (header_->capacity & (header_->capacity - 1)) != 0 ||
+             PriceRing::bytesFor(header_->capacity) > size_)
+        problem = " is truncated";
+    if (problem) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        throw std::runtime_error("Shared memory " + path + problem);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    slots_ = slotsAfter(data_);
+    mask_ = header_->capacity - 1;
+
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    next_ = !fromOldest ? head : head > capacity() ? head - capacity() : 0;
+}
+
+PriceReader::~PriceReader() {
+    if (data_) ::munmap(data_, size_);
+}
+
+uint64_t PriceReader::available() const {
+    return header_->head.load(std::memory_order_acquire) - next_;
+}
+
+bool PriceReader::next(PriceRing::Record& out) {
+    while (true) {
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        if (next_ >= head) return false;
+        //lapped: everything older than head - capacity is gone already
+        if (head - next_ > capacity()) {
+            lost_ += head - capacity() - next_;
+            next_ = head - capacity();
+        }
+
+        const PriceRing::Slot& slot = slots_[next_ & mask_];
+        const uint64_t expected = 2 * next_ + 2;
+        uint64_t words[PriceRing::RECORD_WORDS];
+        uint64_t before = slot.version.load(std::memory_order_acquire);
+        for (size_t w = 0; w < PriceRing::RECORD_WORDS; ++w) words[w] = slot.words[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = slot.version.load(std::memory_order_relaxed);
+
+        //anything but the completed version of this seq means the writer came round again
+        if (before != expected || after != expected) {
+            ++lost_;
+            ++next_;
+            continue;
+        }
+        std::memcpy(&out, words, sizeof(words));
+        ++next_;
+        return true;
+    }
+}
+
+size_t PriceReader::poll(PriceRing::Record* out, size_t max) {
+    size_t n = 0;
+    while (n < max && next(out[n])) ++n;
+    return n;
+}
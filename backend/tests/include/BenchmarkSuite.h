@@ -0,0 +1,87 @@
+#ifndef PERFORMANCE_TEST_BENCHMARKSUITE_H
+#define PERFORMANCE_TEST_BENCHMARKSUITE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "shared/OptionGenerator.h"
+#include "shared/PerfCounters.h"
+
+struct BenchmarkConfig {
+    int warmup = 2;
+    int repetitions = 10;
+    std::vector<size_t> sizes{10'000, 100'000, 1'000'000};
+    std::vector<int> threads;       // empty: omp_get_max_threads() only
+    std::string filter;             // substring of the case name; empty runs everything
+    uint64_t seed = 42;             // inputs are regenerated from this per (case, size), so runs are comparable
+    OptionProfile profile = OptionProfile::Uniform; // book shape for cases that don't need a specific one
+    std::string jsonPath;           // write results here if set
+    std::string baselinePath;       // compare medians against a previous json run if set
+    double tolerance = 0.10;        // median slowdown (fraction) reported as a regression
+    bool counters = false;          // hardware counters over the timed repetitions (PerfCounters)
+    std::string isa;                // force a Kernels level (baseline, sse4.2, avx2, avx512); empty: CpuDispatch's pick
+    int pareto = 0;                 // > 0: run benchmarkAmericanPareto on this many options instead of the suite
+    int allocations = 0;            // > 0: run checkSteadyStateAllocations on this many options instead of the suite
+    int ring = 0;                   // > 0: run benchmarkPriceRing with this many records instead of the suite
+    int server = 0;                 // > 0: run benchmarkPricingServer with this many requests per client instead of the suite
+    int shard = 0;                  // > 0: run benchmarkShardedPricing on this many rows instead of the suite
+    std::string study;              // one-shot study by name (--study list prints them) instead of the suite
+    int studySize = 0;              // its book size; 0: the study's default
+};
+
+// wall clock per repetition, milliseconds
+struct BenchmarkStats {
+    double min = 0, median = 0, mean = 0, stddev = 0, p90 = 0, max = 0;
+
+    static BenchmarkStats from(std::vector<double> samples);
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t size = 0;
+    int threads = 1;
+    int repetitions = 0;
+    BenchmarkStats ms;
+    double nsPerOption = 0;     // from the median
+    double optionsPerSecond = 0;
+    bool hasCounters = false;
+    PerfSample counters;        // totals over all repetitions; per option = count / (size * repetitions)
+};
+
+// prepare(n, seed) builds inputs outside the timed region and returns the work to time.
+// maxSize caps the sweep for slow pricers (a lattice at 1M rows would take minutes); the cap itself is run
+// when every requested size is above it
+struct BenchmarkCase {
+    std::string name;
+    size_t maxSize;
+    std::function<std::function<void()>(size_t n, uint64_t seed)> prepare;
+};
+
+class BenchmarkSuite {
+public:
+    explicit BenchmarkSuite(BenchmarkConfig config) : config_(std::move(config)) {}
+
+    void add(BenchmarkCase c) { cases_.push_back(std::move(c)); }
+    const std::vector<BenchmarkCase>& cases() const { return cases_; }
+    const BenchmarkConfig& config() const { return config_; }
+
+    // runs the selected cases over the size x thread sweep, printing one line per result
+    std::vector<BenchmarkResult> run() const;
+
+    void writeJson(const std::vector<BenchmarkResult>& results, const std::string& path) const;
+    // one line per matching (name, size, threads); returns how many regressed past the tolerance
+    int compare(const std::vector<BenchmarkResult>& results, const std::string& baselinePath) const;
+
+private:
+    BenchmarkConfig config_;
+    std::vector<BenchmarkCase> cases_;
+};
+
+// every pricer and batch path: black-scholes scalar/simd/float, dispatcher variants, BAW, binomial, PDE, chains;
+// plus book generation itself
+void registerPricingBenchmarks(BenchmarkSuite& suite);
+// parses --flag value pairs (see performance_test --help); throws std::invalid_argument on bad input
+BenchmarkConfig parseBenchmarkArgs(int argc, char** argv, bool& listOnly, bool& help);
+
+#endif //PERFORMANCE_TEST_BENCHMARKSUITE_H
@@ -6,12 +6,29 @@
 #define PERFORMANCE_TEST_DISPATCHERBENCHMARKS_H
 
 #include "shared/Option.h"
+#include "shared/OptionGenerator.h"
 #include <vector>
+#include <string>
 using AmericanPricerFn = double(*)(const Option&, int);
 
 void benchmarkDispatcherSeparateStyle(int numEuropean, int numAmerican);
 void benchmarkDispatcherMixedStyle(int numEuropean, int numAmerican);
 std::vector<double> benchmarkParallelization(AmericanPricerFn americanPricer, int numEuropean = 0, int numAmerican = 0, std::vector<Option> allOptions = {});
 void benchmarkBlackScholesSIMD(int numEuropean);
+void benchmarkChebyshevSurrogate(int numAmerican, int buildSteps = 500, int referenceSteps = 1000);
+void benchmarkMappedBatchFile(int numOptions, const std::string& bookPath = "book.optb", const std::string& resultPath = "book.res");
+void benchmarkFloatPrecision(int numEuropean, int numAmerican, int binomialSteps = 500);
+void benchmarkScenarioGrid(int numEuropean, int numAmerican, int spotSteps = 21, int volSteps = 11, int numUnderlyings = 50);
+void benchmarkAdaptiveSelection(int numCalibration, int numAmerican, double tolerance = 1e-4, int referenceSteps = 2000);
+void benchmarkCrankNicolson(int numAmerican, int referenceSteps = 5000);
+void benchmarkLongstaffSchwartz(int numEuropean, int numAmerican, size_t paths = 1 << 14, int exerciseDates = 50, int referenceSteps = 2000);
+void benchmarkDiscreteDividends(int numAmerican, int steps = 1000, int referenceSteps = 8000);
+void benchmarkOptionChain(int numUnderlyings = 200, int numExpiries = 12, int numStrikes = 50, int binomialUnderlyings = 4, int steps = 1000);
+void benchmarkMultiStrike(int numStrikes = 50, int steps = 1000, int repetitions = 20);
+void benchmarkAmericanPareto(int numAmerican = 200, int referenceSteps = 20001, const std::string& csvPath = "american_pareto.csv",
+                             OptionProfile profile = OptionProfile::Uniform, uint64_t seed = 42);
+//heap allocations per tick of each buffer-based pricing path once warm (expected 0); needs an OPTIONS_COUNT_ALLOCATIONS
+//build. returns the number of paths that allocated
+int checkSteadyStateAllocations(int numOptions = 10'000, int ticks = 5, uint64_t seed = 42);
 
 #endif //PERFORMANCE_TEST_DISPATCHERBENCHMARKS_H
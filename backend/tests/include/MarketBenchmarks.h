@@ -0,0 +1,7 @@
+#ifndef PERFORMANCE_TEST_MARKETBENCHMARKS_H
+#define PERFORMANCE_TEST_MARKETBENCHMARKS_H
+
+void benchmarkVolSurface(int numExpiries = 12, int strikesPerExpiry = 60, int numTicks = 200, int numRows = 1'000'000);
+void benchmarkMarketCurves(int numEuropean, int numAmerican, int numExpiries = 12);
+
+#endif //PERFORMANCE_TEST_MARKETBENCHMARKS_H
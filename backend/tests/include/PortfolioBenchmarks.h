@@ -0,0 +1,7 @@
+#ifndef PERFORMANCE_TEST_PORTFOLIOBENCHMARKS_H
+#define PERFORMANCE_TEST_PORTFOLIOBENCHMARKS_H
+
+void benchmarkPortfolioGreeks(int numEuropean, int numAmerican, int numUnderlyings = 50, int steps = 200, int numUpdates = 1000);
+void benchmarkMonteCarloVaR(int numEuropean, int numAmerican, int numScenarios, int numUnderlyings = 20, bool useSurrogate = false);
+
+#endif //PERFORMANCE_TEST_PORTFOLIOBENCHMARKS_H
@@ -0,0 +1,8 @@
+#ifndef PERFORMANCE_TEST_PUBLISHBENCHMARKS_H
+#define PERFORMANCE_TEST_PUBLISHBENCHMARKS_H
+
+#include <cstddef>
+
+void benchmarkPriceRing(size_t records = 1'000'000, int readers = 2, size_t capacity = 1 << 16);
+
+#endif //PERFORMANCE_TEST_PUBLISHBENCHMARKS_H
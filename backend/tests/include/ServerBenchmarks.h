@@ -0,0 +1,9 @@
+#ifndef PERFORMANCE_TEST_SERVERBENCHMARKS_H
+#define PERFORMANCE_TEST_SERVERBENCHMARKS_H
+
+#include <cstddef>
+
+void benchmarkPricingServer(int requestsPerClient = 200, int clients = 4, size_t rowsPerRequest = 256, int pipeline = 8);
+void benchmarkShardedPricing(size_t rows = 200'000, int workers = 3);
+
+#endif //PERFORMANCE_TEST_SERVERBENCHMARKS_H
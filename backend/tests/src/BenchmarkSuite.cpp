@@ -0,0 +1,353 @@
+#include "BenchmarkSuite.h"
+#include "market/Curves.h"
+#include "pricing/BAW.h"
+#include "pricing/BlackScholes.h"
+#include "pricing/ChainPricer.h"
+#include "pricing/CrankNicolson.h"
+#include "pricing/PricingDispatcher.h"
+#include "shared/BenchmarkUtils.h"
+#include "shared/CpuDispatch.h"
+#include "shared/OptionBatch.h"
+#include "shared/OptionChain.h"
+#include "shared/OptionGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <omp.h>
+
+BenchmarkStats BenchmarkStats::from(std::vector<double> samples) {
+    BenchmarkStats s;
+    if (samples.empty()) return s;
+    std::sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+    s.min = samples.front();
+    s.max = samples.back();
+    s.median = n % 2 ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    s.p90 = samples[std::min(n - 1, static_cast<size_t>(std::ceil(0.9 * n)) - 1)];
+    s.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+    double var = 0.0;
+    for (double x : samples) var += (x - s.mean) * (x - s.mean);
+    s.stddev = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+    return s;
+}
+
+std::vector<BenchmarkResult> BenchmarkSuite::run() const {
+    std::vector<int> threads = config_.threads;
+    if (threads.empty()) threads.push_back(omp_get_max_threads());
+    const int defaultThreads = omp_get_max_threads();
+    bool warned = false;
+
+    std::vector<BenchmarkResult> results;
+    std::cout << "kernels: " << CpuDispatch::name(CpuDispatch::active()) << " (cpu supports "
+              << CpuDispatch::name(CpuDispatch::detected()) << ")\n";
+    std::cout << std::left << std::setw(38) << "case" << std::right << std::setw(10) << "size" << std::setw(5) << "thr"
+              << std::setw(12) << "median ms" << std::setw(10) << "stddev" << std::setw(12) << "min ms"
+              << std::setw(12) << "ns/option" << std::setw(12) << "Mopt/s" << "\n";
+    for (const BenchmarkCase& c : cases_) {
+        if (!config_.filter.empty() && c.name.find(config_.filter) == std::string::npos) continue;
+        std::vector<size_t> sizes;
+        for (size_t n : config_.sizes)
+            if (n <= c.maxSize) sizes.push_back(n);
+        if (sizes.empty()) sizes.push_back(c.maxSize);
+
+        for (size_t n : sizes) {
+            std::function<void()> work = c.prepare(n, config_.seed);
+            for (int t : threads) {
+                omp_set_num_threads(t);
+                for (int w = 0; w < config_.warmup; ++w) work();
+                //opened after the thread count is set so every omp worker gets counters; toggling them is a few
+                //ioctls, small next to a repetition
+                std::unique_ptr<PerfCounters> counters;
+                if (config_.counters) {
+                    counters = std::make_unique<PerfCounters>();
+                    if (!warned && !counters->error().empty()) std::cerr << "counters missing: " << counters->error() << "\n";
+                    warned = true;
+                    counters->start();
+                }
+                std::vector<double> samples;
+                for (int rep = 0; rep < config_.repetitions; ++rep) {
+                    auto start = std::chrono::steady_clock::now();
+                    work();
+                    samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                }
+                BenchmarkResult r;
+                if (counters) {
+                    r.counters = counters->stop();
+                    r.hasCounters = true;
+                }
+                r.name = c.name;
+                r.size = n;
+                r.threads = t;
+                r.repetitions = config_.repetitions;
+                r.ms = BenchmarkStats::from(samples);
+                r.nsPerOption = r.ms.median * 1e6 / n;
+                r.optionsPerSecond = r.ms.median > 0 ? n / (r.ms.median * 1e-3) : 0.0;
+                std::cout << std::left << std::setw(38) << r.name << std::right << std::setw(10) << n << std::setw(5) << t
+                          << std::fixed << std::setprecision(3) << std::setw(12) << r.ms.median << std::setw(10)
+                          << r.ms.stddev << std::setw(12) << r.ms.min << std::setprecision(1) << std::setw(12)
+                          << r.nsPerOption << std::setprecision(2) << std::setw(12) << r.optionsPerSecond * 1e-6
+                          << std::defaultfloat << "\n";
+                if (r.hasCounters) std::cout << "    " << r.counters.summary(n * r.repetitions) << "\n";
+                results.push_back(r);
+            }
+        }
+    }
+    omp_set_num_threads(defaultThreads);
+    return results;
+}
+
+void BenchmarkSuite::writeJson(const std::vector<BenchmarkResult>& results, const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write benchmark results to " + path);
+    out << std::setprecision(10);
+    out << "{\n  \"suite\": \"performance_test\",\n  \"compiler\": \"" << __VERSION__ << "\",\n"
+        << "  \"isa\": \"" << CpuDispatch::name(CpuDispatch::active()) << "\",\n"
+        << "  \"max_threads\": " << omp_get_max_threads() << ",\n  \"seed\": " << config_.seed << ",\n"
+        << "  \"warmup\": " << config_.warmup << ",\n  \"repetitions\": " << config_.repetitions << ",\n"
+        << "  \"results\": [\n";
+    //one result per line; compare() relies on it
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"threads\": " << r.threads
+            << ", \"repetitions\": " << r.repetitions << ", \"min_ms\": " << r.ms.min << ", \"median_ms\": " << r.ms.median
+            << ", \"mean_ms\": " << r.ms.mean << ", \"stddev_ms\": " << r.ms.stddev << ", \"p90_ms\": " << r.ms.p90
+            << ", \"max_ms\": " << r.ms.max << ", \"ns_per_option\": " << r.nsPerOption
+            << ", \"options_per_sec\": " << r.optionsPerSecond;
+        if (r.hasCounters) out << ", \"counters\": {" << r.counters.json(r.size * r.repetitions) << "}";
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+namespace {
+    std::string field(const std::string& line, const std::string& key) {
+        size_t at = line.find("\"" + key + "\":");
+        if (at == std::string::npos) return {};
+        at = line.find_first_not_of(' ', at + key.size() + 3);
+        if (at == std::string::npos) return {}; // key with no value: the line is truncated
+        if (line[at] == '"') return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+        return line.substr(at, line.find_first_of(",}", at) - at);
+    }
+}
+
+int BenchmarkSuite::compare(const std::vector<BenchmarkResult>& results, const std::string& baselinePath) const {
+    std::ifstream in(baselinePath);
+    if (!in) throw std::runtime_error("Cannot read baseline " + baselinePath);
+    std::map<std::tuple<std::string, size_t, int>, double> baseline;
+    for (std::string line; std::getline(in, line);) {
+        std::string name = field(line, "name"), size = field(line, "size"), threads = field(line, "threads");
+        std::string median = field(line, "median_ms");
+        if (name.empty() || size.empty() || threads.empty() || median.empty()) continue; // not a complete result entry
+        baseline[{name, std::stoull(size), std::stoi(threads)}] = std::stod(median);
+    }
+
+    int regressions = 0;
+    std::cout << "\n[Against " << baselinePath << ", tolerance " << config_.tolerance * 100 << "%]\n";
+    for (const BenchmarkResult& r : results) {
+        auto it = baseline.find({r.name, r.size, r.threads});
+        if (it == baseline.end()) continue;
+        double ratio = r.ms.median / it->second;
+        const char* verdict = ratio > 1.0 + config_.tolerance ? "REGRESSION" : ratio < 1.0 - config_.tolerance ? "faster" : "";
+        if (ratio > 1.0 + config_.tolerance) ++regressions;
+        std::cout << std::left << std::setw(38) << r.name << std::right << std::setw(10) << r.size << std::setw(5) << r.threads
+                  << std::fixed << std::setprecision(3) << std::setw(12) << it->second << " -> " << std::setw(10)
+                  << r.ms.median << std::setprecision(2) << std::setw(8) << ratio << "x " << verdict << std::defaultfloat << "\n";
+    }
+    return regressions;
+}
+
+namespace {
+    //inputs owned by the returned closure
+    template<typename Inputs, typename Body>
+    std::function<void()> bind(Inputs inputs, Body body) {
+        auto owned = std::make_shared<Inputs>(std::move(inputs));
+        return [owned, body]() { body(*owned); };
+    }
+}
+
+void registerPricingBenchmarks(BenchmarkSuite& suite) {
+    const size_t unlimited = static_cast<size_t>(-1);
+    const OptionProfile profile = suite.config().profile;
+    struct Rows {
+        OptionBatch batch;
+        std::vector<Option> options; // AoS copy for the scalar paths
+        std::vector<double> out;
+    };
+    auto rows = [](size_t n, uint64_t seed, double europeanFraction, OptionProfile shape) {
+        GeneratorConfig config;
+        config.profile = shape;
+        config.seed = seed;
+        config.europeanFraction = europeanFraction;
+        Rows r{OptionGenerator::generate(n, config), std::vector<Option>(n), std::vector<double>(n)};
+        for (size_t i = 0; i < n; ++i) r.options[i] = r.batch.get(i);
+        return r;
+    };
+    //most cases run on the configured profile; chain/curve cases need the listed-chain shape
+    auto book = [=](size_t n, uint64_t seed, double europeanFraction) { return rows(n, seed, europeanFraction, profile); };
+    auto chain = [=](size_t n, uint64_t seed, double europeanFraction) {
+        return rows(n, seed, europeanFraction, OptionProfile::Chain);
+    };
+
+    suite.add({"bs/scalar", unlimited, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 1.0), [](Rows& r) {
+            const size_t N = r.options.size();
+            #pragma omp parallel for default(none) shared(r, N)
+            for (size_t i = 0; i < N; ++i) r.out[i] = BlackScholes::price(r.options[i]);
+        });
+    }});
+    suite.add({"bs/batch_simd", unlimited, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 1.0), [](Rows& r) { r.out = PricingDispatcher::priceBatchBlackScholesSIMD(r.batch); });
+    }});
+    suite.add({"bs/batch_simd_float", unlimited, [=](size_t n, uint64_t seed) {
+        return bind(convertBatch<float>(book(n, seed, 1.0).batch), [](OptionBatchF& b) {
+            volatile float sink = PricingDispatcher::priceBatchBlackScholesSIMD(b)[0];
+            (void)sink;
+        });
+    }});
+    suite.add({"dispatcher/priceBatch_european", unlimited, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 1.0), [](Rows& r) { PricingDispatcher::priceBatch(r.batch.view(), r.out.data()); });
+    }});
+    suite.add({"dispatcher/priceBatch_mixed", unlimited, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 0.5), [](Rows& r) { PricingDispatcher::priceBatch(r.batch.view(), r.out.data()); });
+    }});
+    suite.add({"baw/priceParallelized", 1'000'000, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 0.0), [](Rows& r) { r.out = PricingDispatcher::priceParallelized(r.options, &BAW::price); });
+    }});
+    suite.add({"binomial/workspace_1000", 2'000, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 0.0), [](Rows& r) { r.out = PricingDispatcher::priceBatchBinomialWorkspace(r.options, 1000); });
+    }});
+    suite.add({"dispatcher/priceBatchBinomial_mixed_1000", 2'000, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 0.5), [](Rows& r) { PricingDispatcher::priceBatchBinomial(r.batch.view(), r.out.data(), 1000); });
+    }});
+    //same american book at the same step count through the runtime lattice (workspace path, never the fixed table)
+    //and the fixed-step instantiation
+    for (int steps : {128, 512, 1000}) {
+        suite.add({"binomial/runtime_" + std::to_string(steps), 2'000, [=](size_t n, uint64_t seed) {
+            return bind(book(n, seed, 0.0),
+                        [steps](Rows& r) { PricingDispatcher::priceBatchBinomialWorkspace(r.options, r.out.data(), steps); });
+        }});
+        suite.add({"binomial/fixed_" + std::to_string(steps), 2'000, [=](size_t n, uint64_t seed) {
+            return bind(book(n, seed, 0.0),
+                        [steps](Rows& r) { PricingDispatcher::priceBatchBinomial(r.batch.view(), r.out.data(), steps); });
+        }});
+    }
+    suite.add({"dispatcher/priceAndGreeksBatch_mixed_200", 2'000, [=](size_t n, uint64_t seed) {
+        struct Greeks { Rows rows; std::vector<double> columns[6]; };
+        Greeks g{book(n, seed, 0.5), {}};
+        for (auto& c : g.columns) c.resize(n);
+        return bind(std::move(g), [](Greeks& g) {
+            GreekColumns out{g.columns[0].data(), g.columns[1].data(), g.columns[2].data(), g.columns[3].data(),
+                             g.columns[4].data(), g.columns[5].data()};
+            PricingDispatcher::priceAndGreeksBatch(g.rows.batch.view(), out, 200);
+        });
+    }});
+    suite.add({"pde/crank_nicolson_200x100", 100'000, [=](size_t n, uint64_t seed) {
+        return bind(book(n, seed, 0.0), [](Rows& r) { CrankNicolson::priceBatch(r.batch.view(), r.out.data()); });
+    }});
+
+    struct Chain {
+        OptionChain chain;
+        std::vector<double> out;
+    };
+    suite.add({"chain/priceBatch_european", unlimited, [=](size_t n, uint64_t seed) {
+        return bind(Chain{OptionChain(chain(n, seed, 1.0).batch.view()), std::vector<double>(n)},
+                    [](Chain& c) { ChainPricer::priceBatch(c.chain, c.out.data()); });
+    }});
+    suite.add({"chain/priceBatchBinomial_1000", 2'000, [=](size_t n, uint64_t seed) {
+        return bind(Chain{OptionChain(chain(n, seed, 0.0).batch.view()), std::vector<double>(n)},
+                    [](Chain& c) { ChainPricer::priceBatchBinomial(c.chain, c.out.data(), 1000); });
+    }});
+
+    struct Bucketed {
+        Rows rows;
+        ExpiryBuckets buckets;
+    };
+    suite.add({"curves/bucketed_priceBatch", unlimited, [=](size_t n, uint64_t seed) {
+        Rows r = chain(n, seed, 1.0);
+        MarketCurves curves(RateCurve({0.25, 1.0, 2.0}, {0.03, 0.035, 0.04}), RateCurve(0.01));
+        ExpiryBuckets buckets = curves.buckets(r.batch.view());
+        return bind(Bucketed{std::move(r), std::move(buckets)}, [](Bucketed& b) {
+            PricingDispatcher::priceBatch(b.rows.batch.view(), b.buckets, b.rows.out.data());
+        });
+    }});
+
+    //book generation: AoS single-threaded RandomGenerator + toBatch vs the parallel SoA generator per profile
+    suite.add({"generator/legacy_aos", unlimited, [](size_t n, uint64_t seed) {
+        return std::function<void()>([n, seed]() {
+            OptionBatch batch = toBatch(generateMixedOptions(static_cast<int>(n / 2), static_cast<int>(n - n / 2), seed));
+        });
+    }});
+    for (OptionProfile p : {OptionProfile::Uniform, OptionProfile::Chain, OptionProfile::Stress}) {
+        suite.add({std::string("generator/") + OptionGenerator::profileName(p), unlimited, [p](size_t n, uint64_t seed) {
+            GeneratorConfig config;
+            config.profile = p;
+            config.seed = seed;
+            return bind(OptionBatch(), [n, config](OptionBatch& batch) { OptionGenerator::generate(batch, n, config); });
+        }});
+    }
+}
+
+namespace {
+    template<typename T>
+    std::vector<T> parseList(const std::string& text) {
+        std::vector<T> values;
+        std::stringstream ss(text);
+        for (std::string item; std::getline(ss, item, ',');) {
+            if (item.empty()) continue;
+            double v = std::stod(item);
+            if (!(v > 0)) throw std::invalid_argument("List values must be positive: " + text);
+            values.push_back(static_cast<T>(v));
+        }
+        return values;
+    }
+}
+
+BenchmarkConfig parseBenchmarkArgs(int argc, char** argv, bool& listOnly, bool& help) {
+    BenchmarkConfig config;
+    listOnly = help = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--list") { listOnly = true; continue; }
+        if (arg == "--counters") { config.counters = true; continue; }
+        if (arg == "--help" || arg == "-h") { help = true; continue; }
+        if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+        std::string value = argv[++i];
+        if (arg == "--filter") config.filter = value;
+        else if (arg == "--sizes") config.sizes = parseList<size_t>(value);
+        else if (arg == "--threads") config.threads = parseList<int>(value);
+        else if (arg == "--reps") config.repetitions = std::max(1, std::stoi(value));
+        else if (arg == "--warmup") config.warmup = std::max(0, std::stoi(value));
+        else if (arg == "--seed") config.seed = std::stoull(value);
+        else if (arg == "--profile") config.profile = OptionGenerator::profileFromName(value);
+        else if (arg == "--isa") {
+            config.isa = value;
+            CpuDispatch::fromName(value); // reject typos here
+        }
+        else if (arg == "--pareto") config.pareto = std::max(1, std::stoi(value));
+        else if (arg == "--allocations") config.allocations = std::max(1, std::stoi(value));
+        else if (arg == "--ring") config.ring = std::max(1, std::stoi(value));
+        else if (arg == "--server") config.server = std::max(1, std::stoi(value));
+        else if (arg == "--shard") config.shard = std::max(1, std::stoi(value));
+        else if (arg == "--study") {
+            //name or name=N
+            size_t eq = value.find('=');
+            config.study = value.substr(0, eq);
+            if (eq != std::string::npos) config.studySize = std::max(1, std::stoi(value.substr(eq + 1)));
+        }
+        else if (arg == "--json") config.jsonPath = value;
+        else if (arg == "--baseline") config.baselinePath = value;
+        else if (arg == "--tolerance") config.tolerance = std::stod(value);
+        else throw std::invalid_argument("Unknown option " + arg);
+    }
+    return config;
+}
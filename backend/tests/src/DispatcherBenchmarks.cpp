@@ -6,10 +6,27 @@
 #include "shared/BenchmarkUtils.h"
 #include "shared/OptionBatch.h"
 #include "pricing/PricingDispatcher.h"
+#include "pricing/AdaptiveSelector.h"
+#include "pricing/ChebyshevSurrogate.h"
+#include "pricing/ScenarioEngine.h"
+#include "pricing/LongstaffSchwartz.h"
+#include "pricing/CrankNicolson.h"
+#include "pricing/ChainPricer.h"
+#include "pricing/BlackScholes.h"
+#include "pricing/JuZhong.h"
+#include "shared/OptionBatchFile.h"
+#include "shared/AllocationCounter.h"
+#include "TestUtils.h"
 
 #include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <vector>
+#include <cmath>
+#include <algorithm>
+#include <random>
 
 //one by one, no parallelization
 void benchmarkDispatcherSeparateStyle(int numEuropean, int numAmerican) {
@@ -54,3 +71,644 @@ void benchmarkBlackScholesSIMD(int numEuropean) {
     double totalTime = std::chrono::duration<double, std::milli>(end - start).count();
     std::cout << "Total Time (Black-Scholes SIMD): " << totalTime << " ms\n";
 }
+
+//calibrate on one random book, then check adaptive routing on another against the reference tree
+void benchmarkAdaptiveSelection(int numCalibration, int numAmerican, double tolerance, int referenceSteps) {
+    AdaptiveModelSelector selector(tolerance);
+    std::vector<Option> sample = generateOptions(numCalibration, OptionStyle::American);
+    benchmark("Calibrate adaptive selector", [&]() {
+        selector.calibrate(sample, referenceSteps);
+        return 0.0;
+    });
+
+    //a different seed than the calibration book, so this is out of sample
+    std::vector<Option> options = generateOptions(numAmerican, OptionStyle::American, RandomGenerator::DEFAULT_SEED + 1);
+    OptionBatch batch = toBatch(options);
+
+    std::vector<double> reference(options.size());
+    #pragma omp parallel for schedule(dynamic, 16) default(none) shared(options, reference, referenceSteps)
+    for (size_t i = 0; i < options.size(); ++i)
+        reference[i] = 0.5 * (BinomialTree::price(options[i], referenceSteps) + BinomialTree::price(options[i], referenceSteps + 1));
+
+    std::vector<double> bawPrices, adaptivePrices;
+    benchmark("Price (BAW batch)", [&]() {
+        bawPrices = PricingDispatcher::priceBatch(batch);
+        return 0.0;
+    });
+    benchmark("Price (Adaptive batch)", [&]() {
+        adaptivePrices = PricingDispatcher::priceBatchAdaptive(batch, selector);
+        return 0.0;
+    });
+
+    int modelCounts[AdaptiveModelSelector::NUM_MODELS] = {};
+    double worstPerStrike = 0.0;
+    for (size_t i = 0; i < options.size(); ++i) {
+        const Option& o = options[i];
+        ++modelCounts[static_cast<int>(selector.select(o.S, o.K, o.r, o.sigma, o.T, o.q, o.type))];
+        worstPerStrike = std::max(worstPerStrike, std::abs(adaptivePrices[i] - reference[i]) / o.K);
+    }
+    const char* names[] = {"BAW", "CRR-100", "CRR-250", "CRR-500", "CRR-1000"};
+    std::cout << "Model mix:";
+    for (int m = 0; m < AdaptiveModelSelector::NUM_MODELS; ++m) std::cout << ' ' << names[m] << '=' << modelCounts[m];
+    std::cout << "\nWorst error per unit strike: " << worstPerStrike << " (tolerance " << tolerance << ")\n";
+
+    std::cout << "\n[BAW vs reference]\n";
+    summarizePricingErrors(reference, bawPrices, options);
+    std::cout << "\n[Adaptive vs reference]\n";
+    summarizePricingErrors(reference, adaptivePrices, options);
+}
+
+//build the table once, then compare table evaluation against BAW and the lattice it replaces
+void benchmarkChebyshevSurrogate(int numAmerican, int buildSteps, int referenceSteps) {
+    ChebyshevSurrogate surrogate;
+    benchmark("Build chebyshev surrogate", [&]() {
+        surrogate.build({24, 12, 10, 10}, ChebyshevSurrogate::Domain{}, buildSteps);
+        return 0.0;
+    });
+
+    std::vector<Option> options = generateOptions(numAmerican, OptionStyle::American);
+    OptionBatch batch = toBatch(options);
+    std::vector<double> bawPrices, surrogatePrices, binomialPrices;
+    benchmark("Price (BAW batch)", [&]() {
+        bawPrices = PricingDispatcher::priceBatch(batch);
+        return 0.0;
+    });
+    benchmark("Price (Surrogate batch)", [&]() {
+        surrogatePrices = PricingDispatcher::priceBatchSurrogate(batch, surrogate);
+        return 0.0;
+    });
+    benchmark("Price (Binomial workspace)", [&]() {
+        binomialPrices = PricingDispatcher::priceBatchBinomialWorkspace(options, referenceSteps);
+        return 0.0;
+    });
+
+    ChebyshevSurrogate::ErrorReport report = surrogate.checkAgainstBinomial(options, referenceSteps);
+    std::cout << "Table covers " << surrogate.trustedFraction() * 100 << "% of trust cells\n";
+    std::cout << "Surrogate vs binomial: max " << report.maxAbsPerStrike << " rms " << report.rmsPerStrike
+              << " per unit strike, " << report.onTree << "/" << report.count << " on the tree, " << report.outOfDomain
+              << " out of domain -> " << (report.withinBudget() ? "within" : "OVER") << " budget " << report.budget << "\n";
+    std::cout << "\n[Surrogate vs binomial]\n";
+    summarizePricingErrors(binomialPrices, surrogatePrices, options);
+}
+
+//write a book to disk once, then map + price it in place; compare against pricing the in-memory batch
+void benchmarkMappedBatchFile(int numOptions, const std::string& bookPath, const std::string& resultPath) {
+    std::vector<Option> options = generateMixedOptions(numOptions / 2, numOptions - numOptions / 2);
+    OptionBatch batch = toBatch(options);
+    std::vector<std::string> ids(options.size());
+    for (size_t i = 0; i < ids.size(); ++i) ids[i] = "OPT-" + std::to_string(i);
+
+    benchmark("Write book file", [&]() {
+        BatchFile::writeBook(bookPath, batch.view(), ids);
+        return 0.0;
+    });
+
+    double mapMs = 0.0;
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        MappedOptionBatch mapped(bookPath);
+        MappedResultFile results = MappedResultFile::create(resultPath, mapped.size());
+        auto end = std::chrono::high_resolution_clock::now();
+        mapMs = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << "Map book + create results (" << mapped.size() << " rows) took " << mapMs << " ms\n";
+
+        benchmark("Price (mapped book into mapped results)", [&]() {
+            PricingDispatcher::priceBatch(mapped.view(), results.columns().price);
+            return 0.0;
+        });
+        results.sync();
+    }
+
+    std::vector<double> inMemory = PricingDispatcher::priceBatch(batch);
+    MappedResultFile reopened = MappedResultFile::open(resultPath);
+    const double* reopenedPrices = reopened.column(BatchFile::Column::price);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < inMemory.size(); ++i)
+        if (reopenedPrices[i] != inMemory[i]) ++mismatches;
+    std::cout << "Mismatches vs in-memory batch: " << mismatches << "\n";
+}
+
+//same book priced in float and double; double is the reference for the float error report
+void benchmarkFloatPrecision(int numEuropean, int numAmerican, int binomialSteps) {
+    std::vector<Option> europeanOptions = generateOptions(numEuropean, OptionStyle::European);
+    std::vector<Option> mixedOptions = generateMixedOptions(numEuropean, numAmerican);
+    OptionBatch europeanBatch = toBatch(europeanOptions);
+    OptionBatch mixedBatch = toBatch(mixedOptions);
+    OptionBatchF europeanBatchF = convertBatch<float>(europeanBatch);
+    OptionBatchF mixedBatchF = convertBatch<float>(mixedBatch);
+
+    auto widen = [](const std::vector<float>& prices) {
+        return std::vector<double>(prices.begin(), prices.end());
+    };
+
+    std::vector<double> bsDouble, bawDouble, binomialDouble;
+    std::vector<float> bsFloat, bawFloat, binomialFloat(mixedBatchF.size());
+    benchmark("Price (Black-Scholes SIMD, double)", [&]() {
+        bsDouble = PricingDispatcher::priceBatchBlackScholesSIMD(europeanBatch);
+        return 0.0;
+    });
+    benchmark("Price (Black-Scholes SIMD, float)", [&]() {
+        bsFloat = PricingDispatcher::priceBatchBlackScholesSIMD(europeanBatchF);
+        return 0.0;
+    });
+    benchmark("Price (BS + BAW batch, double)", [&]() {
+        bawDouble = PricingDispatcher::priceBatch(mixedBatch);
+        return 0.0;
+    });
+    benchmark("Price (BS + BAW batch, float)", [&]() {
+        bawFloat = PricingDispatcher::priceBatch(mixedBatchF);
+        return 0.0;
+    });
+    benchmark("Price (BS + binomial batch, double)", [&]() {
+        binomialDouble.resize(mixedBatch.size());
+        PricingDispatcher::priceBatchBinomial(mixedBatch.view(), binomialDouble.data(), binomialSteps);
+        return 0.0;
+    });
+    benchmark("Price (BS + binomial batch, float)", [&]() {
+        PricingDispatcher::priceBatchBinomial(mixedBatchF.view(), binomialFloat.data(), binomialSteps);
+        return 0.0;
+    });
+
+    std::cout << "Batch storage: " << europeanBatch.capacity() * OptionBatch::COLUMNS * sizeof(double) / double(1 << 20)
+              << " MiB double vs " << europeanBatchF.capacity() * OptionBatchF::COLUMNS * sizeof(float) / double(1 << 20) << " MiB float\n";
+
+    //float inputs are rounded too, so this is end-to-end error of the float path, not just the kernel
+    std::cout << "\n[Black-Scholes float vs double]\n";
+    summarizePricingErrors(bsDouble, widen(bsFloat), europeanOptions);
+    std::cout << "\n[BS + BAW float vs double]\n";
+    summarizePricingErrors(bawDouble, widen(bawFloat), mixedOptions);
+    std::cout << "\n[BS + binomial float vs double]\n";
+    summarizePricingErrors(binomialDouble, widen(binomialFloat), mixedOptions);
+}
+
+//one-pass scenario cube vs copying the batch and calling priceBatch once per cell
+void benchmarkScenarioGrid(int numEuropean, int numAmerican, int spotSteps, int volSteps, int numUnderlyings) {
+    std::vector<Option> options = generateMixedOptions(numEuropean, numAmerican);
+    OptionBatch batch = toBatch(options);
+    ScenarioEngine engine(ScenarioGrid::uniform(0.10, spotSteps, 0.05, volSteps));
+    const ScenarioGrid& grid = engine.grid();
+    size_t N = batch.size(), cells = engine.cells();
+    std::cout << "\n[Scenario grid: " << N << " options x " << cells << " cells]\n";
+
+    std::vector<double> naive(N * cells), cube(N * cells), base(N);
+    double naiveMs = benchmark("Price (naive repricing per cell)", [&]() {
+        OptionBatch shocked = batch;
+        std::vector<double> prices(N);
+        for (size_t v = 0; v < grid.volShocks.size(); ++v) {
+            for (size_t j = 0; j < grid.spotShocks.size(); ++j) {
+                for (size_t i = 0; i < N; ++i) {
+                    shocked.S[i] = grid.shockedSpot(batch.S[i], j);
+                    shocked.sigma[i] = grid.shockedVol(batch.sigma[i], v);
+                }
+                PricingDispatcher::priceBatch(shocked.view(), prices.data());
+                for (size_t i = 0; i < N; ++i) naive[engine.index(i, v, j)] = prices[i];
+            }
+        }
+        return 0.0;
+    });
+    double engineMs = benchmark("Price (scenario engine)", [&]() {
+        engine.price(batch.view(), cube.data(), base.data());
+        return 0.0;
+    });
+    std::cout << "Speedup: " << naiveMs / engineMs << "x\n";
+
+    double maxAbs = 0.0;
+    for (size_t c = 0; c < cube.size(); ++c) maxAbs = std::max(maxAbs, std::abs(cube[c] - naive[c]));
+    std::cout << "Max abs difference vs naive: " << maxAbs << "\n";
+
+    std::vector<int> underlying(N);
+    for (size_t i = 0; i < N; ++i) underlying[i] = static_cast<int>(i % numUnderlyings);
+    std::vector<double> pnl;
+    benchmark("Aggregate P&L per underlying", [&]() {
+        pnl = engine.aggregate(cube.data(), base.data(), underlying, numUnderlyings);
+        return 0.0;
+    });
+    //worst cell for the first underlying, as a sanity check
+    size_t worst = std::min_element(pnl.begin(), pnl.begin() + cells) - pnl.begin();
+    std::cout << "Underlying 0 worst cell: spot " << grid.spotShocks[worst % grid.spotShocks.size()]
+              << " vol " << grid.volShocks[worst / grid.spotShocks.size()] << " P&L " << pnl[worst] << "\n";
+}
+
+//LSM against binomial (american) and Black-Scholes (european control); the batch shares one path set
+void benchmarkLongstaffSchwartz(int numEuropean, int numAmerican, size_t paths, int exerciseDates, int referenceSteps) {
+    std::vector<Option> options = generateMixedOptions(numEuropean, numAmerican);
+    OptionBatch batch = toBatch(options);
+    LSMConfig config;
+    config.paths = paths;
+    config.exerciseDates = exerciseDates;
+    std::cout << "\n[Longstaff-Schwartz: " << options.size() << " options, " << paths << " paths x " << exerciseDates << " dates]\n";
+
+    std::vector<double> reference(options.size());
+    #pragma omp parallel for schedule(dynamic, 16) default(none) shared(options, reference, referenceSteps)
+    for (size_t i = 0; i < options.size(); ++i)
+        reference[i] = options[i].style == OptionStyle::European ? BlackScholes::price(options[i])
+                                                                  : BinomialTree::price(options[i], referenceSteps);
+
+    benchmark("Generate Sobol + brownian bridge paths", [&]() {
+        return LSMPaths::generate(exerciseDates, paths, config.seed).W[0];
+    });
+    std::vector<double> prices(options.size()), stdError(options.size());
+    double ms = benchmark("Price (LSM batch)", [&]() {
+        LongstaffSchwartz::priceBatch(batch.view(), prices.data(), config, stdError.data());
+        return 0.0;
+    });
+    std::cout << "Options/sec: " << options.size() / (ms / 1000.0) << "\n";
+
+    //bias vs reference in units of the reported standard error
+    for (OptionStyle style : {OptionStyle::European, OptionStyle::American}) {
+        size_t count = 0, within = 0;
+        double maxAbs = 0.0, meanErr = 0.0, meanSe = 0.0;
+        for (size_t i = 0; i < options.size(); ++i) {
+            if (options[i].style != style) continue;
+            double err = prices[i] - reference[i];
+            ++count;
+            maxAbs = std::max(maxAbs, std::abs(err));
+            meanErr += err;
+            meanSe += stdError[i];
+            within += std::abs(err) <= 3.0 * stdError[i];
+        }
+        if (count == 0) continue;
+        std::cout << (style == OptionStyle::European ? "European vs Black-Scholes" : "American vs binomial")
+                  << ": mean error " << meanErr / count << ", max abs " << maxAbs << ", mean std error " << meanSe / count
+                  << ", within 3 s.e. " << 100.0 * within / count << "%\n";
+    }
+}
+
+//crank-nicolson grids vs CRR at 1000 steps, both against a fine binomial reference (average of two step counts)
+void benchmarkCrankNicolson(int numAmerican, int referenceSteps) {
+    std::vector<Option> options = generateOptions(numAmerican, OptionStyle::American);
+    OptionBatch batch = toBatch(options);
+    const size_t N = batch.size();
+    std::cout << "\n[Crank-Nicolson vs CRR: " << N << " american options]\n";
+
+    std::vector<double> reference(N);
+    #pragma omp parallel for schedule(dynamic, 4) default(none) shared(options, reference, referenceSteps, N)
+    for (size_t i = 0; i < N; ++i)
+        reference[i] = 0.5 * (BinomialTree::price(options[i], referenceSteps) + BinomialTree::price(options[i], referenceSteps + 1));
+
+    auto report = [&](const std::string& label, const std::vector<double>& prices, double ms) {
+        double maxAbs = 0.0, sumAbs = 0.0;
+        for (size_t i = 0; i < N; ++i) {
+            double err = std::abs(prices[i] - reference[i]);
+            maxAbs = std::max(maxAbs, err);
+            sumAbs += err;
+        }
+        std::cout << label << ": " << ms * 1000.0 / N << " us/option, mean abs error " << sumAbs / N
+                  << ", max abs " << maxAbs << "\n";
+    };
+
+    std::vector<double> crr(N);
+    double crrMs = benchmark("Price (CRR 1000 steps)", [&]() {
+        PricingDispatcher::priceBatchBinomial(batch.view(), crr.data(), 1000);
+        return 0.0;
+    });
+    report("CRR 1000", crr, crrMs);
+
+    for (PDEGrid grid : {PDEGrid{200, 100}, PDEGrid{400, 200}}) {
+        std::string label = "CN " + std::to_string(grid.spaceSteps) + "x" + std::to_string(grid.timeSteps);
+        std::vector<double> prices(N);
+        double ms = benchmark("Price (" + label + ")", [&]() {
+            CrankNicolson::priceBatch(batch.view(), prices.data(), grid);
+            return 0.0;
+        });
+        report(label, prices, ms);
+    }
+
+    //greeks straight off the grid vs bump-and-reprice on the tree
+    std::vector<double> price(N), delta(N), gamma(N), theta(N), vega(N), rho(N);
+    GreekColumns columns{price.data(), delta.data(), gamma.data(), theta.data(), vega.data(), rho.data()};
+    benchmark("Price + delta/gamma/theta (CN 200x100)", [&]() {
+        CrankNicolson::priceBatch(batch.view(), columns);
+        return 0.0;
+    });
+    benchmark("Price + greeks (CRR 1000, bumped)", [&]() {
+        PricingDispatcher::priceAndGreeksBatch(batch.view(), columns, 1000);
+        return 0.0;
+    });
+}
+
+//escrowed dividend lattice: cost vs the continuous-yield tree, european limit vs black-scholes on S - PV, convergence
+void benchmarkDiscreteDividends(int numAmerican, int steps, int referenceSteps) {
+    std::vector<Option> options = generateOptions(numAmerican, OptionStyle::American);
+    const std::vector<CashDividend> dividends{{0.1, 0.8}, {0.35, 0.8}, {0.6, 0.8}, {0.85, 0.8}, {1.1, 0.8}, {1.35, 0.8},
+                                              {1.6, 0.8}, {1.85, 0.8}};
+    for (Option& opt : options) opt.q = 0.0; // the cash dividends are the whole payout
+    const size_t N = options.size();
+    std::cout << "\n[Discrete dividends: " << N << " american options, " << dividends.size() << " quarterly dividends]\n";
+
+    std::vector<double> yield(N), cash(N);
+    double yieldMs = benchmark("CRR " + std::to_string(steps) + " (continuous yield)", [&]() {
+        #pragma omp parallel default(none) shared(options, yield, steps, N)
+        {
+            BinomialWorkspace workspace(steps);
+        #pragma omp for
+            for (size_t i = 0; i < N; ++i) yield[i] = BinomialTree::priceWorkspace(options[i], steps, workspace);
+        }
+        return 0.0;
+    });
+    double cashMs = benchmark("CRR " + std::to_string(steps) + " (escrowed cash dividends)", [&]() {
+        #pragma omp parallel default(none) shared(options, dividends, cash, steps, N)
+        {
+            BinomialWorkspace workspace(steps);
+        #pragma omp for
+            for (size_t i = 0; i < N; ++i) cash[i] = BinomialTree::priceDividends(options[i], dividends, steps, workspace);
+        }
+        return 0.0;
+    });
+    std::cout << "Per option: " << yieldMs * 1000.0 / N << " us vs " << cashMs * 1000.0 / N << " us\n";
+
+    //european rows must match black-scholes on the escrowed spot; american calls exercising before an ex-date
+    //are worth more than their european twin
+    double europeanError = 0.0;
+    size_t earlyCalls = 0, calls = 0;
+    for (size_t i = 0; i < N; ++i) {
+        Option euro = options[i];
+        euro.style = OptionStyle::European;
+        double european = BinomialTree::priceDividends(euro, dividends, steps);
+        Option escrowed = euro;
+        for (const CashDividend& d : dividends)
+            if (d.time <= euro.T) escrowed.S -= d.amount * std::exp(-euro.r * d.time);
+        europeanError = std::max(europeanError, std::abs(european - BlackScholes::price(escrowed)));
+        if (options[i].type == OptionType::Call) {
+            ++calls;
+            if (cash[i] > european + 1e-4) ++earlyCalls;
+        }
+    }
+    std::cout << "European max abs error vs Black-Scholes(S - PV): " << europeanError << "\n";
+    std::cout << "American calls worth more than european (early exercise before an ex-date): " << earlyCalls
+              << " of " << calls << "\n";
+
+    const size_t sample = std::min<size_t>(N, 200);
+    double maxAbs = 0.0, sumAbs = 0.0;
+    #pragma omp parallel for schedule(dynamic, 4) reduction(max:maxAbs) reduction(+:sumAbs) default(none) shared(options, dividends, cash, referenceSteps, sample)
+    for (size_t i = 0; i < sample; ++i) {
+        double reference = 0.5 * (BinomialTree::priceDividends(options[i], dividends, referenceSteps)
+                                  + BinomialTree::priceDividends(options[i], dividends, referenceSteps + 1));
+        double err = std::abs(cash[i] - reference);
+        maxAbs = std::max(maxAbs, err);
+        sumAbs += err;
+    }
+    std::cout << "Vs " << referenceSteps << "-step lattice (" << sample << " options): mean abs error " << sumAbs / sample
+              << ", max abs " << maxAbs << "\n";
+}
+
+//listed chains: underlyings x expiries x strikes, calls and puts, one vol per (underlying, expiry).
+//q = 0 so the row-wise dispatcher (d1 without q) and the chain kernels price the same thing
+static std::vector<Option> makeChains(int numUnderlyings, int numExpiries, int numStrikes, OptionStyle style) {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<double> spot(20.0, 500.0), vol(0.15, 0.6);
+    std::vector<Option> options;
+    for (int u = 0; u < numUnderlyings; ++u) {
+        double S = spot(gen);
+        for (int e = 0; e < numExpiries; ++e) {
+            double T = (e + 1) / 12.0, sigma = vol(gen);
+            for (int k = 0; k < numStrikes; ++k) {
+                double K = S * (0.6 + 0.8 * k / std::max(numStrikes - 1, 1));
+                options.emplace_back(S, K, 0.04, sigma, T, 0.0, OptionType::Call, style);
+                options.emplace_back(S, K, 0.04, sigma, T, 0.0, OptionType::Put, style);
+            }
+        }
+    }
+    std::shuffle(options.begin(), options.end(), gen);
+    return options;
+}
+
+void benchmarkOptionChain(int numUnderlyings, int numExpiries, int numStrikes, int binomialUnderlyings, int steps) {
+    auto maxDifference = [](const std::vector<double>& a, const std::vector<double>& b) {
+        double worst = 0.0;
+        for (size_t i = 0; i < a.size(); ++i) worst = std::max(worst, std::abs(a[i] - b[i]));
+        return worst;
+    };
+
+    OptionBatch european = toBatch(makeChains(numUnderlyings, numExpiries, numStrikes, OptionStyle::European));
+    std::cout << "\n[Option chains: " << european.size() << " european rows, " << numUnderlyings << " underlyings x "
+              << numExpiries << " expiries x " << numStrikes << " strikes x call/put]\n";
+    OptionChain chain;
+    benchmark("Build chain (group + reorder)", [&]() {
+        chain = OptionChain(european.view());
+        return 0.0;
+    });
+    std::vector<double> rowWise(european.size()), chainOrdered(european.size()), chained(european.size());
+    benchmark("priceBatch (row-wise)", [&]() {
+        PricingDispatcher::priceBatch(european.view(), rowWise.data());
+        return 0.0;
+    });
+    benchmark("ChainPricer::priceBatch", [&]() {
+        ChainPricer::priceBatch(chain, chainOrdered.data());
+        return 0.0;
+    });
+    chain.scatter(chainOrdered.data(), chained.data());
+    std::cout << chain.groups().size() << " groups, max difference " << maxDifference(rowWise, chained) << "\n";
+
+    OptionBatch american = toBatch(makeChains(binomialUnderlyings, numExpiries, numStrikes, OptionStyle::American));
+    OptionChain americanChain(american.view());
+    std::cout << "\n[Binomial chains: " << american.size() << " american rows, " << steps << " steps]\n";
+    std::vector<double> rowTree(american.size()), chainTree(american.size()), chainTreeOrdered(american.size());
+    benchmark("priceBatchBinomial (row-wise)", [&]() {
+        PricingDispatcher::priceBatchBinomial(american.view(), rowTree.data(), steps);
+        return 0.0;
+    });
+    benchmark("ChainPricer::priceBatchBinomial (shared lattice)", [&]() {
+        ChainPricer::priceBatchBinomial(americanChain, chainTreeOrdered.data(), steps);
+        return 0.0;
+    });
+    americanChain.scatter(chainTreeOrdered.data(), chainTree.data());
+    std::cout << "Max difference: " << maxDifference(rowTree, chainTree) << "\n";
+}
+
+//one american smile (flat vol, puts and calls) on one lattice vs a tree per strike; cost in units of one tree
+void benchmarkMultiStrike(int numStrikes, int steps, int repetitions) {
+    const double S = 100.0, r = 0.04, sigma = 0.3, T = 0.75, q = 0.02;
+    std::vector<double> strikes;
+    std::vector<OptionType> types;
+    for (OptionType type : {OptionType::Put, OptionType::Call})
+        for (int k = 0; k < numStrikes; ++k) {
+            strikes.push_back(S * (0.6 + 0.8 * k / std::max(numStrikes - 1, 1)));
+            types.push_back(type);
+        }
+    const size_t n = strikes.size();
+    std::cout << "\n[Multi-strike binomial: " << n << " american options on one lattice, " << steps << " steps]\n";
+
+    BinomialWorkspace workspace(steps);
+    std::vector<double> perStrike(n), shared(n);
+    double one = benchmark("One tree (x" + std::to_string(repetitions) + ")", [&]() {
+        for (int rep = 0; rep < repetitions; ++rep)
+            perStrike[0] = BinomialTree::priceWorkspace(Option(S, strikes[0], r, sigma, T, q, types[0], OptionStyle::American), steps, workspace);
+        return 0.0;
+    }) / repetitions;
+    double each = benchmark("Tree per strike (x" + std::to_string(repetitions) + ")", [&]() {
+        for (int rep = 0; rep < repetitions; ++rep)
+            for (size_t j = 0; j < n; ++j)
+                perStrike[j] = BinomialTree::priceWorkspace(Option(S, strikes[j], r, sigma, T, q, types[j], OptionStyle::American), steps, workspace);
+        return 0.0;
+    }) / repetitions;
+    BinomialLattice lattice;
+    double multi = benchmark("Lattice + priceStrikes (x" + std::to_string(repetitions) + ")", [&]() {
+        for (int rep = 0; rep < repetitions; ++rep) {
+            lattice.build(S, r, sigma, T, q, steps);
+            BinomialTree::priceStrikes(lattice, strikes.data(), types.data(), n, shared.data(), workspace);
+        }
+        return 0.0;
+    }) / repetitions;
+
+    double worst = 0.0;
+    for (size_t j = 0; j < n; ++j) worst = std::max(worst, std::abs(perStrike[j] - shared[j]));
+    std::cout << "Cost in trees: per strike " << each / one << ", shared lattice " << multi / one
+              << " (max difference " << worst << ")\n";
+}
+
+//every american model/setting on one seeded book against a Leisen-Reimer reference: error vs options/sec, table + csv.
+//a row is on the pareto front when no other row is both at least as fast and at least as accurate (rmse).
+//timings are the best of a few runs on the whole book; one-off setup (the surrogate table) is reported separately
+void benchmarkAmericanPareto(int numAmerican, int referenceSteps, const std::string& csvPath, OptionProfile profile,
+                             uint64_t seed) {
+    GeneratorConfig config;
+    config.profile = profile;
+    config.seed = seed;
+    config.europeanFraction = 0.0;
+    OptionBatch batch = OptionGenerator::generate(static_cast<size_t>(numAmerican), config);
+    const size_t N = batch.size();
+    std::vector<Option> options(N);
+    for (size_t i = 0; i < N; ++i) options[i] = batch.get(i);
+    std::cout << "\n[American accuracy vs throughput: " << N << " " << OptionGenerator::profileName(profile)
+              << " options, reference Leisen-Reimer " << (referenceSteps | 1) << " steps]\n";
+
+    std::vector<double> reference(N);
+    double referenceMs = benchmark("Reference (Leisen-Reimer)", [&]() {
+        #pragma omp parallel for schedule(dynamic, 1) default(none) shared(options, reference, referenceSteps, N)
+        for (size_t i = 0; i < N; ++i) reference[i] = BinomialTree::priceLeisenReimer(options[i], referenceSteps);
+        return 0.0;
+    });
+
+    struct Row {
+        std::string model, setting;
+        double ms, setupMs, rmse, maxAbs, meanAbs;
+        bool pareto;
+    };
+    std::vector<Row> rows;
+    auto run = [&](const std::string& model, const std::string& setting, const std::function<void(double*)>& price,
+                   double setupMs = 0.0) {
+        std::vector<double> prices(N);
+        double best = 1e300, spent = 0.0;
+        for (int rep = 0; rep < 5 && spent < 500.0; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            price(prices.data());
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = std::min(best, ms);
+            spent += ms;
+        }
+        double sumSq = 0.0, sumAbs = 0.0, maxAbs = 0.0;
+        for (size_t i = 0; i < N; ++i) {
+            double err = std::abs(prices[i] - reference[i]);
+            sumSq += err * err;
+            sumAbs += err;
+            maxAbs = std::max(maxAbs, err);
+        }
+        rows.push_back({model, setting, best, setupMs, std::sqrt(sumSq / N), maxAbs, sumAbs / N, false});
+    };
+    auto perOption = [&](double (*pricer)(const Option&, int), int steps) {
+        return [&options, pricer, steps, N](double* out) {
+            #pragma omp parallel for schedule(dynamic, 16) default(none) shared(options, out, pricer, steps, N)
+            for (size_t i = 0; i < N; ++i) out[i] = pricer(options[i], steps);
+        };
+    };
+
+    run("BAW", "newton 1000", [&](double* out) { PricingDispatcher::priceBatch(batch.view(), out, 1000); });
+    run("Ju-Zhong", "-", perOption(&JuZhong::price, 1000));
+    ChebyshevSurrogate surrogate;
+    auto start = std::chrono::steady_clock::now();
+    surrogate.build();
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    run("Chebyshev", "24x12x10x10", [&](double* out) {
+        std::vector<double> prices = PricingDispatcher::priceBatchSurrogate(batch, surrogate);
+        std::copy(prices.begin(), prices.end(), out);
+    }, buildMs);
+    for (PDEGrid grid : {PDEGrid{100, 50}, PDEGrid{200, 100}, PDEGrid{400, 200}})
+        run("Crank-Nicolson", std::to_string(grid.spaceSteps) + "x" + std::to_string(grid.timeSteps),
+            [&, grid](double* out) { CrankNicolson::priceBatch(batch.view(), out, grid); });
+    for (int steps : {50, 100, 250, 500, 1000, 2000})
+        run("CRR", std::to_string(steps), [&, steps](double* out) { PricingDispatcher::priceBatchBinomial(batch.view(), out, steps); });
+    for (int steps : {51, 101, 251, 501, 1001})
+        run("Leisen-Reimer", std::to_string(steps), perOption(&BinomialTree::priceLeisenReimer, steps));
+
+    for (Row& a : rows) {
+        a.pareto = true;
+        for (const Row& b : rows)
+            if (&a != &b && b.ms <= a.ms && b.rmse <= a.rmse && (b.ms < a.ms || b.rmse < a.rmse)) a.pareto = false;
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.ms < b.ms; });
+
+    std::cout << std::left << std::setw(16) << "model" << std::setw(12) << "setting" << std::right << std::setw(14)
+              << "options/sec" << std::setw(12) << "rmse" << std::setw(12) << "max abs" << std::setw(12) << "mean abs"
+              << std::setw(12) << "setup ms" << "  pareto\n";
+    std::ofstream csv(csvPath);
+    csv << "model,setting,options,ms,options_per_sec,rmse,max_abs,mean_abs,setup_ms,pareto\n";
+    csv << std::setprecision(10);
+    for (const Row& row : rows) {
+        double perSecond = N / (row.ms * 1e-3);
+        std::cout << std::left << std::setw(16) << row.model << std::setw(12) << row.setting << std::right << std::scientific
+                  << std::setprecision(3) << std::setw(14) << perSecond << std::setw(12) << row.rmse << std::setw(12)
+                  << row.maxAbs << std::setw(12) << row.meanAbs << std::fixed << std::setprecision(1) << std::setw(12)
+                  << row.setupMs << (row.pareto ? "  *" : "") << std::defaultfloat << "\n";
+        csv << row.model << "," << row.setting << "," << N << "," << row.ms << "," << perSecond << "," << row.rmse << ","
+            << row.maxAbs << "," << row.meanAbs << "," << row.setupMs << "," << (row.pareto ? 1 : 0) << "\n";
+    }
+    if (csv) std::cout << "Wrote " << csvPath << " (reference took " << std::fixed << std::setprecision(0) << referenceMs
+                       << " ms)\n" << std::defaultfloat << std::setprecision(6);
+    else std::cerr << "Cannot write " << csvPath << "\n";
+}
+
+//one warm-up tick per path (sizes the per-thread lattices, spins up the omp pool), then every later tick through the
+//caller-buffer overloads should allocate nothing. the vector-returning priceBatch is listed for contrast
+int checkSteadyStateAllocations(int numOptions, int ticks, uint64_t seed) {
+    std::cout << "\n[Steady-state heap allocations: " << numOptions << " options, " << ticks << " ticks per path]\n";
+    if (!AllocationCounter::enabled()) {
+        std::cout << "allocation counter not compiled in; configure with -DOPTIONS_COUNT_ALLOCATIONS=ON or a Debug build\n";
+        return 0;
+    }
+    GeneratorConfig config;
+    config.seed = seed;
+    config.europeanFraction = 0.5;
+    OptionBatch batch = OptionGenerator::generate(static_cast<size_t>(numOptions), config);
+    //lattice paths cost O(steps^2) per row; a slice keeps them quick
+    OptionBatch lattice = OptionGenerator::generate(std::min<size_t>(batch.size(), 256), config);
+    std::vector<Option> latticeOptions(lattice.size());
+    for (size_t i = 0; i < lattice.size(); ++i) latticeOptions[i] = lattice.get(i);
+    const OptionBatchView view = batch.view();
+    const OptionBatchView latticeView = lattice.view();
+
+    std::vector<double> out(batch.size());
+    std::vector<double> greekColumns[6];
+    for (auto& c : greekColumns) c.resize(lattice.size());
+    GreekColumns greeks{greekColumns[0].data(), greekColumns[1].data(), greekColumns[2].data(),
+                        greekColumns[3].data(), greekColumns[4].data(), greekColumns[5].data()};
+    std::vector<GreekResult> greekResults(lattice.size());
+
+    struct Path { const char* name; std::function<void()> tick; bool expectZero; };
+    std::vector<Path> paths = {
+        {"priceBatch(view, out)", [&]() { PricingDispatcher::priceBatch(view, out.data()); }, true},
+        {"priceBatchBlackScholesSIMD(view, out)", [&]() { PricingDispatcher::priceBatchBlackScholesSIMD(view, out.data()); }, true},
+        {"priceBatchBinomial(view, out, 200)", [&]() { PricingDispatcher::priceBatchBinomial(latticeView, out.data(), 200); }, true},
+        {"priceBatchBinomial(view, out, 128 fixed)", [&]() { PricingDispatcher::priceBatchBinomial(latticeView, out.data(), 128); }, true},
+        {"priceBatchBinomialWorkspace(opts, out, 200)", [&]() { PricingDispatcher::priceBatchBinomialWorkspace(latticeOptions, out.data(), 200); }, true},
+        {"priceAndGreeksBatch(view, columns, 100)", [&]() { PricingDispatcher::priceAndGreeksBatch(latticeView, greeks, 100); }, true},
+        {"priceAndGreeks(opts, out, 100)", [&]() { PricingDispatcher::priceAndGreeks(latticeOptions, greekResults.data(), 100); }, true},
+        {"BinomialTree::price per option, 200", [&]() {
+            for (size_t i = 0; i < latticeOptions.size(); ++i) out[i] = BinomialTree::price(latticeOptions[i], 200);
+        }, true},
+        {"priceBatch(batch) -> vector", [&]() { out = PricingDispatcher::priceBatch(batch); }, false},
+    };
+
+    int failures = 0;
+    for (const Path& path : paths) {
+        path.tick();
+        uint64_t allocations = 0;
+        for (int t = 0; t < ticks; ++t) allocations += AllocationCounter::during(path.tick);
+        double perTick = static_cast<double>(allocations) / ticks;
+        bool failed = path.expectZero && allocations > 0;
+        failures += failed;
+        std::cout << std::left << std::setw(46) << path.name << std::right << std::setw(10) << perTick << " allocs/tick"
+                  << (failed ? "   <-- expected 0" : "") << "\n";
+    }
+    return failures;
+}
@@ -0,0 +1,149 @@
+#include "MarketBenchmarks.h"
+#include "market/Curves.h"
+#include "market/VolSurface.h"
+#include "pricing/BAW.h"
+#include "pricing/PricingDispatcher.h"
+#include "shared/BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+//synthetic BTC-like chain: known SVI smiles per expiry plus quote noise; cold fit, then warm refits per tick
+void benchmarkVolSurface(int numExpiries, int strikesPerExpiry, int numTicks, int numRows) {
+    std::mt19937 gen(7);
+    std::normal_distribution<double> noise(0.0, 0.002);
+    const double spot = 90'000.0, r = 0.05;
+
+    std::vector<double> expiries(numExpiries);
+    std::vector<SVIParams> truth(numExpiries);
+    std::vector<std::vector<VolQuote>> chain(numExpiries);
+    for (int e = 0; e < numExpiries; ++e) {
+        double T = 7.0 / 365.0 * std::pow(2.0 / (7.0 / 365.0), e / std::max(numExpiries - 1.0, 1.0));
+        expiries[e] = T;
+        SVIParams& p = truth[e];
+        p.b = 0.15 * std::sqrt(T); p.rho = -0.25; p.m = 0.02; p.sigma = 0.1 + 0.05 * T;
+        p.a = 0.25 * T - p.b * p.sigma;
+        double F = spot * std::exp(r * T), width = 0.15 + 0.6 * std::sqrt(T);
+        for (int j = 0; j < strikesPerExpiry; ++j) {
+            double k = -width + 2.0 * width * j / (strikesPerExpiry - 1);
+            chain[e].push_back({F * std::exp(k), std::sqrt(p.totalVariance(k) / T) + noise(gen)});
+        }
+    }
+
+    std::cout << "\n[Vol surface: " << numExpiries << " expiries x " << strikesPerExpiry << " strikes]\n";
+    VolSurface surface;
+    for (int e = 0; e < numExpiries; ++e) surface.setSlice(expiries[e], spot * std::exp(r * expiries[e]), chain[e]);
+    double cold = benchmark("Cold calibration", [&]() { return static_cast<double>(surface.calibrate()); });
+    std::cout << "  per expiry: " << cold / numExpiries << " ms\n";
+
+    //fit error vs quotes, and recovery of the noise-free smile
+    double worstRmse = 0.0, worstRecovery = 0.0;
+    for (int e = 0; e < numExpiries; ++e) {
+        worstRmse = std::max(worstRmse, surface.rmse(e));
+        double T = expiries[e], F = spot * std::exp(r * T);
+        for (const VolQuote& q : chain[e]) {
+            double k = std::log(q.K / F);
+            worstRecovery = std::max(worstRecovery, std::abs(surface.vol(q.K, T) - std::sqrt(truth[e].totalVariance(k) / T)));
+        }
+    }
+    std::cout << "Worst slice RMSE vs quotes: " << worstRmse << " (quote noise 0.002)\n";
+    std::cout << "Worst error vs true smile: " << worstRecovery << "\n";
+
+    //ticks: every quote moves a little and the whole smile drifts; every slice is dirty each tick
+    std::normal_distribution<double> jitter(0.0, 0.0005), drift(0.0, 0.002);
+    double warm = 0.0;
+    for (int t = 0; t < numTicks; ++t) {
+        double shift = drift(gen);
+        for (int e = 0; e < numExpiries; ++e)
+            for (VolQuote& q : chain[e]) {
+                q.iv = std::max(q.iv + shift + jitter(gen), 0.01);
+                surface.setQuote(expiries[e], spot * std::exp(r * expiries[e]), q.K, q.iv);
+            }
+        auto start = std::chrono::high_resolution_clock::now();
+        surface.calibrate();
+        warm += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    worstRmse = 0.0;
+    for (int e = 0; e < numExpiries; ++e) worstRmse = std::max(worstRmse, surface.rmse(e));
+    std::cout << "Warm recalibration: " << warm / numTicks << " ms per tick, " << warm / numTicks / numExpiries
+              << " ms per expiry; worst RMSE after " << numTicks << " ticks " << worstRmse << "\n";
+
+    //sigma lookups for a book of rows sorted by expiry, including strikes and expiries nobody quotes
+    std::uniform_real_distribution<double> strike(0.5 * spot, 1.8 * spot), expiry(1.0 / 365.0, 2.5);
+    std::vector<Option> rows(numRows);
+    for (int i = 0; i < numRows; ++i)
+        rows[i] = Option(spot, strike(gen), r, 0.0, expiry(gen), 0.0, OptionType::Call, OptionStyle::European);
+    std::sort(rows.begin(), rows.end(), [](const Option& a, const Option& b) { return a.T < b.T; });
+    OptionBatch batch = toBatch(rows);
+    benchmark("fillSigma (" + std::to_string(numRows) + " rows)", [&]() {
+        surface.fillSigma(batch);
+        return 0.0;
+    });
+    double worstLookup = 0.0;
+    for (int i = 0; i < numRows; i += std::max(numRows / 1000, 1))
+        worstLookup = std::max(worstLookup, std::abs(batch.sigma[i] - surface.vol(batch.K[i], batch.T[i])));
+    std::cout << "Max fillSigma vs vol(K, T) difference: " << worstLookup << "\n";
+}
+
+//book on a handful of listed expiries: per-expiry cached terms vs curve lookups + exps on every row
+void benchmarkMarketCurves(int numEuropean, int numAmerican, int numExpiries) {
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> strike(80.0, 120.0), vol(0.1, 0.5), coin(0.0, 1.0);
+    std::uniform_int_distribution<int> listed(0, numExpiries - 1);
+    RateCurve discount({0.25, 0.5, 1.0, 2.0, 5.0}, {0.045, 0.047, 0.048, 0.046, 0.044});
+    RateCurve carry(0.01);
+    std::vector<CashDividend> dividends;
+    for (double t = 0.1; t < 3.0; t += 0.25) dividends.push_back({t, 0.5});
+    MarketCurves curves(discount, carry, dividends);
+
+    std::vector<Option> rows;
+    for (int i = 0; i < numEuropean + numAmerican; ++i) {
+        double T = (listed(gen) + 1) * 2.0 / numExpiries;
+        rows.emplace_back(100.0, strike(gen), 0.0, vol(gen), T, 0.0, coin(gen) < 0.5 ? OptionType::Call : OptionType::Put,
+                          i < numEuropean ? OptionStyle::European : OptionStyle::American);
+    }
+    OptionBatch batch = toBatch(rows);
+    std::cout << "\n[Market curves: " << batch.size() << " rows on " << numExpiries << " expiries, "
+              << dividends.size() << " cash dividends]\n";
+
+    std::vector<double> naive(batch.size()), bucketed(batch.size());
+    benchmark("Per-row curve lookup + exps", [&]() {
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (size_t i = 0; i < batch.size(); ++i) {
+            double S = batch.S[i], K = batch.K[i], sigma = batch.sigma[i], T = batch.T[i];
+            double r = discount.zeroRate(T), b = carry.zeroRate(T), pv = 0.0;
+            for (const CashDividend& d : dividends)
+                if (d.time <= T) pv += d.amount * discount.discount(d.time);
+            double prepaid = S * std::exp(-b * T) - pv, discountedK = K * std::exp(-r * T);
+            if (batch.style[i] == OptionStyle::American) {
+                naive[i] = BAW::priceParameters(S, K, r, sigma, T, -std::log(prepaid / S) / T, batch.type[i], 1000);
+                continue;
+            }
+            double volSqrtT = sigma * std::sqrt(T);
+            double d1 = (std::log(prepaid / discountedK) + 0.5 * volSqrtT * volSqrtT) / volSqrtT, d2 = d1 - volSqrtT;
+            naive[i] = batch.type[i] == OptionType::Put ? discountedK * normCDF(-d2) - prepaid * normCDF(-d1)
+                                                        : prepaid * normCDF(d1) - discountedK * normCDF(d2);
+        }
+        return 0.0;
+    });
+    ExpiryBuckets buckets;
+    benchmark("MarketCurves::buckets", [&]() {
+        buckets = curves.buckets(batch.view());
+        return 0.0;
+    });
+    benchmark("priceBatch with expiry buckets", [&]() {
+        PricingDispatcher::priceBatch(batch.view(), buckets, bucketed.data());
+        return 0.0;
+    });
+    double worst = 0.0;
+    for (size_t i = 0; i < batch.size(); ++i) worst = std::max(worst, std::abs(naive[i] - bucketed[i]));
+    std::cout << "Distinct expiries: " << buckets.terms.size() << ", max difference: " << worst << "\n";
+
+    benchmark("MarketCurves::apply (r, q columns)", [&]() {
+        curves.apply(batch);
+        return 0.0;
+    });
+}
@@ -0,0 +1,132 @@
+#include "PortfolioBenchmarks.h"
+#include "portfolio/Portfolio.h"
+#include "portfolio/MonteCarloVaR.h"
+#include "pricing/PricingDispatcher.h"
+#include "shared/BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <omp.h>
+
+static double worstDifference(const PortfolioRisk& a, const PortfolioRisk& b) {
+    return std::max({std::abs(a.value - b.value), std::abs(a.delta - b.delta), std::abs(a.gamma - b.gamma),
+                     std::abs(a.vega - b.vega), std::abs(a.theta - b.theta)});
+}
+
+//fused portfolio pass vs priceAndGreeks followed by a separate aggregation pass; then single-row updates
+void benchmarkPortfolioGreeks(int numEuropean, int numAmerican, int numUnderlyings, int steps, int numUpdates) {
+    std::vector<Option> options = generateMixedOptions(numEuropean, numAmerican);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> quantity(-50.0, 50.0);
+
+    Portfolio portfolio(steps);
+    std::vector<double> quantities(options.size());
+    for (size_t i = 0; i < options.size(); ++i) {
+        quantities[i] = std::round(quantity(gen));
+        portfolio.addPosition(options[i], quantities[i], "UND" + std::to_string(i % numUnderlyings));
+    }
+    std::cout << "\n[Portfolio: " << portfolio.size() << " positions, " << portfolio.underlyings().size()
+              << " underlyings, " << portfolio.expiries().size() << " expiry buckets]\n";
+
+    PortfolioRisk twoPass;
+    std::vector<PortfolioRisk> twoPassUnderlying(numUnderlyings);
+    benchmark("priceAndGreeks + aggregation pass", [&]() {
+        std::vector<GreekResult> results = PricingDispatcher::priceAndGreeks(options, steps);
+        for (size_t i = 0; i < results.size(); ++i) {
+            double size = quantities[i] * 100.0;
+            const Greeks& g = results[i].greeks;
+            //tree greeks are per unit vol / per year; portfolio reports BS units
+            bool tree = options[i].style == OptionStyle::American;
+            PortfolioRisk c{size * results[i].price, size * g.delta, size * g.gamma,
+                            size * g.vega / (tree ? 100.0 : 1.0), size * g.theta / (tree ? 365.0 : 1.0)};
+            twoPass += c;
+            twoPassUnderlying[i % numUnderlyings] += c;
+        }
+        return 0.0;
+    });
+    benchmark("Portfolio fused reprice", [&]() {
+        portfolio.reprice();
+        return 0.0;
+    });
+    const PortfolioRisk& book = portfolio.book();
+    std::cout << "Book: value " << book.value << " delta " << book.delta << " gamma " << book.gamma
+              << " vega " << book.vega << " theta " << book.theta << "\n";
+    std::cout << "Max difference vs two-pass: " << worstDifference(book, twoPass) << "\n";
+
+    //nudge spot on random rows one at a time, then check incremental totals against a full reprice
+    std::uniform_int_distribution<size_t> pickRow(0, options.size() - 1);
+    std::uniform_real_distribution<double> move(-0.01, 0.01);
+    benchmark("Incremental single-row updates (" + std::to_string(numUpdates) + ")", [&]() {
+        for (int k = 0; k < numUpdates; ++k) {
+            size_t row = pickRow(gen);
+            Option opt = portfolio.batch().get(row);
+            opt.S *= 1.0 + move(gen);
+            portfolio.updatePosition(row, opt);
+        }
+        return 0.0;
+    });
+    benchmark("Quantity changes (" + std::to_string(numUpdates) + ")", [&]() {
+        for (int k = 0; k < numUpdates; ++k)
+            portfolio.setQuantity(pickRow(gen), std::round(quantity(gen)));
+        return 0.0;
+    });
+    PortfolioRisk incremental = portfolio.book();
+    portfolio.reprice();
+    std::cout << "Incremental drift vs full reprice: " << worstDifference(incremental, portfolio.book()) << "\n";
+    const PortfolioRisk& first = portfolio.underlyingRisk(portfolio.underlyings().front());
+    std::cout << portfolio.underlyings().front() << ": delta " << first.delta << " vega " << first.vega << "\n";
+}
+
+//full revaluation VaR; reruns on a different thread count to confirm the P&L vector is bit identical
+void benchmarkMonteCarloVaR(int numEuropean, int numAmerican, int numScenarios, int numUnderlyings, bool useSurrogate) {
+    std::vector<Option> options = generateMixedOptions(numEuropean, numAmerican);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> quantity(-20.0, 20.0);
+    Portfolio portfolio;
+    for (size_t i = 0; i < options.size(); ++i)
+        portfolio.addPosition(options[i], std::round(quantity(gen)), "UND" + std::to_string(i % numUnderlyings));
+
+    //spots 0.5 correlated, vols 0.5 correlated, each spot -0.4 with its own vol
+    size_t U = portfolio.underlyings().size(), F = 2 * U;
+    VaRConfig config;
+    config.scenarios = numScenarios;
+    config.correlation.assign(F * F, 0.0);
+    for (size_t a = 0; a < F; ++a) {
+        for (size_t b = 0; b < F; ++b) {
+            bool sameBlock = (a < U) == (b < U);
+            if (a == b) config.correlation[a * F + b] = 1.0;
+            else if (sameBlock) config.correlation[a * F + b] = 0.5;
+            else if (a % U == b % U) config.correlation[a * F + b] = -0.4;
+        }
+    }
+
+    ChebyshevSurrogate surrogate;
+    if (useSurrogate) {
+        benchmark("Build chebyshev surrogate", [&]() {
+            surrogate.build();
+            return 0.0;
+        });
+        config.surrogate = &surrogate;
+    }
+
+    std::cout << "\n[Monte Carlo VaR: " << portfolio.size() << " positions x " << numScenarios << " scenarios, "
+              << omp_get_max_threads() << " threads]\n";
+    VaRResult result;
+    double ms = benchmark("Monte Carlo VaR", [&]() {
+        result = MonteCarloVaR::run(portfolio, config);
+        return 0.0;
+    });
+    std::cout << "Repricings/sec: " << static_cast<double>(portfolio.size()) * numScenarios / (ms / 1000.0) << "\n";
+    std::cout << config.confidence * 100 << "% VaR " << result.var << "  ES " << result.expectedShortfall
+              << "  mean " << result.mean << "  stdev " << result.stdev << "\n";
+
+    int threads = omp_get_max_threads();
+    omp_set_num_threads(threads > 1 ? 1 : 3);
+    VaRResult rerun = MonteCarloVaR::run(portfolio, config);
+    omp_set_num_threads(threads);
+    std::cout << "Identical P&L on " << (threads > 1 ? 1 : 3) << " thread(s): " << (rerun.pnl == result.pnl ? "yes" : "NO") << "\n";
+}
@@ -0,0 +1,98 @@
+#include "PublishBenchmarks.h"
+#include "shared/PriceRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    struct ReaderStats {
+        uint64_t received = 0, lost = 0, outOfOrder = 0, corrupt = 0;
+        std::vector<int64_t> latencyNs;
+    };
+
+    //each reader maps the segment itself, exactly as another process would; spins until the writer is done and
+    //the ring is drained. price = 0.5 * instrument so a torn copy shows up as corrupt
+    void consume(const std::string& name, const std::atomic<bool>& done, ReaderStats& stats) {
+        PriceReader reader(name);
+        PriceRing::Record record{};
+        uint64_t expected = reader.position();
+        while (true) {
+            if (!reader.next(record)) {
+                if (done.load(std::memory_order_acquire) && reader.available() == 0) break;
+                std::this_thread::yield();
+                continue;
+            }
+            int64_t latency = PriceRing::now() - record.timestampNs;
+            if (stats.latencyNs.size() < stats.latencyNs.capacity()) stats.latencyNs.push_back(latency);
+            stats.outOfOrder += record.seq < expected;
+            stats.corrupt += record.price != 0.5 * static_cast<double>(record.instrument) || record.delta != record.price;
+            expected = record.seq + 1;
+            ++stats.received;
+        }
+        stats.lost = reader.lost();
+    }
+
+    double percentile(std::vector<int64_t> samples, double p) {
+        if (samples.empty()) return 0.0;
+        size_t k = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+        return static_cast<double>(samples[k]);
+    }
+
+    //runs one writer pass with `readers` consumers; pauseNs > 0 spaces records out to measure latency, not backlog
+    void runPass(const char* label, size_t records, int readers, size_t capacity, int64_t pauseNs) {
+        const std::string name = "/options_bench_ring_" + std::to_string(::getpid());
+        PricePublisher publisher(name, capacity);
+        std::atomic<bool> done{false};
+        std::vector<ReaderStats> stats(readers);
+        for (ReaderStats& s : stats) s.latencyNs.reserve(std::min<size_t>(records, 1'000'000));
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; ++r)
+            threads.emplace_back(consume, std::cref(name), std::cref(done), std::ref(stats[r]));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // readers attached and spinning
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < records; ++i) {
+            double price = 0.5 * static_cast<double>(i);
+            Greeks greeks{price, price, price, price, price};
+            publisher.publish(i, price, &greeks);
+            if (pauseNs > 0) {
+                int64_t until = PriceRing::now() + pauseNs;
+                while (PriceRing::now() < until) {}
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        done.store(true, std::memory_order_release);
+        for (std::thread& t : threads) t.join();
+
+        std::cout << label << ": " << records << " records in " << std::fixed << std::setprecision(2) << ms << " ms ("
+                  << 1e6 * ms / static_cast<double>(records) << " ns/record publish)\n";
+        for (int r = 0; r < readers; ++r) {
+            const ReaderStats& s = stats[r];
+            std::cout << "  reader " << r << ": received " << s.received << ", lost " << s.lost << ", out of order "
+                      << s.outOfOrder << ", corrupt " << s.corrupt << ", latency p50 " << std::setprecision(0)
+                      << percentile(s.latencyNs, 0.5) << " ns, p99 " << percentile(s.latencyNs, 0.99) << " ns, max "
+                      << percentile(s.latencyNs, 1.0) << " ns" << std::setprecision(2) << "\n";
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+    }
+}
+
+//publish cost and reader latency through the shared-memory ring. the flood pass writes as fast as possible, so slow
+//readers show up as lost records (the writer never blocks); the paced pass writes one record every 2 us, so the
+//latency is the reader's wake-to-read time rather than backlog. latencies need at least readers + 1 free cores
+void benchmarkPriceRing(size_t records, int readers, size_t capacity) {
+    std::cout << "\n[Shared-memory price ring: " << readers << " readers, capacity " << capacity << ", "
+              << std::thread::hardware_concurrency() << " hardware threads]\n";
+    runPass("Flood", records, readers, capacity, 0);
+    runPass("Paced (2 us)", std::min<size_t>(records, 100'000), readers, capacity, 2'000);
+}
@@ -0,0 +1,227 @@
+#include "ServerBenchmarks.h"
+#include "api/PricingClient.h"
+#include "api/PricingCoordinator.h"
+#include "api/PricingServer.h"
+#include "pricing/PricingDispatcher.h"
+#include "shared/OptionGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <csignal>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    struct ClientStats {
+        std::vector<double> latencyUs;
+        double maxDiff = 0.0;
+        int failed = 0;
+    };
+
+    //keeps `pipeline` requests outstanding on one connection; every response is checked against the direct prices
+    void runClient(const std::string& path, const OptionBatch& batch, const std::vector<double>& expected,
+                   int requests, int pipeline, ClientStats& stats) {
+        PricingClient client(path);
+        const OptionBatchView view = batch.view();
+        std::deque<std::chrono::steady_clock::time_point> sent;
+        std::vector<double> out;
+        int issued = 0;
+        while (issued < requests || !sent.empty()) {
+            while (issued < requests && static_cast<int>(sent.size()) < pipeline) {
+                client.send(view);
+                sent.push_back(std::chrono::steady_clock::now());
+                ++issued;
+            }
+            PricingWire::ResponseHeader header = client.receive(out);
+            stats.latencyUs.push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent.front()).count());
+            sent.pop_front();
+            if (header.status != static_cast<uint16_t>(PricingWire::Status::Ok) || out.size() != expected.size()) {
+                ++stats.failed;
+                continue;
+            }
+            for (size_t i = 0; i < out.size(); ++i) stats.maxDiff = std::max(stats.maxDiff, std::abs(out[i] - expected[i]));
+        }
+    }
+
+    //a worker process: a plain PricingServer on a unix socket until it is killed (or the parent dies)
+    pid_t spawnWorker(const std::string& path) {
+        pid_t pid = ::fork();
+        if (pid != 0) return pid;
+        ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+        PricingServerConfig config;
+        config.unixPath = path;
+        PricingServer server(config);
+        server.start();
+        server.wait();
+        ::_exit(0);
+    }
+
+    void waitUntilListening(const std::string& path) {
+        for (int attempt = 0; attempt < 500; ++attempt) {
+            try {
+                PricingClient probe(path);
+                return;
+            } catch (const std::exception&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        throw std::runtime_error("Worker on " + path + " never came up");
+    }
+
+    void runSharded(const char* label, PricingCoordinator& coordinator, const OptionBatch& batch,
+                    const std::vector<double>& expected, const int* keys, double localMs) {
+        std::vector<double> out(batch.size(), 0.0);
+        const CoordinatorStats before = coordinator.stats();
+        auto start = std::chrono::steady_clock::now();
+        coordinator.price(batch.view(), out.data(), keys);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < out.size(); ++i) maxDiff = std::max(maxDiff, std::abs(out[i] - expected[i]));
+        const CoordinatorStats& after = coordinator.stats();
+        std::cout << std::fixed << std::setprecision(2) << label << ": " << ms << " ms (" << localMs / ms
+                  << "x local), " << after.shards - before.shards << " shards, " << after.reassigned - before.reassigned
+                  << " reassigned, " << after.workerFailures - before.workerFailures << " worker failures, "
+                  << after.localRows - before.localRows << " rows priced locally, max diff " << std::scientific << maxDiff
+                  << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+    }
+
+    double percentile(std::vector<double> samples, double p) {
+        if (samples.empty()) return 0.0;
+        size_t k = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+        std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+        return samples[k];
+    }
+}
+
+//`clients` local connections over a unix socket, each pipelining small requests. the interesting numbers are rows per
+//pricing call (how much the server coalesced concurrent requests) and the round trip cost against pricing the same
+//rows with one direct priceBatch call. the queue limit is kept low so backpressure pauses show up too
+void benchmarkPricingServer(int requestsPerClient, int clients, size_t rowsPerRequest, int pipeline) {
+    std::cout << "\n[Pricing server: " << clients << " clients x " << requestsPerClient << " requests x " << rowsPerRequest
+              << " rows, pipeline " << pipeline << "]\n";
+    GeneratorConfig generator;
+    generator.europeanFraction = 0.5;
+    std::vector<OptionBatch> batches;
+    std::vector<std::vector<double>> expected(clients);
+    for (int c = 0; c < clients; ++c) {
+        generator.seed = 42 + c;
+        batches.push_back(OptionGenerator::generate(rowsPerRequest, generator));
+        expected[c].resize(rowsPerRequest);
+        PricingDispatcher::priceBatch(batches[c].view(), expected[c].data());
+    }
+
+    //direct baseline: the same total rows, one call per request-sized chunk, no sockets
+    const size_t totalRequests = static_cast<size_t>(clients) * requestsPerClient;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < totalRequests; ++i)
+        PricingDispatcher::priceBatch(batches[i % clients].view(), expected[i % clients].data());
+    double directMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    PricingServerConfig config;
+    config.unixPath = "/tmp/options_bench_server_" + std::to_string(::getpid()) + ".sock";
+    config.maxQueuedRows = 2 * rowsPerRequest * clients;
+    PricingServer server(config);
+    server.start();
+
+    std::vector<ClientStats> stats(clients);
+    for (ClientStats& s : stats) s.latencyUs.reserve(requestsPerClient);
+    std::vector<std::thread> threads;
+    start = std::chrono::steady_clock::now();
+    for (int c = 0; c < clients; ++c)
+        threads.emplace_back(runClient, std::cref(config.unixPath), std::cref(batches[c]), std::cref(expected[c]),
+                             requestsPerClient, pipeline, std::ref(stats[c]));
+    for (std::thread& t : threads) t.join();
+    double serverMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    PricingServerStats s = server.stats();
+    server.stop();
+
+    std::vector<double> latencies;
+    double maxDiff = 0.0;
+    int failed = 0;
+    for (const ClientStats& c : stats) {
+        latencies.insert(latencies.end(), c.latencyUs.begin(), c.latencyUs.end());
+        maxDiff = std::max(maxDiff, c.maxDiff);
+        failed += c.failed;
+    }
+    const double rows = static_cast<double>(totalRequests * rowsPerRequest);
+    std::cout << std::fixed << std::setprecision(2)
+              << "Direct priceBatch per request: " << directMs << " ms (" << 1e6 * directMs / rows << " ns/row)\n"
+              << "Through the server:           " << serverMs << " ms (" << 1e6 * serverMs / rows << " ns/row, "
+              << 1e3 * static_cast<double>(totalRequests) / serverMs << " requests/s)\n"
+              << "  round trip p50 " << percentile(latencies, 0.5) << " us, p99 " << percentile(latencies, 0.99) << " us\n"
+              << "  " << s.batches << " pricing calls, " << static_cast<double>(s.rows) / std::max<uint64_t>(s.batches, 1)
+              << " rows per call, " << s.pauses << " backpressure pauses\n"
+              << "  failed responses " << failed << ", max diff vs direct " << std::scientific << maxDiff << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+//coordinator over `workers` forked PricingServer processes on unix sockets (the same code path as remote tcp
+//workers, minus the network). passes: row ranges, shards keyed by underlying, then with one worker killed and one
+//stopped (SIGSTOP) so their shards have to be reassigned. forks before this process touches omp; with fewer cores
+//than workers the speedup column only shows the overhead of the round trips
+void benchmarkShardedPricing(size_t rows, int workers) {
+    std::cout << "\n[Sharded pricing: " << rows << " rows over " << workers << " worker processes, "
+              << std::thread::hardware_concurrency() << " hardware threads]\n";
+    std::vector<pid_t> pids;
+    std::vector<WorkerEndpoint> endpoints;
+    for (int w = 0; w < workers; ++w) {
+        WorkerEndpoint endpoint;
+        endpoint.unixPath = "/tmp/options_bench_worker_" + std::to_string(::getpid()) + "_" + std::to_string(w) + ".sock";
+        pids.push_back(spawnWorker(endpoint.unixPath));
+        endpoints.push_back(endpoint);
+    }
+    for (const WorkerEndpoint& endpoint : endpoints) waitUntilListening(endpoint.unixPath);
+
+    GeneratorConfig generator;
+    generator.profile = OptionProfile::Chain;
+    OptionBatch batch = OptionGenerator::generate(rows, generator);
+    //chain rows carry one spot per underlying, which is enough to recover the grouping
+    std::vector<int> underlying(batch.size());
+    std::unordered_map<double, int> ids;
+    for (size_t i = 0; i < batch.size(); ++i)
+        underlying[i] = ids.emplace(batch.S[i], static_cast<int>(ids.size())).first->second;
+
+    std::vector<double> expected(batch.size());
+    auto start = std::chrono::steady_clock::now();
+    PricingDispatcher::priceBatch(batch.view(), expected.data());
+    double localMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(2) << "Local priceBatch: " << localMs << " ms, " << ids.size()
+              << " underlyings\n";
+    std::cout.unsetf(std::ios::floatfield);
+
+    CoordinatorConfig config;
+    config.shardRows = std::max<size_t>(1024, rows / (4 * workers));
+    config.shardTimeout = std::chrono::milliseconds(500);
+    PricingCoordinator coordinator(endpoints, config);
+    runSharded("Row ranges (cold connects)", coordinator, batch, expected, nullptr, localMs);
+    runSharded("Row ranges", coordinator, batch, expected, nullptr, localMs);
+    runSharded("By underlying", coordinator, batch, expected, underlying.data(), localMs);
+
+    ::kill(pids[0], SIGKILL);
+    ::waitpid(pids[0], nullptr, 0);
+    runSharded("Worker 0 killed", coordinator, batch, expected, nullptr, localMs);
+    if (workers > 1) {
+        ::kill(pids[1], SIGSTOP);
+        runSharded("Worker 1 stopped", coordinator, batch, expected, nullptr, localMs);
+        ::kill(pids[1], SIGCONT);
+    }
+
+    for (size_t w = 1; w < pids.size(); ++w) {
+        ::kill(pids[w], SIGKILL);
+        ::waitpid(pids[w], nullptr, 0);
+    }
+    for (const WorkerEndpoint& endpoint : endpoints) ::unlink(endpoint.unixPath.c_str());
+}
@@ -3,6 +3,7 @@
 //
 #include "TestUtils.h"
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
@@ -1,20 +1,136 @@
+#include "BenchmarkSuite.h"
 #include "DispatcherBenchmarks.h"
-#include "pricing/BinomialTree.h"
-#include "pricing/BAW.h"
-#include "shared/BenchmarkUtils.h"
+#include "MarketBenchmarks.h"
+#include "PortfolioBenchmarks.h"
+#include "PublishBenchmarks.h"
+#include "ServerBenchmarks.h"
+#include "shared/CpuDispatch.h"
 
-int main() {
-    constexpr int NUM_EUROPEAN = 1'000'000;
-    constexpr int NUM_AMERICAN = 1'000'000;
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
 
+namespace {
+    //the one-shot studies (accuracy vs reference, model comparisons) from *Benchmarks.cpp, run by --study name[=N].
+    //N is the book size; studies over a mixed book split it half european, half american
+    struct Study {
+        const char* name;
+        int defaultSize;
+        const char* description;
+        std::function<void(int)> run;
+    };
 
-    std::vector<Option> allOptions = generateMixedOptions(0, NUM_AMERICAN);
-//    std::vector<double> binomialPrices = benchmarkParallelization(&BinomialTree::price, 0, NUM_AMERICAN, allOptions);
-    std::vector<double> BAWPrices = benchmarkParallelization(&BAW::price, 0, NUM_AMERICAN, allOptions);
-//    std::vector<double> blackScholesPrice = benchmarkParallelization(&BAW::price, NUM_EUROPEAN, 0);
-//    summarizePricingErrors(binomialPrices, BAWPrices, allOptions);
+    const std::vector<Study>& studies() {
+        static const std::vector<Study> table = {
+            {"dispatcher-separate", 1'000'000, "european and american books priced separately",
+             [](int n) { benchmarkDispatcherSeparateStyle(n / 2, n / 2); }},
+            {"dispatcher-mixed", 1'000'000, "one mixed-style book through the dispatcher",
+             [](int n) { benchmarkDispatcherMixedStyle(n / 2, n / 2); }},
+            {"bs-simd", 1'000'000, "black-scholes scalar vs batch kernels",
+             [](int n) { benchmarkBlackScholesSIMD(n); }},
+            {"chebyshev", 20'000, "chebyshev surrogate build, coverage and error gate",
+             [](int n) { benchmarkChebyshevSurrogate(n); }},
+            {"mapped-file", 1'000'000, "book and results through mmap'd batch files",
+             [](int n) { benchmarkMappedBatchFile(n); }},
+            {"float-precision", 1'000'000, "float vs double batch pricing",
+             [](int n) { benchmarkFloatPrecision(n / 2, n / 2); }},
+            {"scenario-grid", 2'000, "spot x vol scenario grid",
+             [](int n) { benchmarkScenarioGrid(n / 2, n / 2); }},
+            {"adaptive", 10'000, "adaptive model selector, calibrated on 500 options",
+             [](int n) { benchmarkAdaptiveSelection(500, n); }},
+            {"crank-nicolson", 10'000, "crank-nicolson grids vs a 5000 step tree",
+             [](int n) { benchmarkCrankNicolson(n); }},
+            {"longstaff-schwartz", 200, "least-squares monte carlo vs a 2000 step tree",
+             [](int n) { benchmarkLongstaffSchwartz(n / 2, n / 2); }},
+            {"discrete-dividends", 200, "cash dividend trees vs an 8000 step reference",
+             [](int n) { benchmarkDiscreteDividends(n); }},
+            {"option-chain", 200, "chains on N underlyings, shared per-expiry work",
+             [](int n) { benchmarkOptionChain(n); }},
+            {"multi-strike", 50, "one tree for N strikes vs a tree per strike",
+             [](int n) { benchmarkMultiStrike(n); }},
+            {"vol-surface", 1'000'000, "vol surface calibration and fillSigma over N rows",
+             [](int n) { benchmarkVolSurface(12, 60, 200, n); }},
+            {"market-curves", 1'000'000, "pricing off rate/dividend curves",
+             [](int n) { benchmarkMarketCurves(n / 2, n / 2); }},
+            {"portfolio-greeks", 100'000, "portfolio greeks, full and incremental",
+             [](int n) { benchmarkPortfolioGreeks(n / 2, n / 2); }},
+            {"var", 10'000, "monte carlo VaR, 10000 scenarios",
+             [](int n) { benchmarkMonteCarloVaR(n / 2, n / 2, 10'000); }},
+            {"var-surrogate", 10'000, "monte carlo VaR with americans on the chebyshev surrogate",
+             [](int n) { benchmarkMonteCarloVaR(n / 2, n / 2, 10'000, 20, true); }},
+        };
+        return table;
+    }
 
-//    std::vector<double> BAW_BlackScholesPrices = benchmarkParallelization(&BAW::price, NUM_EUROPEAN, NUM_AMERICAN);
+    int runStudy(const std::string& name, int size) {
+        if (name == "list") {
+            for (const Study& s : studies())
+                std::cout << std::left << std::setw(22) << s.name << std::setw(11) << s.defaultSize << s.description << "\n";
+            return 0;
+        }
+        for (const Study& s : studies()) {
+            if (name != s.name) continue;
+            s.run(size > 0 ? size : s.defaultSize);
+            return 0;
+        }
+        throw std::invalid_argument("Unknown study " + name + " (--study list)");
+    }
+}
 
+//benchmark harness: warmup + repetitions per (case, size, threads), median/stddev/p90, json for regression checks.
+//--pareto, --ring, --server, --shard, --allocations and --study run a single study instead of the suite
+int main(int argc, char** argv) {
+    try {
+        bool listOnly, help;
+        BenchmarkConfig config = parseBenchmarkArgs(argc, argv, listOnly, help);
+        if (help) {
+            std::cout << "performance_test [--filter substr] [--sizes 10000,100000] [--threads 1,8] [--reps 10]\n"
+                         "                 [--warmup 2] [--seed 42] [--profile uniform|chain|stress]\n"
+                         "                 [--json out.json] [--baseline old.json]\n"
+                         "                 [--tolerance 0.10] [--counters] [--isa baseline|sse4.2|avx2|avx512] [--list]\n"
+                         "performance_test --pareto 200 [--profile ...] [--seed 42]   # american error vs throughput\n"
+                         "performance_test --allocations 10000                        # heap allocations per warm tick\n"
+                         "performance_test --ring 1000000                             # shared-memory price ring\n"
+                         "performance_test --server 200                               # pricing server, 4 pipelined clients\n"
+                         "performance_test --shard 200000                             # coordinator over 3 worker processes\n"
+                         "performance_test --study name[=N]                           # one-shot study, --study list for names\n";
+            return 0;
+        }
+        if (!config.isa.empty()) CpuDispatch::setActive(CpuDispatch::fromName(config.isa));
+        if (config.pareto > 0) {
+            benchmarkAmericanPareto(config.pareto, 20001, "american_pareto.csv", config.profile, config.seed);
+            return 0;
+        }
+        if (config.ring > 0) {
+            benchmarkPriceRing(static_cast<size_t>(config.ring));
+            return 0;
+        }
+        //before anything else here starts the omp pool: the workers are forked
+        if (config.shard > 0) {
+            benchmarkShardedPricing(static_cast<size_t>(config.shard));
+            return 0;
+        }
+        if (config.server > 0) {
+            benchmarkPricingServer(config.server);
+            return 0;
+        }
+        if (!config.study.empty()) return runStudy(config.study, config.studySize);
+        if (config.allocations > 0) return checkSteadyStateAllocations(config.allocations, 5, config.seed) > 0 ? 2 : 0;
+        BenchmarkSuite suite(config);
+        registerPricingBenchmarks(suite);
+        if (listOnly) {
+            for (const BenchmarkCase& c : suite.cases()) std::cout << c.name << "\n";
+            return 0;
+        }
+
+        std::vector<BenchmarkResult> results = suite.run();
+        if (!config.jsonPath.empty()) suite.writeJson(results, config.jsonPath);
+        //nonzero exit when a median slowed down past the tolerance, so CI can gate on it
+        if (!config.baselinePath.empty()) return suite.compare(results, config.baselinePath) > 0 ? 2 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "performance_test: " << e.what() << "\n";
+        return 1;
+    }
     return 0;
-}
\ No newline at end of file
+}